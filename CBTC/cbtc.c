@@ -0,0 +1,259 @@
+/*
+ * Copyright (c) 2015, Computer Science Department (CSD), University of Crete, and 
+ * Signal Processing Lab (SPL), Institute of Computer Science (ICS), FORTH, Greece.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of CSD, SPL/ICS-FORTH nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * 
+ */
+
+/**
+ * \file
+ *         The CBTC(alpha) computation of a node (see cbtc.h).
+ *
+ *         The bearings are computed once, as a neighbour is added; the cone
+ *         condition, the shrink-back and the pairwise edge removal then
+ *         compare integers only. A level is tested in one pass over the
+ *         table, so the computation takes POWER_LEVELS passes, then one
+ *         pass over the pairs of neighbours kept.
+ */
+
+#include <math.h>
+#include <string.h>
+
+#include "cbtc.h"
+#include "linkest.h"
+
+#if LINKEST_WEIGHT == LINKEST_RSSI
+#error "CBTC needs the positions (LINKEST_CONF_WEIGHT)"
+#endif
+
+#if CBTC_SIZE > 32
+#error "the pairwise edge removal keeps CBTC_SIZE bits"
+#endif
+
+#define TURN 65536UL
+#define CONE ((uint32_t)CBTC_ALPHA * TURN / 360)
+#define SIXTH (TURN / 6)
+#define RADIAN (TURN / (2 * 3.14159265))
+
+static struct cbtc_neighbor table[CBTC_SIZE];
+static uint8_t count;
+static float myx, myy;
+
+/*---------------------------------------------------------------------------*/
+void
+cbtc_init(float x, float y)
+{
+  myx = x;
+  myy = y;
+  count = 0;
+}
+/*---------------------------------------------------------------------------*/
+uint8_t
+cbtc_count(void)
+{
+  return count;
+}
+/*---------------------------------------------------------------------------*/
+const struct cbtc_neighbor *
+cbtc_neighbor(uint8_t i)
+{
+  return &table[i];
+}
+/*---------------------------------------------------------------------------*/
+/* drops entry i of the table */
+static void
+drop(uint8_t i)
+{
+  memmove(&table[i], &table[i + 1], (count - i - 1) * sizeof(table[0]));
+  --count;
+}
+/*---------------------------------------------------------------------------*/
+uint8_t
+cbtc_add(uint16_t id, float x, float y)
+{
+  struct cbtc_neighbor e;
+  uint8_t i, far;
+
+  for(i = 0; i < count; ++i) {
+    if(table[i].id == (id & 0xff)) {
+      return 0;
+    }
+  }
+  e.id = id;
+  e.x = x;
+  e.y = y;
+  e.d2 = (x - myx) * (x - myx) + (y - myy) * (y - myy);
+  if(e.d2 == 0) {
+    /* the node itself, or a neighbour with no bearing */
+    return 0;
+  }
+  if(count == CBTC_SIZE) {
+    for(far = 0, i = 1; i < count; ++i) {
+      if(table[i].d2 > table[far].d2) {
+        far = i;
+      }
+    }
+    if(e.d2 >= table[far].d2) {
+      return 0;
+    }
+    drop(far);
+  }
+  e.level = power_level(e.d2);
+  e.kept = 0;
+  e.bearing = (uint16_t)(int32_t)floor(atan2(y - myy, x - myx) * RADIAN);
+  for(i = count; i > 0 && table[i - 1].bearing > e.bearing; --i) {
+    table[i] = table[i - 1];
+  }
+  table[i] = e;
+  ++count;
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+/* the directions that the neighbours power level 'level' reaches leave
+   uncovered: every gap between two consecutive ones wider than CBTC_ALPHA,
+   by how much it is wider. 0 when the largest gap is within CBTC_ALPHA (the
+   cone condition), a full turn for no neighbours */
+static uint32_t
+uncovered(uint8_t level)
+{
+  uint32_t gap, sum = 0;
+  uint16_t first = 0, last = 0;
+  uint8_t i, n = 0;
+
+  for(i = 0; i < count; ++i) {
+    if(table[i].level > level) {
+      continue;
+    }
+    if(n++ == 0) {
+      first = table[i].bearing;
+    } else if((gap = table[i].bearing - last) > CONE) {
+      sum += gap - CONE;
+    }
+    last = table[i].bearing;
+  }
+  if(n == 0) {
+    return TURN;
+  }
+  /* around, from the last one to the first one */
+  gap = TURN - last + first;
+  if(gap > CONE) {
+    sum += gap - CONE;
+  }
+  return sum;
+}
+/*---------------------------------------------------------------------------*/
+#if CBTC_PAIRWISE
+/* neighbour a is nearer than neighbour b: by squared distance, then id */
+static uint8_t
+nearer(const struct cbtc_neighbor *a, const struct cbtc_neighbor *b)
+{
+  return a->d2 < b->d2 || (a->d2 == b->d2 && a->id < b->id);
+}
+
+/* drops the neighbours kept that have a nearer one kept less than 60
+   degrees away from them; all pairs are tested before any is dropped */
+static void
+pairwise(void)
+{
+  uint32_t dropped = 0;
+  uint16_t angle;
+  uint8_t i, j;
+
+  for(i = 0; i < count; ++i) {
+    for(j = 0; j < count && table[i].kept; ++j) {
+      if(j == i || !table[j].kept) {
+        continue;
+      }
+      angle = table[j].bearing - table[i].bearing;
+      if(angle > TURN / 2) {
+        angle = -angle;
+      }
+      if(angle < SIXTH && nearer(&table[j], &table[i])) {
+        dropped |= (uint32_t)1 << i;
+        break;
+      }
+    }
+  }
+  for(i = 0; i < count; ++i) {
+    if(dropped & ((uint32_t)1 << i)) {
+      table[i].kept = 0;
+    }
+  }
+}
+#endif
+/*---------------------------------------------------------------------------*/
+uint8_t
+cbtc_compute(void)
+{
+  uint32_t full, u;
+  uint8_t p, i, n = 0;
+
+  /* the least level that satisfies the cone condition; with shrink-back,
+     or that covers what full power covers */
+  full = uncovered(POWER_LEVEL(POWER_LEVELS - 1));
+  for(p = 0; p < POWER_LEVELS - 1; ++p) {
+    u = uncovered(POWER_LEVEL(p));
+    if(u == 0 || (CBTC_SHRINK && u == full)) {
+      break;
+    }
+  }
+  for(i = 0; i < count; ++i) {
+    table[i].kept = table[i].level <= POWER_LEVEL(p);
+  }
+#if CBTC_PAIRWISE
+  pairwise();
+#endif
+  for(i = 0; i < count; ++i) {
+    n += table[i].kept;
+  }
+  return n;
+}
+/*---------------------------------------------------------------------------*/
+uint8_t
+cbtc_power(uint16_t *links)
+{
+  uint8_t i, level = 0;
+
+  *links = 0;
+  for(i = 0; i < count; ++i) {
+    if(table[i].kept) {
+      ++*links;
+      if(table[i].level > level) {
+        level = table[i].level;
+      }
+    }
+  }
+  return level > 0 ? level : 31;
+}
+/*---------------------------------------------------------------------------*/
+int
+cbtc_memory(void)
+{
+  return count * sizeof(struct cbtc_neighbor);
+}
+/*---------------------------------------------------------------------------*/
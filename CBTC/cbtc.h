@@ -0,0 +1,137 @@
+/*
+ * Copyright (c) 2015, Computer Science Department (CSD), University of Crete, and 
+ * Signal Processing Lab (SPL), Institute of Computer Science (ICS), FORTH, Greece.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of CSD, SPL/ICS-FORTH nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * 
+ */
+
+/**
+ * \file
+ *         The CBTC(alpha) computation of a node: cone-based topology control
+ *         (L. Li, J. Y. Halpern, P. Bahl, Y.-M. Wang and R. Wattenhofer,
+ *         "A cone-based distributed topology-control algorithm for wireless
+ *         multi-hop networks", IEEE/ACM Transactions on Networking, vol. 13,
+ *         no. 1, pp. 147-159, 2005). Used by firmware.c, and by the host
+ *         tools (tools/topoeval).
+ *
+ *         The neighbours are added with cbtc_add, from the position beacons
+ *         heard at full power: the node knows at once what every power
+ *         level reaches, and does not ramp its power to find out. Each
+ *         neighbour gets an integer bearing, in 1/65536 of a turn, and the
+ *         table is kept sorted by bearing, so that the angular gaps between
+ *         the neighbours a power level reaches are differences of
+ *         consecutive bearings.
+ *
+ *         cbtc_compute then picks the least power level whose neighbours
+ *         leave no gap wider than CBTC_ALPHA around the node (the cone
+ *         condition), and keeps them. Two optimizations of the paper follow:
+ *
+ *           shrink-back (CBTC_SHRINK): a node that is not covered at full
+ *           power (on the boundary of the field) takes the least level that
+ *           covers the same directions as full power, not full power;
+ *
+ *           pairwise edge removal (CBTC_PAIRWISE): of two neighbours less
+ *           than 60 degrees apart, the farther one is dropped (by squared
+ *           distance, then id), as it is reached through the nearer one.
+ *
+ *         The third one, asymmetric edge removal, is the G- confirmation
+ *         round of the firmware (SYMMETRIC_CONF_MODE, common/symmetric.h):
+ *         it keeps the network connected for CBTC_ALPHA <= 120, and the
+ *         symmetric closure (G+) for CBTC_ALPHA <= 150.
+ *
+ *         The bearings need the positions: the link estimation from the
+ *         RSSI (LINKEST_CONF_WEIGHT) does not work with it.
+ */
+
+#ifndef CBTC_H_
+#define CBTC_H_
+
+#include "contiki.h"
+#include "power.h"
+
+/* widest angular gap between the neighbours kept (degrees) */
+#ifdef CBTC_CONF_ALPHA
+#define CBTC_ALPHA CBTC_CONF_ALPHA
+#else
+#define CBTC_ALPHA 120
+#endif
+
+/* the shrink-back and pairwise edge removal optimizations */
+#ifdef CBTC_CONF_SHRINK
+#define CBTC_SHRINK CBTC_CONF_SHRINK
+#else
+#define CBTC_SHRINK 1
+#endif
+
+#ifdef CBTC_CONF_PAIRWISE
+#define CBTC_PAIRWISE CBTC_CONF_PAIRWISE
+#else
+#define CBTC_PAIRWISE 1
+#endif
+
+/* neighbours kept in the table (the nearest ones) */
+#ifdef CBTC_CONF_SIZE
+#define CBTC_SIZE CBTC_CONF_SIZE
+#else
+#define CBTC_SIZE 20
+#endif
+
+struct cbtc_neighbor {
+  uint8_t id;
+  uint8_t level;            /* power level that reaches it */
+  uint8_t kept;             /* a logical neighbour (after cbtc_compute) */
+  uint16_t bearing;         /* 1/65536 of a turn, from the x axis */
+  float d2;                 /* squared distance */
+  float x, y;
+};
+
+/* forgets the neighbours; the node is at (x, y) */
+void cbtc_init(float x, float y);
+
+/* adds the neighbour id, at (x, y); when the table is full, it replaces the
+   farthest one if it is nearer. Returns 1 if added, 0 if it is known, it
+   is the node or it is not added */
+uint8_t cbtc_add(uint16_t id, float x, float y);
+
+/* the neighbours, sorted by bearing: cbtc_count() of them, 0..count - 1 */
+uint8_t cbtc_count(void);
+const struct cbtc_neighbor *cbtc_neighbor(uint8_t i);
+
+/* keeps the neighbours that the least level satisfying the cone condition
+   reaches (with shrink-back and pairwise edge removal, as configured);
+   returns the number kept */
+uint8_t cbtc_compute(void);
+
+/* the least transmission power (3..31) that reaches every neighbour kept
+   (31 for none), and their number in links */
+uint8_t cbtc_power(uint16_t *links);
+
+/* memory of the table in use (bytes) */
+int cbtc_memory(void);
+
+#endif /* CBTC_H_ */
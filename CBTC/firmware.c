@@ -0,0 +1,410 @@
+/*
+ * Copyright (c) 2015, Computer Science Department (CSD), University of Crete, and 
+ * Signal Processing Lab (SPL), Institute of Computer Science (ICS), FORTH, Greece.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of CSD, SPL/ICS-FORTH nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * 
+ */
+
+/**
+ * \file
+ *         The main processes for topology control based on CBTC(alpha), the
+ *         cone-based algorithm of L. Li, J. Y. Halpern, P. Bahl, Y.-M. Wang
+ *         and R. Wattenhofer. The position discovery and the records of the
+ *         motes log are those of REDELCA, so that the runs of the two
+ *         compare side by side; the computation is in cbtc.c.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "contiki.h"
+#include "cc2420.h"
+#include "net/rime.h"
+#include "net/packetbuf.h"
+#include "dev/serial-line.h"
+#include "cbtc.h"
+#include "telemetry.h"
+#include "profile.h"
+#include "energy.h"
+#include "power.h"
+#include "position.h"
+#include "shell.h"
+#include "rendezvous.h"
+#include "txpower.h"
+#include "topology.h"
+#include "topocache.h"
+#include "symmetric.h"
+
+/*the quiet phase of the computation: CBTC must fit in it*/
+#define COMPUTE_TIME (10*CLOCK_SECOND)
+
+static float myx, myy;
+
+/*the computation: not started yet, in progress, done (it may then be run again from the shell)*/
+static enum { WAITING, COMPUTING, COMPUTED } state;
+/*its logical neighbours and the transmission power it picked*/
+static uint16_t maxn;
+static uint8_t maxp;
+#if SYMMETRIC_MODE != SYMMETRIC_NONE
+/*in the confirmation phase: beacons starting with SYMMETRIC_BEACON are the confirmation's*/
+static uint8_t confirming;
+#endif
+/*---------------------------------------------------------------------------*/
+PROCESS(b_thread, "Broadcast thread");
+PROCESS(c_thread, "CBTC thread");
+AUTOSTART_PROCESSES(&b_thread, &c_thread);
+/*---------------------------------------------------------------------------*/
+static void
+broadcast_recv(struct broadcast_conn *c, const rimeaddr_t *from)
+{
+  char msg[32], * x, * y;
+  uint16_t len;
+
+  rendezvous_recv();
+#if SYMMETRIC_MODE != SYMMETRIC_NONE
+  if(confirming && ((char *)packetbuf_dataptr())[0] == SYMMETRIC_BEACON){
+    symmetric_recv(from->u8[0]);
+    return;
+  }
+#endif
+  if(((char *)packetbuf_dataptr())[0] == 'N'){
+    telemetry_value(TELEMETRY_NEIGHBOR, from->u8[0]);
+    return;
+  }
+  /*A position beacon: x#y*/
+  len = packetbuf_datalen();
+  if(len >= sizeof(msg)){
+    return;
+  }
+  PROFILE_BEGIN(PROFILE_DISCOVERY);
+  memcpy(msg, packetbuf_dataptr(), len);
+  msg[len] = '\0';
+  x = strtok(msg, "#");
+  y = strtok(NULL, "#");
+  if(x != NULL && y != NULL){
+    cbtc_add(from->u8[0], str2float(x), str2float(y));
+  }
+  PROFILE_END(PROFILE_DISCOVERY);
+}
+
+static const struct broadcast_callbacks broadcast_call = {broadcast_recv};
+static struct broadcast_conn broadcast;
+
+static process_event_t cbtc_start_event;
+static process_event_t cbtc_finish_event;
+
+/*the logical neighbours (after cbtc_compute) into e, with their power levels and positions; returns their number*/
+static uint8_t
+logical_entries(struct topocache_entry *e)
+{
+  const struct cbtc_neighbor *p;
+  uint8_t i, n = 0;
+
+  for(i = 0; i < cbtc_count() && n < TOPOCACHE_SIZE; ++i){
+    p = cbtc_neighbor(i);
+    if(p->kept){
+      e[n].id = p->id;
+      e[n].level = p->level;
+      e[n].x = p->x;
+      e[n].y = p->y;
+      ++n;
+    }
+  }
+  return n;
+}
+
+/*publishes the logical neighbours to the routing layer, with their power levels for unicasts, and keeps them in flash*/
+static void
+publish_logical(void)
+{
+  struct topocache_entry e[TOPOCACHE_SIZE];
+  uint8_t n;
+
+  n = logical_entries(e);
+#if SYMMETRIC_MODE != SYMMETRIC_NONE
+  /*The symmetric links of the confirmation round, and the power that keeps them*/
+  n = symmetric_links(e, n, TOPOCACHE_SIZE);
+  maxp = symmetric_power(e, n, maxp);
+#endif
+  topocache_store(e, n, maxp);
+  topocache_apply();
+}
+
+/*the result of the computation: the logical neighbours, the power and the memory of the table*/
+static void
+report_logical(void)
+{
+  publish_logical();
+  telemetry_value(TELEMETRY_POWER, maxp);
+  telemetry_value(TELEMETRY_MEMORY, cbtc_memory());
+}
+
+#if SYMMETRIC_MODE != SYMMETRIC_NONE
+/*the confirmation beacon: the logical neighbours the computation picked*/
+static void
+confirmation_beacon(void)
+{
+  struct topocache_entry e[TOPOCACHE_SIZE];
+
+  symmetric_beacon(e, logical_entries(e), myx, myy);
+}
+#endif
+
+/*SHELL COMMANDS---------------------------------------------------------------------------*/
+static void
+shell_nbr(char *args)
+{
+  const struct cbtc_neighbor *p;
+  uint8_t i;
+
+  /*by bearing; once computed, '*' marks the logical neighbours*/
+  for(i = 0; i < cbtc_count(); ++i){
+    p = cbtc_neighbor(i);
+    SHELL_PRINTF("%u d2 %u level %u bearing %u%s\n", p->id, (unsigned)p->d2, p->level,
+                 (unsigned)((uint32_t)p->bearing * 360 >> 16), state == COMPUTED && p->kept ? " *" : "");
+  }
+  SHELL_PRINTF("%u neighbours\n", cbtc_count());
+}
+
+static void
+shell_logical(char *args)
+{
+  uint8_t i;
+
+  if(state != COMPUTED){
+    SHELL_PRINTF("not computed yet\n");
+    return;
+  }
+  /*As published (made symmetric with SYMMETRIC_CONF_MODE)*/
+  printf(SHELL_PREFIX "%u:", topology_count());
+  for(i = 0; i < topology_count(); ++i){
+    printf(" %u", topology_neighbor(i));
+  }
+  printf("\n");
+}
+
+static void
+shell_power(char *args)
+{
+  SHELL_PRINTF("txpower %d, computed %u\n", cc2420_get_txpower(), state == COMPUTED ? maxp : 0);
+}
+
+static void
+shell_table(char *args)
+{
+  uint8_t i;
+
+  for(i = 0; i < POWER_LEVELS; ++i){
+    SHELL_PRINTF("level %u d2 %u\n", POWER_LEVEL(i), (unsigned)POWER[i]);
+  }
+}
+
+static void
+shell_txpower(char *args)
+{
+  uint16_t id;
+  uint8_t i, level;
+
+  for(i = 0; i < txpower_count(); ++i){
+    level = txpower_entry(i, &id);
+    SHELL_PRINTF("%u level %u\n", id, level);
+  }
+  SHELL_PRINTF("%u neighbours, others and broadcasts %u\n", txpower_count(), TXPOWER_MAX);
+}
+
+static void
+shell_cache(char *args)
+{
+  const struct topocache_entry *e;
+  uint8_t i;
+
+  if(!topocache_valid()){
+    SHELL_PRINTF("no cache\n");
+    return;
+  }
+  for(i = 0; i < topocache_count(); ++i){
+    e = topocache_entry(i);
+    SHELL_PRINTF("%u level %u at %d#%d\n", e->id, e->level, (int)e->x, (int)e->y);
+  }
+  SHELL_PRINTF("%u neighbours, power %u\n", topocache_count(), topocache_power());
+}
+
+static void
+shell_mem(char *args)
+{
+  SHELL_PRINTF("neighbours %u/%u, %d bytes\n", cbtc_count(), CBTC_SIZE, cbtc_memory());
+}
+
+static void
+shell_run(char *args)
+{
+  if(state != COMPUTED){
+    SHELL_PRINTF("busy\n");
+    return;
+  }
+  process_post(&c_thread, cbtc_start_event, NULL);
+}
+
+static const struct shell_command shell_commands[] = {
+  { "nbr", "neighbours heard: id, d^2, power level, bearing (* logical)", shell_nbr },
+  { "logical", "logical neighbours", shell_logical },
+  { "power", "transmission power, now and as computed", shell_power },
+  { "table", "power table: level, squared distance it reaches", shell_table },
+  { "txpower", "unicast power level of each logical neighbour", shell_txpower },
+  { "cache", "topology kept in flash: neighbours, level, position", shell_cache },
+  { "mem", "neighbours (used/size) and memory of the table", shell_mem },
+  { "run", "computes the topology again", shell_run },
+  { NULL, NULL, NULL }
+};
+
+/*MAIN THREAD------------------------------------------------------------------------------*/
+PROCESS_THREAD(b_thread, ev, data)
+{
+  static char * msg, * my_x, * my_y, * position;
+
+  PROCESS_EXITHANDLER(broadcast_close(&broadcast);)
+  PROCESS_BEGIN();
+  shell_init(shell_commands);
+#if SYMMETRIC_MODE != SYMMETRIC_NONE
+  symmetric_init();
+#endif
+  topology_init();
+  /*The topology of the last run, if any, until the computation confirms or replaces it*/
+  if(topocache_load() >= 0){
+    topocache_apply();
+  }
+  broadcast_open(&broadcast, 129, &broadcast_call);
+  /*Radio off until the position discovery*/
+  rendezvous_init();
+  /*Wait for the position (x#y) from Cooja script: the other lines are shell commands*/
+  PROCESS_YIELD_UNTIL(ev == serial_line_event_message && shell_position(data));
+  position = strdup((char *)data);
+  msg = strdup((char *)data);
+  my_x = strtok(msg, "#");
+  my_y = strtok(NULL, "#");
+  /*str2float tokenizes too: both coordinates first*/
+  myx = str2float(my_x);
+  myy = str2float(my_y);
+  free(msg);
+  cbtc_init(myx, myy);
+
+  energy_begin(ENERGY_POSITION);
+  /*Position discovery: 120s, the position is broadcasted at full power in the node's slot of the window*/
+  rendezvous_phase(120*CLOCK_SECOND, rimeaddr_node_addr.u8[0] % RENDEZVOUS_SLOTS);
+  PROCESS_WAIT_UNTIL(rendezvous_slot());
+  packetbuf_clear();
+  packetbuf_clear_hdr();
+  packetbuf_copyfrom(position, strlen(position));
+  rendezvous_send(&broadcast);
+  free(position);
+  PROCESS_WAIT_UNTIL(rendezvous_ended());
+  energy_end(ENERGY_POSITION);
+
+  /*Switch control to CBTC thread, in a quiet phase (radio off) that keeps the next window aligned*/
+  energy_begin(ENERGY_COMPUTE);
+  rendezvous_phase(COMPUTE_TIME, RENDEZVOUS_QUIET);
+  process_post(&c_thread, cbtc_start_event, NULL);
+  PROCESS_YIELD_UNTIL(ev == cbtc_finish_event);
+  PROCESS_WAIT_UNTIL(rendezvous_ended());
+  energy_end(ENERGY_COMPUTE);
+  energy_begin(ENERGY_VERIFY);
+#if SYMMETRIC_MODE != SYMMETRIC_NONE
+  /*Confirmation round, at the computed power: the logical neighbours each node picked; then the links are made
+    symmetric (G- is the asymmetric edge removal of CBTC), the power adjusted to them, and the result published and
+    reported (see symmetric.h)*/
+  cc2420_set_txpower(maxp);
+  confirming = 1;
+  rendezvous_phase(SYMMETRIC_PHASE, rimeaddr_node_addr.u8[0] % RENDEZVOUS_SLOTS);
+  PROCESS_WAIT_UNTIL(rendezvous_slot());
+  packetbuf_clear();
+  confirmation_beacon();
+  rendezvous_send(&broadcast);
+  PROCESS_WAIT_UNTIL(rendezvous_ended());
+  confirming = 0;
+  symmetric_end();
+  report_logical();
+#endif
+  /*The verification beacon goes at the computed power*/
+  cc2420_set_txpower(maxp);
+  /*Verification: 60s*/
+  rendezvous_phase(60*CLOCK_SECOND, rimeaddr_node_addr.u8[0] % RENDEZVOUS_SLOTS);
+  PROCESS_WAIT_UNTIL(rendezvous_slot());
+  packetbuf_clear();
+  packetbuf_attr_clear();
+  packetbuf_copyfrom("N", 1);
+  rendezvous_send(&broadcast);
+  PROCESS_WAIT_UNTIL(rendezvous_ended());
+  energy_end(ENERGY_VERIFY);
+
+  //CPU of the computation, radio from the computation to the end (to use for power consumption).
+  telemetry_value(TELEMETRY_ENERGY_CPU, energy_ticks(ENERGY_COMPUTE, ENERGY_CPU));
+  telemetry_value(TELEMETRY_ENERGY_TX, energy_ticks(ENERGY_COMPUTE, ENERGY_TX) + energy_ticks(ENERGY_VERIFY, ENERGY_TX));
+  telemetry_value(TELEMETRY_ENERGY_RX, energy_ticks(ENERGY_COMPUTE, ENERGY_RX) + energy_ticks(ENERGY_VERIFY, ENERGY_RX));
+  energy_report();
+  PROFILE_REPORT();
+  telemetry_event(TELEMETRY_DONE);
+  /*The radio is the application's again, duty-cycled: broadcasts at full power, unicasts at the level of their
+    receiver (see txpower.h)*/
+  cc2420_set_txpower(TXPOWER_MAX);
+  rendezvous_stop();
+  PROCESS_END();
+}
+
+/*CBTC THREAD------------------------------------------------------------------------------*/
+PROCESS_THREAD(c_thread, ev, data)
+{
+  PROCESS_BEGIN();
+  /*The first computation is started by the main thread, later ones by the shell (run)*/
+  while(1){
+    PROCESS_YIELD_UNTIL(ev == cbtc_start_event);
+    state = COMPUTING;
+
+    telemetry_event(TELEMETRY_DELAUNAY);
+    telemetry_value(TELEMETRY_INITIALIZE, cbtc_count());
+
+    /*The least power level that satisfies the cone condition, and the neighbours it keeps*/
+    PROFILE_BEGIN(PROFILE_CONE);
+    cbtc_compute();
+    PROFILE_END(PROFILE_CONE);
+
+    /*Select the transmission power: the one that reaches them*/
+    PROFILE_BEGIN(PROFILE_POWER);
+    maxp = cbtc_power(&maxn);
+    PROFILE_END(PROFILE_POWER);
+    telemetry_value(TELEMETRY_REDELCA, maxn);
+#if SYMMETRIC_MODE != SYMMETRIC_NONE
+    /*The first computation is published and reported after the confirmation round (main thread)*/
+    if(symmetric_confirmed())
+#endif
+    report_logical();
+
+    state = COMPUTED;
+    process_post(&b_thread, cbtc_finish_event, NULL);
+  }
+  PROCESS_END();
+}
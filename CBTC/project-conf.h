@@ -0,0 +1,56 @@
+/*
+ * Copyright (c) 2015, Computer Science Department (CSD), University of Crete, and 
+ * Signal Processing Lab (SPL), Institute of Computer Science (ICS), FORTH, Greece.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of CSD, SPL/ICS-FORTH nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * 
+ */
+
+/**
+ * \file
+ *         Project specific configuration for the employed protocol stack.
+ *
+ *
+ * \author
+ *         Nancy Panousopoulou - <apanouso@ics.forth.gr>
+ */
+
+#ifndef PROJECT_CONF_H_
+#define PROJECT_CONF_H_
+
+
+/* duty-cycled radio; the discovery and verification beacons meet in the
+   rendezvous windows of common/rendezvous.h, the radio is off in between */
+#define NETSTACK_CONF_RDC      contikimac_driver
+
+/* CBTC(2pi/3) with all three optimizations of the paper: shrink-back and
+   pairwise edge removal (cbtc.h), and asymmetric edge removal, the G-
+   confirmation round (common/symmetric.h) */
+#define CBTC_CONF_ALPHA        120
+#define SYMMETRIC_CONF_MODE    SYMMETRIC_GMINUS
+
+#endif /* PROJECT_CONF_H_ */
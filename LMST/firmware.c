@@ -54,338 +54,516 @@
 #include <stdlib.h> 
 
 
-#include "lib/list.h"
-#include "lib/memb.h"
-#include <math.h>
-
-#define TIMEFRAME 30
-
-
-#define MAXVAL 10000 //for Prim algorithm
-
-#define PRES_CONST 200000u // for conversion from float to int
-#define PRES_RANGE 1000u // likewise
-
-#define MAX_NEIGHBORS 20 //maximum number of neighbors
+#include "lmst.h"
+#include "telemetry.h"
+#include "profile.h"
+#include "energy.h"
+#include "power.h"
+#include "shell.h"
+#include "rendezvous.h"
+#include "txpower.h"
+#include "topology.h"
+#include "topocache.h"
+#include "linkest.h"
+#include "calibrate.h"
+#include "symmetric.h"
+#include "maintain.h"
+#include "ramp.h"
 
 #define SEND_TIME (random_rand() % (4*CLOCK_SECOND))
 
-//for 15m tx range.
-static const
-float POWER [8] = {
-    {2.107}  ,
-    {11.472} ,
-    {28.330} ,
-    {52.680} ,
-    {84.520} ,
-    {123.850},
-    {170.680},
-    {225.000}
-};
-/* This structure holds information about 1-hop neighbors. */
-struct neighbor {
-  /* The ->next pointer is needed since we are placing these on a
-     Contiki list. */
-  struct neighbor *next;
-
-  /*current node, 1-hop neighbour */
-  uint16_t node_i;
-  uint16_t node_j;
-  /*weight: distance*/
-  float weight;
- };
- 
-/*for conversions from float to char[4] and vise versa*/
-union ff{
-	float f;
-	unsigned char b4[sizeof(float)];
-};
-
-/*this structure holds information about 2-hop neighbors.*/
-
-struct twohopneighs {
-		struct twohopneighs *next;
-		uint16_t id;
-		uint16_t * nn;
-		float * w;
-		uint8_t len;
-};
-
-//EDGES for MST calculation
-struct edge {
-	struct edge *next;
-	uint8_t i_ind;
-	uint8_t * j_ind;
-};
-
+/*the quiet phase of the computation: the delay above and LMST must fit in it*/
+#define COMPUTE_TIME (10*CLOCK_SECOND)
 
-	
-	
 static float myx,myy;
-static uint16_t numofv;
-static uint8_t parent[MAX_NEIGHBORS+1]; 
 static process_event_t lmst_start_event, lmst_finish_event, prim_start_event, prim_finish_event;
-float str2float(char *str);
 
+/*the computation: not started yet, in progress, done (it may then be run again from the shell)*/
+static enum { WAITING, COMPUTING, COMPUTED } state;
+#if CALIBRATE_ENABLED
+/*in the calibration phases: beacons starting with CALIBRATE_BEACON and CALIBRATE_REPORT are the calibration's*/
+static uint8_t calibrating;
+#endif
+#if SYMMETRIC_MODE != SYMMETRIC_NONE
+/*in the confirmation phase: beacons starting with SYMMETRIC_BEACON are the confirmation's*/
+static uint8_t confirming;
+#endif
+/*the transmission power it picked, and whether the computation succeeded*/
+static uint8_t ll;
+static uint8_t valid;
+#if !LMST_XTC
+/*the forests of the k-LMST (1: the local MST alone), and the power of the local MST in the last computation with more*/
+static uint8_t k = LMST_K;
+static uint8_t ll_mst;
+#endif
+#if MAINTAIN_ENABLED
+/*in the maintenance: beacons starting with MAINTAIN_BEACON are the maintenance's; the neighbourhood changed since the
+  last computation*/
+static uint8_t maintaining, dirty;
+#endif
 
+/*---------------------------------------------------------------------------*/
+/*the logical neighbours (after lmst_prim) into e, with their power levels and positions; returns their number*/
+static uint16_t
+logical_entries(struct topocache_entry *e)
+{
+  struct neighbor *nb;
+  uint16_t ids[MAX_NEIGHBORS], i, n;
+  uint8_t levels[MAX_NEIGHBORS];
+
+  n = lmst_logical(rimeaddr_node_addr.u8[0], ids, levels);
+  for(i = 0; i < n; ++i) {
+    for(nb = lmst_neighbors(); nb != NULL && nb->node_j != ids[i]; nb = list_item_next(nb));
+    e[i].id = ids[i];
+    e[i].level = levels[i];
+    e[i].x = nb->x;
+    e[i].y = nb->y;
+  }
+  return n;
+}
 
+/*publishes the logical neighbours to the routing layer, with their power levels for unicasts, and keeps them in flash*/
+static void
+publish_logical(void)
+{
+  struct topocache_entry e[MAX_NEIGHBORS];
+  uint16_t n;
+
+  n = logical_entries(e);
+#if SYMMETRIC_MODE != SYMMETRIC_NONE
+  /*the symmetric links of the confirmation round, and the power that keeps them*/
+  n = symmetric_links(e, n, MAX_NEIGHBORS);
+  ll = symmetric_power(e, n, ll);
+#endif
+  topocache_store(e, n, ll);
+  topocache_apply();
+}
 
-MEMB(neighbor_memb, struct neighbor, MAX_NEIGHBORS);
-LIST(neighbor_list);
+/*the result of the computation: the logical neighbours (none for a node with no neighbours; a failed computation keeps
+  the previous ones), the power and the memory peak*/
+static void
+report_logical(void)
+{
+  if (valid){
+	publish_logical();
+  }
+  telemetry_value(TELEMETRY_POWER, ll);
+  telemetry_value(TELEMETRY_MEMORY, lmst_memory());
+}
 
-MEMB(twohopneighs_memb, struct twohopneighs,MAX_NEIGHBORS);
-LIST(twohopneighs_list);
+#if SYMMETRIC_MODE != SYMMETRIC_NONE
+/*the confirmation beacon: the logical neighbours the computation picked, if it succeeded*/
+static void
+confirmation_beacon(void)
+{
+  struct topocache_entry e[MAX_NEIGHBORS];
 
+  symmetric_beacon(e, valid ? logical_entries(e) : 0, myx, myy);
+}
+#endif
+/*---------------------------------------------------------------------------*/
+#if LINKEST_WEIGHT == LINKEST_RSSI
+/*the weights of the 1-hop neighbours, from their average RSSI (at the end of the 1-hop discovery)*/
+static void
+rssi_weights(void)
+{
+  struct neighbor *n;
 
-MEMB(edge_memb, struct edge, MAX_NEIGHBORS);
-LIST(edge_list);
+  for(n = lmst_neighbors(); n != NULL; n = list_item_next(n)) {
+    lmst_set_weight(n, linkest_weight(n->node_j));
+  }
+}
+#endif
+/*---------------------------------------------------------------------------*/
+#if CALIBRATE_ENABLED
+/*the weight of a 1-hop neighbour, for the calibration; negative if unknown*/
+static float
+neighbor_weight(uint16_t id)
+{
+  struct neighbor *n;
 
+  for(n = lmst_neighbors(); n != NULL; n = list_item_next(n)) {
+    if(n->node_j == id) {
+      return n->weight;
+    }
+  }
+  return -1;
+}
+#endif
 /*---------------------------------------------------------------------------*/
 PROCESS(b_process, "Broadcast thread");
 PROCESS(lmst_process, "LMST thread");
 PROCESS(prim_process, "PRIM");
 AUTOSTART_PROCESSES(&b_process, &lmst_process,&prim_process);
 /*---------------------------------------------------------------------------*/
-
-//removing 1- and 2-hop neighbors from respective lists.
-static char
-remove_2hopneighbor(void *n)
-{
-  struct twohopneighs *e = n;
-
-  list_remove(twohopneighs_list, e);
-  return memb_free(&twohopneighs_memb, e);
- 
-}
-
-static char
-remove_neighbor(void *n)
+#if MAINTAIN_ENABLED
+/*a maintenance beacon: the neighbour is alive, and its position and 1-hop table are kept; a change of either one is a
+  change of the neighbourhood*/
+static void
+maintenance_recv(uint16_t id, const uint8_t *buf, uint16_t len)
 {
-  struct neighbor *e = n;
-
-  list_remove(neighbor_list, e);
-  return memb_free(&neighbor_memb, e);
-  
-  
+  const struct maintain_neighbor *n;
+  uint8_t changed = 0;
+
+  switch(maintain_heard(id, buf, len)) {
+  case MAINTAIN_IGNORED:
+    return;
+  case MAINTAIN_MOVED:
+    lmst_remove_neighbor(id);
+    /* fall through */
+  case MAINTAIN_NEW:
+    changed = 1;
+  }
+  n = maintain_neighbor(id);
+#if LINKEST_WEIGHT == LINKEST_RSSI
+  changed |= lmst_add_neighbor(rimeaddr_node_addr.u8[0], id, linkest_weight(id), n->x, n->y);
+#else
+  changed |= lmst_add_neighbor(rimeaddr_node_addr.u8[0], id, LMST_WEIGHT(myx, myy, n->x, n->y), n->x, n->y);
+#endif
+  changed |= lmst_update_twohop(id, buf + MAINTAIN_HEADER, len - MAINTAIN_HEADER);
+  if(changed) {
+    dirty = 1;
+    process_poll(&b_process);
+  }
 }
 
-//----------------------------------------------------------------------
-float str2float(char * str)
+/*a neighbour whose beacons stopped*/
+static void
+expired(uint16_t id)
 {
-	float r, num;
-	char * s = strdup(str);
-	char * a =(char *) strtok(s, "."), b[3];
-	num = atoi(a);
-	r = num;
-	a = (char *) strtok(NULL, ".");
-	b[0] = a[0];
-	b[1] = a[1];
-	b[2] = a[2];
-	num = atoi(b);
-	r += (r<0 ? - (num / 1000) : (num / 1000));
-	return r;
+  lmst_remove_neighbor(id);
 }
-
-
-//----------------------------------------------------------------------
-//----------------------------------------------------------------------
+#endif
+/*---------------------------------------------------------------------------*/
 static void
 broadcast_recv(struct broadcast_conn *c, const rimeaddr_t *from)
 {
   
   unsigned char * tmp1;
-  char * * x, * y;
+  char * x, * y;
   float dx, dy;
-  struct neighbor *e;
-  struct twohopneighs *ee;
-  uint16_t ii,kk, ll, vall;
-  uint8_t * tttmp;
-  union ff f1;
   
   
   //int16_t rssi = (int16_t)(packetbuf_attr(PACKETBUF_ATTR_RSSI) - 45);
   
   
+  rendezvous_recv();
+#if CALIBRATE_ENABLED
+  tmp1 = (unsigned char *)packetbuf_dataptr();
+  if (calibrating && tmp1[0] == CALIBRATE_BEACON){
+	calibrate_heard(from->u8[0]);
+	return;
+  }
+  if (calibrating && tmp1[0] == CALIBRATE_REPORT){
+	calibrate_reported(from->u8[0]);
+	return;
+  }
+#endif
+#if SYMMETRIC_MODE != SYMMETRIC_NONE
+  tmp1 = (unsigned char *)packetbuf_dataptr();
+  if (confirming && tmp1[0] == SYMMETRIC_BEACON){
+	symmetric_recv(from->u8[0]);
+	return;
+  }
+#endif
+#if LINKEST_WEIGHT == LINKEST_RSSI
+  //every beacon is a sample of the link
+  linkest_sample(from->u8[0], (int16_t)packetbuf_attr(PACKETBUF_ATTR_RSSI) - 45);
+#endif
+#if MAINTAIN_ENABLED
+  tmp1 = (unsigned char *)packetbuf_dataptr();
+  if (maintaining && tmp1[0] == MAINTAIN_BEACON){
+	//the tables are left alone while the computation reads them; the beacon comes again
+	if (state != COMPUTING){
+		maintenance_recv(from->u8[0], tmp1, packetbuf_datalen());
+	}
+	return;
+  }
+#endif
   tmp1 = (unsigned char *)packetbuf_dataptr();
  
   if(tmp1[0] == 'N'){ //final - neighbourhood rediscovery
-    printf("NEIGHBOR %d\n", from->u8[0]);
-	free(x); 
-	free(y);
-	free(e);
-	free(tmp1);
-	free(ee); 
+    telemetry_value(TELEMETRY_NEIGHBOR, from->u8[0]);
 	return;
   }
  
  
+  PROFILE_BEGIN(PROFILE_DISCOVERY);
   if (tmp1[0] == '$') //1-hop neighbour discovery (initial step)
   {
-  tmp1 = strdup(&tmp1[1]);
+#if LINKEST_WEIGHT == LINKEST_RSSI
+  //the beacon is the id alone; the weight is set from the average RSSI at the end of the discovery
+  lmst_add_neighbor(rimeaddr_node_addr.u8[0], from->u8[0], 0, 0, 0);
+  PROFILE_END(PROFILE_DISCOVERY);
+  return;
+#endif
+  tmp1 = (unsigned char *)strdup((char *)&tmp1[1]);
 
 
-  x = strtok(tmp1, "#");
+  x = strtok((char *)tmp1, "#");
   y = strtok(NULL, "#");
  
   dx = str2float(x);
   dy = str2float(y);
-  if (list_length(neighbor_list) >= MAX_NEIGHBORS){
-	 free(x);
-	 free(y);
-	 free(e);
-	 free(ee);
-	 free(tmp1);
-     return;
-	  
-	  }
-	  
-
-		  
-  for(e = list_head(neighbor_list); e != NULL; e = list_item_next(e)) {
-    if(from->u8[0] ==  e->node_j) {
-	/* free(x);
-	 free(y);
-	 free(e);
-	 free(ee);
-	 free(tmp1);*/
-     return;
-    }
-  }
- 
-  if (from->u8[0] == rimeaddr_node_addr.u8[0]){
-	  return;
-	  }
 //place in 1-hop neighbours list	
-  e = memb_alloc(&neighbor_memb);
-  if(e != NULL) {
-	e->node_i = rimeaddr_node_addr.u8[0];
-    e->node_j = from->u8[0];
-    //set weight
-    e->weight =  (float)((myy - dy) * (myy - dy) + (myx - dx) * (myx - dx));
-	list_add(neighbor_list, e);
-    }
+#if RAMP_ENABLED
+  //ramped discovery: the neighbours the node reaches
+  if (ramp_heard(from->u8[0], dx, dy))
+#endif
+  lmst_add_neighbor(rimeaddr_node_addr.u8[0], from->u8[0], LMST_WEIGHT(myx, myy, dx, dy), dx, dy);
   
-	free(x); 
-	free(y);
-	free(e);
 	free(tmp1);
-	free(ee);
+	PROFILE_END(PROFILE_DISCOVERY);
 	return;
 
 
   }
   
   //if you have reached at this point, then you are in the 2nd hop neighbourhood discovery.
-  if (list_length(twohopneighs_list) >= MAX_NEIGHBORS){
-	 free(x);
-	 free(y);
-	 free(e);
-	 free(ee);
-	 free(tmp1);
-     return;
-	  
+  if (tmp1[0] != LMST_TWOHOP_BEACON){
+	PROFILE_END(PROFILE_DISCOVERY);
+	return;
   }
-  //2-hop neighbor
-  for (ee = list_head(twohopneighs_list); ee !=NULL; ee = list_item_next(ee)) {
-	  if (from->u8[0] == ee -> id) {
-		//shouldnt be in here...
-		free(x); 
-		free(y);
-		free(e);
-		free(tmp1);
-		free(ee); 
-		return; 
-		 }
-	  
-	  
+#if RAMP_ENABLED
+  //a node that reaches further than this one sends its table to nodes that did not keep it
+  if (!ramp_neighbor(from->u8[0])){
+	PROFILE_END(PROFILE_DISCOVERY);
+	return;
   }
-  
+#endif
   //place in 2-hop neighbourhood
-  ee = memb_alloc(&twohopneighs_memb);
-  
-  if (ee !=NULL){
-	tttmp = (uint8_t *)packetbuf_dataptr();
-	
-	ll = packetbuf_datalen() / 3; //3 BYTES per neighbour
-	  ee->id = from->u8[0];
-	   ee->len = ll;
-	  
-	  ee->nn = malloc(sizeof(uint16_t)*ll);
-	  ee->w = malloc(sizeof(float)*ll);
-	  for (ii=0;ii<ll;ii++){
-		  ee->nn[ii] =0;
-		  ee->w[ii] = 0.0;
-		  }
-	  
-	  ii = 0;
-	   for (kk= 0; kk< ll*3;kk=kk+3)
-	  {
-		ee->nn[ii] = tttmp[kk];
-		vall = tttmp[kk+1]<<8 | tttmp[kk+2];
-
-
-		ee->w[ii] = (float)(vall * 1000.0 / 200000.00); //you are receing in uint16 - convert back to float
-		ii++;  
-	  }
-	  list_add(twohopneighs_list, ee);
-  }
-  
- free(x); 
-  free(y);
-  free(e);
-  free(tmp1);
-  free(ee); 
-  
-  
+  lmst_add_twohop(from->u8[0], tmp1 + 1, packetbuf_datalen() - 1);
+  PROFILE_END(PROFILE_DISCOVERY);
 }
 
 static const struct broadcast_callbacks broadcast_call = {broadcast_recv};
 static struct broadcast_conn broadcast;
 
+#if MAINTAIN_ENABLED
+/*the maintenance beacon: the position of the node and its 1-hop table*/
+static void
+maintenance_beacon(void)
+{
+  uint8_t *buf;
+  uint16_t n;
+
+  packetbuf_clear();
+  buf = packetbuf_dataptr();
+  n = maintain_beacon(buf, myx, myy);
+  n += lmst_twohop_payload(buf + n);
+  packetbuf_set_datalen(n);
+  rendezvous_send(&broadcast);
+}
+#endif
+
+/*SHELL COMMANDS---------------------------------------------------------------------------*/
+static void
+shell_nbr(char *args)
+{
+  struct neighbor *n;
+
+  for(n = lmst_neighbors(); n != NULL; n = list_item_next(n)) {
+    SHELL_PRINTF("%u d2 %u level %u\n", n->node_j, (unsigned)n->weight, power_level(n->weight));
+  }
+  SHELL_PRINTF("%d neighbours\n", lmst_num_neighbors());
+}
+
+static void
+shell_twohop(char *args)
+{
+  struct twohopneighs *t;
+  uint8_t i;
+
+  for(t = lmst_twohops(); t != NULL; t = list_item_next(t)) {
+    printf(SHELL_PREFIX "%u:", t->id);
+    for(i = 0; i < t->len; ++i) {
+      printf(" %u", t->nn[i]);
+    }
+    printf("\n");
+  }
+  SHELL_PRINTF("%d tables\n", lmst_num_twohops());
+}
+
+static void
+shell_logical(char *args)
+{
+  uint8_t i;
+
+  if(state != COMPUTED) {
+    SHELL_PRINTF("not computed yet\n");
+    return;
+  }
+  /*as published (made symmetric with SYMMETRIC_CONF_MODE)*/
+  printf(SHELL_PREFIX "%u:", topology_count());
+  for(i = 0; i < topology_count(); ++i) {
+    printf(" %u", topology_neighbor(i));
+  }
+  printf("\n");
+}
+
+static void
+shell_power(char *args)
+{
+  SHELL_PRINTF("txpower %d, computed %u\n", cc2420_get_txpower(), state == COMPUTED ? ll : 0);
+#if !LMST_XTC
+  if(state == COMPUTED && k > 1) {
+    SHELL_PRINTF("k %u, local MST %u\n", k, ll_mst);
+  }
+#endif
+}
+
+static void
+shell_table(char *args)
+{
+  uint8_t i;
+
+  for(i = 0; i < POWER_LEVELS; ++i) {
+    SHELL_PRINTF("level %u d2 %u\n", POWER_LEVEL(i), (unsigned)POWER[i]);
+  }
+}
+
+static void
+shell_txpower(char *args)
+{
+  uint16_t id;
+  uint8_t i, level;
+
+  for(i = 0; i < txpower_count(); ++i) {
+    level = txpower_entry(i, &id);
+    SHELL_PRINTF("%u level %u\n", id, level);
+  }
+  SHELL_PRINTF("%u neighbours, others and broadcasts %u\n", txpower_count(), TXPOWER_MAX);
+}
+
+static void
+shell_cache(char *args)
+{
+  const struct topocache_entry *e;
+  uint8_t i;
+
+  if(!topocache_valid()) {
+    SHELL_PRINTF("no cache\n");
+    return;
+  }
+  for(i = 0; i < topocache_count(); ++i) {
+    e = topocache_entry(i);
+    SHELL_PRINTF("%u level %u at %d#%d\n", e->id, e->level, (int)e->x, (int)e->y);
+  }
+  SHELL_PRINTF("%u neighbours, power %u\n", topocache_count(), topocache_power());
+}
+
+static void
+shell_mem(char *args)
+{
+  static const char *names[LMST_POOLS] = { "neighbors", "twohops", "edges" };
+  uint8_t used[LMST_POOLS], most[LMST_POOLS], i;
+
+  lmst_pools(used, most);
+  for(i = 0; i < LMST_POOLS; ++i) {
+    SHELL_PRINTF("%s %u/%u peak %u\n", names[i], used[i], MAX_NEIGHBORS, most[i]);
+  }
+  SHELL_PRINTF("tables %d bytes\n", lmst_memory());
+}
+
+#if !LMST_XTC
+static void
+shell_k(char *args)
+{
+  int n;
+
+  if(*args != '\0') {
+    n = atoi(args);
+    if(n < 1 || n > MAX_NEIGHBORS) {
+      SHELL_PRINTF("k 1..%u\n", MAX_NEIGHBORS);
+      return;
+    }
+    k = n;
+  }
+  SHELL_PRINTF("k %u\n", k);
+}
+#endif
+
+static void
+shell_run(char *args)
+{
+  if(state != COMPUTED) {
+    SHELL_PRINTF("busy\n");
+    return;
+  }
+  process_post(&lmst_process, lmst_start_event, NULL);
+}
+
+static const struct shell_command shell_commands[] = {
+  { "nbr", "1-hop neighbours: id, d^2, power level", shell_nbr },
+  { "twohop", "2-hop tables: id: its neighbours", shell_twohop },
+  { "logical", "neighbours in the local MST", shell_logical },
+  { "power", "transmission power, now and as computed", shell_power },
+  { "table", "power table: level, squared distance it reaches", shell_table },
+  { "txpower", "unicast power level of each logical neighbour", shell_txpower },
+  { "cache", "topology kept in flash: neighbours, level, position", shell_cache },
+  { "mem", "table pools (used/size, peak) and memory", shell_mem },
+#if !LMST_XTC
+  { "k", "forests of the k-LMST, from the next run", shell_k },
+#endif
+  { "run", "computes the topology again", shell_run },
+  { NULL, NULL, NULL }
+};
+
 
 
 
 /*MAIN THREAD------------------------------------------------------------------------------*/
 PROCESS_THREAD(b_process, ev, data)
 {
-  static struct etimer send_timer, redelca_timer;
-  
-  static uint32_t start_energy_cpu, start_energy_rx, start_energy_tx;
-  static uint32_t end_energy_cpu, end_energy_rx, end_energy_tx;
+  static struct etimer send_timer;
  
   static char * msg, * my_x, * my_y, * position;
   
-  static struct neighbor * new;
-  static uint16_t i, k,val;
+  static uint16_t i;
   
   
 	static uint8_t *msg1;  
+	static uint8_t beacon;
+#if RAMP_ENABLED
+	static uint8_t level;
+#endif
+#if MAINTAIN_ENABLED
+	static struct neighbor *nb;
+#endif
  
     PROCESS_EXITHANDLER(broadcast_close(&broadcast));
 	PROCESS_BEGIN();
 
 
-   /* Initialize the memory for the neighbor table entries. */
-	memb_init(&neighbor_memb);
-
-  /* Initialize the list used for the neighbor table. */
-  list_init(neighbor_list);
-  
-  
-  /* Initialize the memory for the neighbor table entries. */
-	memb_init(&twohopneighs_memb);
-
-  /* Initialize the list used for the neighbor table. */
-  list_init(twohopneighs_list);
+   /* Initialize the neighbor tables. */
+	lmst_init();
+	linkest_init();
+#if CALIBRATE_ENABLED
+	calibrate_init();
+#endif
+#if SYMMETRIC_MODE != SYMMETRIC_NONE
+	symmetric_init();
+#endif
+#if MAINTAIN_ENABLED
+	maintain_init();
+#endif
+	topology_init();
+	/*the topology of the last run, if any, until the computation confirms or replaces it*/
+	if (topocache_load() >= 0){
+		topocache_apply();
+	}
+	shell_init(shell_commands);
   
   
 
     
 	broadcast_open(&broadcast, 129, &broadcast_call);
+	/*radio off until the position discovery*/
+	rendezvous_init();
   
-  /*Wait for the position from Cooja script*/
+  /*Wait for the position (x#y) from Cooja script: the other lines are shell commands*/
   
-	PROCESS_YIELD_UNTIL(ev == serial_line_event_message);
+	PROCESS_YIELD_UNTIL(ev == serial_line_event_message && shell_position(data));
 	msg = strdup((char*) data);
   
 	position = strdup((char*) data);
@@ -397,28 +575,88 @@ PROCESS_THREAD(b_process, ev, data)
 		strcat(position,"$");
 		strcat(position,(char *)data);
 	}
+#if LINKEST_WEIGHT == LINKEST_RSSI
+	position[1] = '\0'; //the weights come from the RSSI, the beacon carries no position
+#endif
 
   
 	myx = str2float(my_x);
 	myy = str2float(my_y);
 
-  /*Set timers redelca timer to 60s and broadcast timer (1st hop neighbour discovery)*/
-	etimer_set(&redelca_timer,60*CLOCK_SECOND);
-	etimer_set(&send_timer,((10  + rimeaddr_node_addr.u8[0] % TIMEFRAME) * CLOCK_SECOND));
-	PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&send_timer));
-  /*Prepare broadcast buffer and broadcast your position*/
+	energy_begin(ENERGY_POSITION);
+
+#if RAMP_ENABLED
+  /*1st hop neighbour discovery, ramped: a phase per step of the power, the position is broadcasted in the node's slot at
+    the level of the phase until the neighbours cover the node (see ramp.h)*/
+	ramp_init(myx, myy);
+	for(beacon = 0; beacon < RAMP_ROUNDS; ++beacon){
+	rendezvous_phase(RAMP_PHASE, rimeaddr_node_addr.u8[0] % RENDEZVOUS_SLOTS);
+	level = ramp_level(beacon);
+	PROCESS_WAIT_UNTIL(rendezvous_slot());
+	if (level > 0){
+		packetbuf_clear();
+		packetbuf_clear_hdr();
+		packetbuf_copyfrom(position, strlen(position));
+		packetbuf_set_attr(PACKETBUF_ATTR_RADIO_TXPOWER, level + 1);
+		rendezvous_send(&broadcast);
+	}
+	PROCESS_WAIT_UNTIL(rendezvous_ended());
+	}
+	free(my_x);
+	free(my_y);
+#else
+  /*1st hop neighbour discovery: 60s, the position is broadcasted in the node's slot of the window*/
+	rendezvous_phase(60*CLOCK_SECOND, rimeaddr_node_addr.u8[0] % RENDEZVOUS_SLOTS);
+	PROCESS_WAIT_UNTIL(rendezvous_slot());
+  /*Prepare broadcast buffer and broadcast your position, LINKEST_BEACONS times within the slot*/
+	for(beacon = 0; beacon < LINKEST_BEACONS; ++beacon){
+	if (beacon > 0){
+		etimer_set(&send_timer, RENDEZVOUS_SLOT / LINKEST_BEACONS);
+		PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&send_timer));
+	}
  
 	packetbuf_clear();
 	packetbuf_clear_hdr();
 	packetbuf_copyfrom(position, strlen(position));
-	broadcast_send(&broadcast);
+	rendezvous_send(&broadcast);
+	}
 	
 	free(my_x);
 	free(my_y);
  
  
-  PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&redelca_timer));
- 
+  PROCESS_WAIT_UNTIL(rendezvous_ended());
+#endif
+#if LINKEST_WEIGHT == LINKEST_RSSI
+  rssi_weights();
+#endif
+#if CALIBRATE_ENABLED
+  /*calibration of the power table (part of the 1-hop discovery): beacons at every power level in the node's slot, then
+    the reports of the neighbours*/
+  calibrating = 1;
+  rendezvous_phase(CALIBRATE_PHASE, rimeaddr_node_addr.u8[0] % RENDEZVOUS_SLOTS);
+  PROCESS_WAIT_UNTIL(rendezvous_slot());
+  for(beacon = 0; beacon < CALIBRATE_FRAMES; ++beacon){
+	if (beacon > 0){
+		etimer_set(&send_timer, RENDEZVOUS_SLOT / CALIBRATE_FRAMES);
+		PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&send_timer));
+	}
+	packetbuf_clear();
+	calibrate_beacon(beacon);
+	rendezvous_send(&broadcast);
+  }
+  PROCESS_WAIT_UNTIL(rendezvous_ended());
+
+  rendezvous_phase(CALIBRATE_PHASE, rimeaddr_node_addr.u8[0] % RENDEZVOUS_SLOTS);
+  PROCESS_WAIT_UNTIL(rendezvous_slot());
+  packetbuf_clear();
+  calibrate_report();
+  rendezvous_send(&broadcast);
+  PROCESS_WAIT_UNTIL(rendezvous_ended());
+  calibrating = 0;
+  calibrate_fit(neighbor_weight);
+#endif
+  energy_end(ENERGY_POSITION);
  
   
   free(msg);  
@@ -426,54 +664,44 @@ PROCESS_THREAD(b_process, ev, data)
   
   //-------------------2-hop neighbour discovery------------------------
   //start--------------------->>
-  start_energy_rx = energest_type_time(ENERGEST_TYPE_LISTEN);
-  start_energy_tx = energest_type_time(ENERGEST_TYPE_TRANSMIT);
-  start_energy_cpu = energest_type_time(ENERGEST_TYPE_CPU);
-   
+  energy_begin(ENERGY_TWOHOP);
   
-   if (list_length(neighbor_list) > 0) {
+  //wait to gather 2 hop neighborhood, 120s (a node with no neighbours only listens)
+  rendezvous_phase(120*CLOCK_SECOND, rimeaddr_node_addr.u8[0] % RENDEZVOUS_SLOTS);
+   if (lmst_num_neighbors() > 0) {
 
 
-	i=0;
-
-	msg1 = malloc(sizeof(uint8_t)*3*MAX_NEIGHBORS);
-	//format is: node id (1B) , weight (2B)
-    
-    for(new = list_head(neighbor_list); new != NULL; new = list_item_next(new))
-    {
-		msg1[i++] =  new->node_j & 0xFF;
-		val = (uint16_t)floor(new->weight * PRES_CONST / PRES_RANGE);
-		msg1[i++] = val>>8;//msb
-		msg1[i++] = val & 0xFF;//lsb
-    }
+	msg1 = malloc(sizeof(uint8_t)*(3*MAX_NEIGHBORS+1));
+	//format is: LMST_TWOHOP_BEACON, then node id (1B) , weight (2B) per neighbour
+	msg1[0] = LMST_TWOHOP_BEACON;
+	i = 1 + lmst_twohop_payload(msg1 + 1);
 
-    k = rimeaddr_node_addr.u8[0] % TIMEFRAME;
-    k = k *3;
-		
-    etimer_set(&redelca_timer, 120*CLOCK_SECOND); //wait to gather 2 hop neighborhood
-    etimer_set(&send_timer, (k+10) * CLOCK_SECOND); //a delay for handling concurrent transmissions.
-    PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&send_timer));
+    PROCESS_WAIT_UNTIL(rendezvous_slot());
     
    	packetbuf_clear();
 	packetbuf_clear_hdr();
 	
     packetbuf_copyfrom(msg1, sizeof(uint8_t)*i);
-    broadcast_send(&broadcast);
-   
-        
-   PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&redelca_timer));
+#if RAMP_ENABLED
+    //the table is for the neighbours alone
+    packetbuf_set_attr(PACKETBUF_ATTR_RADIO_TXPOWER, ramp_reach() + 1);
+#endif
+    rendezvous_send(&broadcast);
   
  }
- free(new);
+ PROCESS_WAIT_UNTIL(rendezvous_ended());
  free(msg1);
  
- end_energy_rx = energest_type_time(ENERGEST_TYPE_LISTEN);
- end_energy_tx = energest_type_time(ENERGEST_TYPE_TRANSMIT); //timings for 2-hop neighbour discovery
+ energy_end(ENERGY_TWOHOP);
+ energy_begin(ENERGY_COMPUTE);
  
- printf("ENERGY_TX %lu\n", end_energy_tx-start_energy_tx);
- printf("ENERGY_RX %lu\n", end_energy_rx-start_energy_rx);
+ //radio timings of the 2-hop neighbour discovery, kept for the motes log
+ telemetry_value(TELEMETRY_ENERGY_TX, energy_ticks(ENERGY_TWOHOP, ENERGY_TX));
+ telemetry_value(TELEMETRY_ENERGY_RX, energy_ticks(ENERGY_TWOHOP, ENERGY_RX));
  //<<-------------------------------------------------end
 
+ //the computation, in a quiet phase (radio off) that keeps the next window aligned
+ rendezvous_phase(COMPUTE_TIME, RENDEZVOUS_QUIET);
  etimer_set(&send_timer, SEND_TIME);
  
  PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&send_timer));
@@ -482,37 +710,85 @@ PROCESS_THREAD(b_process, ev, data)
  process_post(&lmst_process, lmst_start_event,NULL);
  
  PROCESS_YIELD_UNTIL(ev == lmst_finish_event);
- 
+ PROCESS_WAIT_UNTIL(rendezvous_ended());
   
-  end_energy_cpu = energest_type_time(ENERGEST_TYPE_CPU);
+  energy_end(ENERGY_COMPUTE);
   
+ /**--------final 1-hop neigh (after setting the transmission power)**/
   
- /**--------final 1-hop neigh (after setting the transmission power)**//
-  
-  start_energy_rx = energest_type_time(ENERGEST_TYPE_LISTEN);
-  start_energy_tx = energest_type_time(ENERGEST_TYPE_TRANSMIT);
+  energy_begin(ENERGY_VERIFY);
+#if SYMMETRIC_MODE != SYMMETRIC_NONE
+  /*confirmation round, at the computed power: the logical neighbours each node picked; then the links are made
+    symmetric, the power adjusted to them, and the result published and reported (see symmetric.h)*/
+  cc2420_set_txpower(ll);
+  confirming = 1;
+  rendezvous_phase(SYMMETRIC_PHASE, rimeaddr_node_addr.u8[0] % RENDEZVOUS_SLOTS);
+  PROCESS_WAIT_UNTIL(rendezvous_slot());
+  packetbuf_clear();
+  confirmation_beacon();
+  rendezvous_send(&broadcast);
+  PROCESS_WAIT_UNTIL(rendezvous_ended());
+  confirming = 0;
+  symmetric_end();
+  report_logical();
+#endif
+  /*the verification beacon goes at the computed power*/
+  cc2420_set_txpower(ll);
  
-  etimer_set(&redelca_timer,  60*CLOCK_SECOND);
+  rendezvous_phase(60*CLOCK_SECOND, rimeaddr_node_addr.u8[0] % RENDEZVOUS_SLOTS);
   
-  etimer_set(&send_timer, ((10 + rimeaddr_node_addr.u8[0] % TIMEFRAME) * CLOCK_SECOND));
-  
-  PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&send_timer));
+  PROCESS_WAIT_UNTIL(rendezvous_slot());
   //Prepare broadcast buffer and broadcast message
   packetbuf_clear();
   position = strdup("N\0");
   packetbuf_attr_clear();
   packetbuf_copyfrom(position, strlen(position));
-  broadcast_send(&broadcast);
+  rendezvous_send(&broadcast);
  // 
-  PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&redelca_timer));
-  end_energy_rx = energest_type_time(ENERGEST_TYPE_LISTEN);
-  end_energy_tx = energest_type_time(ENERGEST_TYPE_TRANSMIT);
-  printf("ENERGY_CPU %lu\n", end_energy_cpu-start_energy_cpu);
-  printf("ENERGY_TX %lu\n", end_energy_tx-start_energy_tx);
-  printf("ENERGY_RX %lu\n", end_energy_rx-start_energy_rx);
+  PROCESS_WAIT_UNTIL(rendezvous_ended());
+  energy_end(ENERGY_VERIFY);
+  //CPU from the 2-hop discovery to the end of LMST, radio of the verification beacon
+  telemetry_value(TELEMETRY_ENERGY_CPU, energy_ticks(ENERGY_TWOHOP, ENERGY_CPU) + energy_ticks(ENERGY_COMPUTE, ENERGY_CPU));
+  telemetry_value(TELEMETRY_ENERGY_TX, energy_ticks(ENERGY_VERIFY, ENERGY_TX));
+  telemetry_value(TELEMETRY_ENERGY_RX, energy_ticks(ENERGY_VERIFY, ENERGY_RX));
+  energy_report();
 
  
-  printf("DONE\n");
+  PROFILE_REPORT();
+  telemetry_event(TELEMETRY_DONE);
+  /*the radio is the application's again, duty-cycled: broadcasts at full power, unicasts at the level of their
+    receiver (see txpower.h)*/
+  cc2420_set_txpower(TXPOWER_MAX);
+  rendezvous_stop();
+#if MAINTAIN_ENABLED
+  /*maintenance (see maintain.h): a beacon per Trickle interval; a change of the neighbourhood, heard or a neighbour
+    expired, ends the interval, and the node computes again and starts over from the shortest one*/
+  for(nb = lmst_neighbors(); nb != NULL; nb = list_item_next(nb)){
+	maintain_add(nb->node_j, nb->x, nb->y);
+  }
+  maintain_start();
+  maintaining = 1;
+  while(1){
+	etimer_set(&send_timer, maintain_send_time());
+	PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&send_timer) || (dirty && maintain_interval() > MAINTAIN_IMIN));
+	if (etimer_expired(&send_timer)){
+		maintenance_beacon();
+		etimer_set(&send_timer, maintain_interval() - maintain_send_time());
+		PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&send_timer) || (dirty && maintain_interval() > MAINTAIN_IMIN));
+	}
+	if (maintain_expire(expired) > 0){
+		dirty = 1;
+	}
+	if (dirty){
+		dirty = 0;
+		process_post(&lmst_process, lmst_start_event, NULL);
+		PROCESS_YIELD_UNTIL(ev == lmst_finish_event);
+		maintain_reset();
+	} else {
+		maintain_double();
+	}
+  }
+#endif
   PROCESS_END();
 }
 
@@ -521,279 +797,93 @@ PROCESS_THREAD(b_process, ev, data)
 PROCESS_THREAD(lmst_process, ev,data)
 {
 
-	static uint16_t ii,jj,kk,ll,maxn;
-
-	static struct neighbor *tmpn;
-
-	static struct twohopneighs *tmpnn;
+	static uint16_t maxn;
 
-    static struct edge *tmpe;
+	static short numofv;
 
-    static float a, maxp, b;
-    
-	static int mem;
-
-	static uint8_t found;
-	
+	static uint8_t repaired;
+#if !LMST_XTC
+	uint8_t kl[3];
+#endif
 
 	PROCESS_BEGIN();
-    
-    memb_init(&edge_memb);
-    
-    list_init(edge_list);
-    
+
+ //the first computation is started by the main thread, later ones by the shell (run)
+ while(1){
 	PROCESS_YIELD_UNTIL(ev == lmst_start_event);
+	state = COMPUTING;
 
-   printf("DELAUNAY\n");
-   
-   numofv = list_length(neighbor_list);
-   maxn = list_length(twohopneighs_list);
- 
+	telemetry_event(TELEMETRY_DELAUNAY);
  
-  printf("NEIGHBOR %d\n",numofv);
-  
-  if (numofv > MAX_NEIGHBORS || maxn > MAX_NEIGHBORS){
-	  
-	  printf("INITIALIZE %d", -255); //error handling
-	  goto myexit;
-	  }
-  
- 
- 
- 	   //check if in 2-hop neighborhood there are unknown 1st hop neighs
-	   tmpnn = list_head(twohopneighs_list);
-	   while (tmpnn !=NULL){
-	
-		   found = 0;
-		   for (tmpn = list_head(neighbor_list); tmpn !=NULL; tmpn = list_item_next(tmpn)){
-
-				if (tmpnn->id == tmpn->node_j)
-				{
-					found=1;
-				}
-		   }
-	
-		   if (found ==0){
-			
-				if (remove_2hopneighbor(tmpnn)<0){
-					printf("INITIALIZE %d\n",-5); //error handling
-					goto myexit;
-					}
-				tmpnn = list_item_next(tmpnn);
-			}
-		   else {
-			   	tmpnn = list_item_next(tmpnn);
-		   }
-	   }
-	   numofv = list_length(neighbor_list);
-	   maxn = list_length(twohopneighs_list);
-	      
-  
-	  tmpn = list_head(neighbor_list);
-	   while (tmpn !=NULL){
-		   found = 0;
-		   for (tmpnn = list_head(twohopneighs_list); tmpnn !=NULL; tmpnn = list_item_next(tmpnn)){
-				if (tmpnn->id == tmpn->node_j)
-				{
-					found=1;
-				}
-		   }
-		   if (found ==0){
-			   if (remove_neighbor(tmpn) <0){
-					printf("INITIALIZE %d\n",-6); //error handling
-					goto myexit;
-					}
-					tmpn = list_item_next(tmpn);
-			}
-		   
-		   else {
-			   	tmpn = list_item_next(tmpn);
-			   }
-	   }
-	   numofv = list_length(neighbor_list);
-	   maxn = list_length(twohopneighs_list);
-	   
-//	}
-//done with 1- and 2-hop checks.
-
-   if (numofv != maxn) {
-		printf("INITIALIZE %d\n", -1); //error handling
-	   goto myexit;
-	   }
-
-//let's try to create the edges for 1- and 2-hop neighbours graph.
-
-  	tmpe = memb_alloc(&edge_memb);
-
-  	if (tmpe !=NULL){
-		tmpe->i_ind = 0;
-		tmpe->j_ind = malloc(sizeof(uint8_t)*(numofv+1));
-		if (tmpe->j_ind == NULL){
-			printf("INITIALIZE %d\n", -254); //error handling
-			goto myexit;
-			}
-		tmpe->j_ind[0] = 0; //0x0 element
-		ii=1;
-		for (tmpnn = list_head(twohopneighs_list); tmpnn!=NULL && ii<numofv+1; tmpnn = list_item_next(tmpnn)){
-
-			tmpe->j_ind[ii] = 1;
-			ii++;
-		}
-
-		list_add(edge_list, tmpe);
+	telemetry_value(TELEMETRY_NEIGHBOR, lmst_num_neighbors());
+  
+#if LMST_XTC
+	//XTC mode: the kept neighbours, from the ranked 1-hop tables (see lmst_xtc); no graph and no Prim stage
+	PROFILE_BEGIN(PROFILE_XTC);
+	numofv = lmst_xtc(rimeaddr_node_addr.u8[0]);
+	PROFILE_END(PROFILE_XTC);
+	repaired = 1;
+#else
+	//a few changes of the neighbourhood since the last computation update its local MST (see lmst_repair), more
+	//of them (and the first computation) compute it again; the forests of the k-LMST are always computed again
+	repaired = 0;
+	if (k == 1){
+	PROFILE_BEGIN(PROFILE_REPAIR);
+	numofv = lmst_repair(rimeaddr_node_addr.u8[0]);
+	PROFILE_END(PROFILE_REPAIR);
+	repaired = numofv != LMST_REBUILD;
 	}
+#endif
 
-	else {
-	   printf("INITIALIZE %d\n", -2);//error handling
-	   goto myexit;
-		}
-    ii=1;
-	for(tmpn = list_head(neighbor_list); tmpn != NULL && ii<numofv+1; tmpn = list_item_next(tmpn))
-	{
-		tmpe = memb_alloc(&edge_memb);
-		if ( tmpe!= NULL) {
-
-
-		tmpe->i_ind = ii;
-		tmpe->j_ind = malloc(sizeof(uint8_t)*(numofv+1));
-       if (tmpe->i_ind == NULL){
-			printf("INITIALIZE %d", -2);//error handling
-			goto myexit;
-		   
-		}
-		for (jj=0;jj<numofv+1;jj++){
-			tmpe->j_ind[jj] = 0;
-
-
-		}
-
-		tmpe->j_ind[0] = 1; // this is the current node index
-		kk=1;
-       for (tmpnn = list_head(twohopneighs_list); tmpnn != NULL && kk<numofv+1; tmpnn = list_item_next(tmpnn)){
-		    found = 2;
-		    
-			if (tmpn->node_j != tmpnn -> id){
-			 if (tmpnn->len > MAX_NEIGHBORS){
-				 printf("INITIALIZE %d\n", -3);//error handling
-				 goto myexit;
-				 }	
-			 for (jj=0;jj<tmpnn->len;jj++){
-				 if (tmpnn->nn[jj] == tmpn->node_j) { //if your 1-st hop neighbour is also my 1-st hop neighbour.
-	       		   found = 0;
-					break;
-				 }
-				 
-			 }
-			 tmpe->j_ind[kk] = found ==0? 1:tmpe->j_ind[kk];
-		  }
-		  kk++;
-		}
-      list_add(edge_list, tmpe); //in list we add the 2-hop edges between 1-st hop neighs of the current node.
-      
-      }
-      
-      else{
-		  	printf("INITIALIZE %d\n", -4);//error handling
-		  
-	   goto myexit;	
-	
-		  
-		  }
-      ii++;
-     } 
-     
-
-  ll = 0;
-  mem = 0;
-  maxn = 0;
+	if (!repaired){
+	PROFILE_BEGIN(PROFILE_INITIALIZE);
+	numofv = lmst_initialize(rimeaddr_node_addr.u8[0]);
+	PROFILE_END(PROFILE_INITIALIZE);
+	}
   
-  printf("INITIALIZE %d\n", numofv);
+	telemetry_value(TELEMETRY_INITIALIZE, numofv); //negative: error handling
 
+	ll = 31;
+	maxn = numofv < 0 ? lmst_num_twohops() : 0;
   
-  if (numofv<1 || numofv>MAX_NEIGHBORS+1)
-  {
-	
-	  goto myexit;
-  } 
-  //calculate the MST based on Prim's algorithm. 
-  process_post(&prim_process, prim_start_event, NULL);
-  
-  PROCESS_YIELD_UNTIL(ev == prim_finish_event);
-
-  //and then get the lmst edges of the current node and get 
-  maxp = 0.0;
+	if (numofv>=1 && numofv<=MAX_NEIGHBORS+1)
+	{
+	//calculate the MST based on Prim's algorithm. 
+	if (!repaired){
+	process_post(&prim_process, prim_start_event, NULL);
   
- if (numofv > 1){
-	 ii=1;
-  for (tmpn = list_head(neighbor_list); tmpn !=NULL && ii<numofv+1; tmpn=list_item_next(tmpn))
-  {
-	
-	if (parent[ii] == rimeaddr_node_addr.u8[0]) {
-		a = POWER[7] - tmpn->weight;
-		kk = 7;
-		for (jj=0;jj<7;jj++){
-			b = POWER[jj] - tmpn->weight;
-			kk = (b>0 && a>b)?jj:kk;
-			a = (b>0 && a>b)?b:a;
-		}
-		ll = 3+4*kk > ll?3+4*kk:ll;
-		maxp = a>maxp?a:maxp;
-		maxn++;
+	PROCESS_YIELD_UNTIL(ev == prim_finish_event);
 	}
-	ii++;  
-  }
- }
- else {
-	 if (list_length(neighbor_list) == 1){
-		 maxn++;
-		 tmpn = list_head(neighbor_list);
-		 
-		 a = POWER[7] - tmpn->weight;
-		 kk = 7;
-	 
-		for (ii=0;ii<7;ii++) {
-			b = POWER[ii] - tmpn->weight;
-			kk = (b>0 && a>b) ? ii:kk;
-			a = (b>0 && a>b) ? b:a;
-		}
-
-		ll = 3+4*kk > ll ? 3+4*kk: ll;
-		maxp = a > maxp? a:maxp;
+
+	//and then get the lmst edges of the current node and get 
+	PROFILE_BEGIN(PROFILE_POWER);
+	ll = lmst_power(rimeaddr_node_addr.u8[0], &maxn);
+	PROFILE_END(PROFILE_POWER);
+#if !LMST_XTC
+	//the power the k-LMST costs over the local MST
+	if (k > 1){
+	kl[0] = k;
+	kl[1] = ll_mst;
+	kl[2] = ll;
+	telemetry_data(TELEMETRY_KLMST, kl, sizeof(kl));
 	}
-	else {
-		ll = 31;
-	 }
- }
+#endif
+	} 
 
-   myexit:
+	telemetry_value(TELEMETRY_REDELCA, maxn);
 
-   printf("REDELCA %d\n", maxn);
+	valid = numofv>=0 && numofv<=MAX_NEIGHBORS+1;
+#if SYMMETRIC_MODE != SYMMETRIC_NONE
+	//the first computation is published and reported after the confirmation round (main thread)
+	if (symmetric_confirmed())
+#endif
+	report_logical();
 
 
- if (ll < 3){
-	 ll = 31;
+	state = COMPUTED;
+	process_post(&b_process, lmst_finish_event, NULL);
  }
 
-
- cc2420_set_txpower(ll);
- //calc the memory peak..
-   mem = list_length(neighbor_list)*sizeof(struct neighbor) + list_length(twohopneighs_list)*sizeof(struct twohopneighs) + list_length(edge_list)*(sizeof(struct edge)) + (numofv+1)*sizeof(uint8_t);
-   
-   for (tmpnn = list_head(twohopneighs_list); tmpnn != NULL; tmpnn = list_item_next(tmpnn)){
-  	mem = mem + tmpnn->len*(sizeof(float) +sizeof(uint16_t));
-  }
- printf("POWER %d\n", ll);
- printf("MEMORY %d\n", mem);
-  
-
-
- process_post(&b_process, lmst_finish_event, NULL);
- 
- free(tmpe);
- free(tmpn);
- free(tmpnn);
-
-
  PROCESS_END();
 
 }
@@ -801,150 +891,34 @@ PROCESS_THREAD(lmst_process, ev,data)
 //---------------------the PRIM algorithm-----------------------------//
 PROCESS_THREAD(prim_process, ev,data)
 {
-
- static uint8_t iv, ie, ik, ss, aa, tmpnode, currentnode, current_ind;
- 
- static float mincost, tmpval;
- static uint8_t totalvisited;
- 
- static struct neighbor * tmpneigh;
- static struct twohopneighs * tmptwoneigh; 
- static struct edge *tte;
-
-
- static uint8_t visited[MAX_NEIGHBORS+1], errorcode;
- static uint8_t s[MAX_NEIGHBORS+1];
- static uint16_t lw[MAX_NEIGHBORS+1];
+ uint8_t err;
 
  PROCESS_BEGIN();
- for (iv=0;iv<MAX_NEIGHBORS+1;iv++){
-	 visited[iv] = 0;
-	 parent[iv] = rimeaddr_node_addr.u8[0] & 0xff;
-	 s[iv] = 0;
-	 lw[iv] = 0;
-	 }
-
 	
- PROCESS_YIELD_UNTIL(ev == prim_start_event);
-
-
-  
- iv=1;   
- for (tmpneigh = list_head(neighbor_list); tmpneigh!=NULL && iv<numofv+1; tmpneigh= list_item_next(tmpneigh)){
-
-	lw[iv++] = (uint16_t)floor(tmpneigh->weight * PRES_CONST / PRES_RANGE);
-
- }
-  
-
-  visited[0] = 1;
-  lw[0] = 0;
-  s[0] +=1;
-  
-  totalvisited++;
-  
-  currentnode = rimeaddr_node_addr.u8[0];
-  
-  current_ind =0;
-  errorcode = 0;
-
-  do {
-	mincost = MAXVAL;
-	tmpnode = currentnode;
-	ss = 0;
-	iv=1;
-
-	for (tmpneigh = list_head(neighbor_list); tmpneigh !=NULL && iv<numofv+1; tmpneigh = list_item_next(tmpneigh)){
-
-		tmpval = (float)(lw[iv] * 1000.0 / 200000.00);
-	   
-		if (visited[iv] == 0) {
-
-	
-			if (tmpval <= mincost) {
-				if (s[iv]>=ss){
-					mincost = tmpval;//:mincost;
-					tmpnode = tmpneigh->node_j;//:tmpnode;
-				}
-				ss = s[iv];
-			}
-		}
-		iv++;
-
-	}
-	iv=1;
-	
-	for (tmpneigh = list_head(neighbor_list); tmpneigh!=NULL; tmpneigh = list_item_next(tmpneigh))	{
-		if (tmpneigh->node_j == tmpnode) {
-			if (visited[iv] ==1) {
-				//you shouldn't be in here!
-				errorcode = 1;
-				break;
-				}
-			else {
-			visited[iv] = 1;
-			current_ind = iv;
-			currentnode = tmpnode;
-			totalvisited++;
-			//printf("NEIGHBOR: now passing from %d", tmpnode);
-			break;
-		}
-		}
-
-		iv++;
-	}
-
-   
-	if (errorcode == 1 || iv == numofv+1){
-			printf("NEIGHBOR: ERROR\n");
-		break;
+ while(1){
+	PROCESS_YIELD_UNTIL(ev == prim_start_event);
+
+#if !LMST_XTC
+	//the k-LMST (k > 1) in place of the local MST
+	if (k > 1){
+	PROFILE_BEGIN(PROFILE_KFOREST);
+	err = lmst_kforest(rimeaddr_node_addr.u8[0], k, &ll_mst);
+	PROFILE_END(PROFILE_KFOREST);
 	}
-  //  printf("NEIGHBOR: currentnode %d:\n", currentnode);
-  
-   //update the graph's weights, based on the PRIM algorithm
-	tte = list_head(edge_list);
-	tte = list_item_next(tte);
-
-	for (ik=1;ik<numofv+1; ik++){
-	
-	    if (current_ind == ik) {
-			ie=1;
-			for (tmptwoneigh = list_head(twohopneighs_list); tmptwoneigh !=NULL && ie<numofv+1; tmptwoneigh = list_item_next(tmptwoneigh)){
-				if (tte->j_ind[ie] == 1){
-				 for (aa = 0; aa<tmptwoneigh->len; aa++){
-					if (tmptwoneigh->nn[aa] == currentnode){
-						iv=1;
-						for (tmpneigh =  list_head(neighbor_list); tmpneigh !=NULL && iv<numofv+1; tmpneigh = list_item_next(tmpneigh)){
-							if 	(tmpneigh->node_j == tmptwoneigh->id && visited[iv] == 0){
-								tmpval = (float)(lw[iv] * 1000.0 / 200000.00);
-								if (tmpval>tmptwoneigh->w[aa]){
-									lw[iv] = (uint16_t)floor(tmptwoneigh->w[aa] * PRES_CONST / PRES_RANGE);
-									parent[iv] = currentnode;
-								}
-								s[iv]++;
-							}
-							iv++;
-						}
-					}
-				}
-
-			}
-			ie++;
-		}
-		break;
+	else
+#endif
+	{
+	PROFILE_BEGIN(PROFILE_PRIM);
+	err = lmst_prim(rimeaddr_node_addr.u8[0]);
+	PROFILE_END(PROFILE_PRIM);
 	}
-	tte = list_item_next(tte);
+	if (err){
+		telemetry_event(TELEMETRY_ERROR);
 	}
-  } while (totalvisited<=numofv);
-  
-  free(tmpneigh);
-  free(tte);
 
-  free(tmptwoneigh);
-  process_post(&lmst_process, prim_finish_event, NULL);
-   
+	process_post(&lmst_process, prim_finish_event, NULL);
+ }
 	
 	PROCESS_END();
 	
 }
-
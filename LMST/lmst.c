@@ -0,0 +1,1113 @@
+/*
+ * Copyright (c) 2015, Computer Science Department (CSD), University of Crete, and 
+ * Signal Processing Lab (SPL), Institute of Computer Science (ICS), FORTH, Greece.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of CSD, SPL/ICS-FORTH nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * 
+ */
+
+/**
+ * \file
+ *  The LMST computation of a node: neighbour tables, local minimum spanning tree and transmission power selection.
+ *  The implementation is based at the description given at: N. Li, J. Hou, and L. Sha, “Design and analysis of an mst-based
+ *  topology control algorithm,” Wireless Communications, IEEE Transactions on, vol. 4, no. 3, pp. 1195–1206, May 2005.
+ *
+ *
+ *
+ * \author
+ *      Phivos Phivou <fivou@csd.uoc.gr>, Nancy Panousopoulou - <apanouso@ics.forth.gr>
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "lmst.h"
+#include "power.h"
+#include "lib/memb.h"
+
+MEMB(neighbor_memb, struct neighbor, MAX_NEIGHBORS);
+LIST(neighbor_list);
+
+MEMB(twohopneighs_memb, struct twohopneighs,MAX_NEIGHBORS);
+LIST(twohopneighs_list);
+
+
+MEMB(edge_memb, struct edge, MAX_NEIGHBORS);
+LIST(edge_list);
+
+static uint16_t numofv;
+static uint8_t parent[MAX_NEIGHBORS+1];
+
+#if MAX_NEIGHBORS > 31
+#error "the bitsets of the neighbourhood hold MAX_NEIGHBORS+1 bits"
+#endif
+/*the node's logical neighbours, by index (from 1, as in parent): a flag, since any id (the node's too) may be 0*/
+static uint32_t linked;
+
+/*the local MST of the last computation, between node ids (the node and its neighbours), with the weights lmst_prim
+  compares: lmst_repair updates it instead of computing it again*/
+struct tree_edge {
+	uint8_t a, b;
+	uint16_t w;
+};
+static struct tree_edge tree[MAX_NEIGHBORS];
+static uint8_t ntree, tree_valid;
+
+/*the nodes whose edges changed since the last computation; LMST_REPAIR_MAX + 1 of them means too many*/
+static uint8_t changed[LMST_REPAIR_MAX + 1];
+static uint8_t nchanged;
+
+/*most entries ever in use in the memory pools (see lmst_pools)*/
+static uint8_t peak[LMST_POOLS];
+
+#define NOTE_PEAK(_pool, _list) if (list_length(_list) > peak[_pool]) peak[_pool] = list_length(_list)
+
+//a node whose edges changed (joined, left, moved or sent a new 1-hop table)
+static void mark_changed(uint16_t id)
+{
+  uint8_t i;
+
+  for (i = 0; i < nchanged && i < LMST_REPAIR_MAX; i++){
+	  if (changed[i] == (id & 0xff)){
+		  return;
+	  }
+  }
+  if (nchanged <= LMST_REPAIR_MAX){
+	  changed[nchanged++] = id;
+  }
+}
+
+static uint8_t is_changed(uint8_t id)
+{
+  uint8_t i;
+
+  for (i = 0; i < nchanged; i++){
+	  if (changed[i] == id){
+		  return 1;
+	  }
+  }
+  return 0;
+}
+
+//removing 1- and 2-hop neighbors from respective lists.
+static char
+remove_2hopneighbor(void *n)
+{
+  struct twohopneighs *e = n;
+
+  list_remove(twohopneighs_list, e);
+  return memb_free(&twohopneighs_memb, e);
+ 
+}
+
+static char
+remove_neighbor(void *n)
+{
+  struct neighbor *e = n;
+
+  list_remove(neighbor_list, e);
+  return memb_free(&neighbor_memb, e);
+  
+  
+}
+
+//----------------------------------------------------------------------
+//frees the graph of a previous lmst_initialize
+static void free_edges(void)
+{
+  struct edge *tmpe;
+
+  while ((tmpe = list_pop(edge_list)) != NULL){
+	  free(tmpe->j_ind);
+	  memb_free(&edge_memb, tmpe);
+  }
+}
+
+//----------------------------------------------------------------------
+void lmst_init(void)
+{
+  struct twohopneighs *ee;
+
+  /*free what a previous computation left*/
+  for (ee = list_head(twohopneighs_list); ee != NULL; ee = list_item_next(ee)){
+	  free(ee->nn);
+	  free(ee->w);
+  }
+  free_edges();
+
+  /* Initialize the memory for the neighbor table entries. */
+  memb_init(&neighbor_memb);
+  /* Initialize the list used for the neighbor table. */
+  list_init(neighbor_list);
+
+  memb_init(&twohopneighs_memb);
+  list_init(twohopneighs_list);
+
+  memb_init(&edge_memb);
+  list_init(edge_list);
+
+  numofv = 0;
+  memset(peak, 0, sizeof(peak));
+  ntree = tree_valid = nchanged = 0;
+}
+
+struct neighbor * lmst_neighbors(void)
+{
+  return list_head(neighbor_list);
+}
+
+struct twohopneighs * lmst_twohops(void)
+{
+  return list_head(twohopneighs_list);
+}
+
+int lmst_num_neighbors(void)
+{
+  return list_length(neighbor_list);
+}
+
+int lmst_num_twohops(void)
+{
+  return list_length(twohopneighs_list);
+}
+
+//----------------------------------------------------------------------
+void lmst_set_weight(struct neighbor * e, float weight)
+{
+  uint16_t qweight = (uint16_t)floor(weight * PRES_CONST / PRES_RANGE);
+
+  e->weight = weight;
+  //the edge to the node changed (see lmst_repair)
+  if (qweight != e->qweight){
+	  mark_changed(e->node_j);
+  }
+  e->qweight = qweight;
+}
+
+int lmst_add_neighbor(uint16_t self, uint16_t id, float weight, float x, float y)
+{
+  struct neighbor *e;
+
+  if (list_length(neighbor_list) >= MAX_NEIGHBORS){
+     return 0;
+  }
+  for(e = list_head(neighbor_list); e != NULL; e = list_item_next(e)) {
+    if(id ==  e->node_j) {
+     return 0;
+    }
+  }
+  if (id == self){
+	  return 0;
+  }
+//place in 1-hop neighbours list	
+  e = memb_alloc(&neighbor_memb);
+  if(e == NULL) {
+	return 0;
+  }
+  e->node_i = self;
+  e->node_j = id;
+  //set weight
+  lmst_set_weight(e, weight);
+  e->x = x;
+  e->y = y;
+  list_add(neighbor_list, e);
+  NOTE_PEAK(LMST_POOL_NEIGHBORS, neighbor_list);
+  mark_changed(id);
+  return 1;
+}
+
+//----------------------------------------------------------------------
+int lmst_add_twohop(uint16_t id, const uint8_t * tttmp, uint16_t len)
+{
+  struct twohopneighs *ee;
+  uint16_t ii, kk, ll, vall;
+
+  if (list_length(twohopneighs_list) >= MAX_NEIGHBORS){
+     return 0;
+  }
+  //2-hop neighbor
+  for (ee = list_head(twohopneighs_list); ee !=NULL; ee = list_item_next(ee)) {
+	  if (id == ee -> id) {
+		//shouldnt be in here...
+		return 0;
+	  }
+  }
+
+  //place in 2-hop neighbourhood
+  ee = memb_alloc(&twohopneighs_memb);
+  if (ee == NULL){
+	  return 0;
+  }
+  ll = len / 3; //3 BYTES per neighbour
+  ee->id = id;
+  ee->len = ll;
+
+  ee->nn = malloc(sizeof(uint16_t)*ll);
+  ee->w = malloc(sizeof(uint16_t)*ll);
+  for (ii=0;ii<ll;ii++){
+	  ee->nn[ii] =0;
+	  ee->w[ii] = 0;
+  }
+
+  ii = 0;
+  for (kk= 0; kk< ll*3;kk=kk+3)
+  {
+	ee->nn[ii] = tttmp[kk];
+	vall = tttmp[kk+1]<<8 | tttmp[kk+2];
+
+
+	ee->w[ii] = vall; //kept as received, the integer weight lmst_prim and lmst_repair compare
+	ii++;
+  }
+  list_add(twohopneighs_list, ee);
+  NOTE_PEAK(LMST_POOL_TWOHOPS, twohopneighs_list);
+  mark_changed(id);
+  return 1;
+}
+
+//----------------------------------------------------------------------
+//the 1-hop table of a neighbour, NULL if not known
+static struct twohopneighs * find_twohop(uint16_t id)
+{
+  struct twohopneighs *ee;
+
+  for (ee = list_head(twohopneighs_list); ee != NULL && ee->id != id; ee = list_item_next(ee));
+  return ee;
+}
+
+static void free_twohop(struct twohopneighs *ee)
+{
+  free(ee->nn);
+  free(ee->w);
+  remove_2hopneighbor(ee);
+}
+
+int lmst_update_twohop(uint16_t id, const uint8_t * tttmp, uint16_t len)
+{
+  struct twohopneighs *ee;
+  uint16_t ii, vall;
+
+  ee = find_twohop(id);
+  if (ee != NULL){
+	if (ee->len == len / 3){
+		for (ii = 0; ii < ee->len; ii++){
+			vall = tttmp[3*ii+1]<<8 | tttmp[3*ii+2];
+			if (ee->nn[ii] != tttmp[3*ii] || ee->w[ii] != vall){
+				break;
+			}
+		}
+		if (ii == ee->len){
+			return 0;
+		}
+	}
+	free_twohop(ee);
+  }
+  return lmst_add_twohop(id, tttmp, len);
+}
+
+int lmst_remove_neighbor(uint16_t id)
+{
+  struct neighbor *e;
+  struct twohopneighs *ee;
+
+  if ((ee = find_twohop(id)) != NULL){
+	free_twohop(ee);
+  }
+  for(e = list_head(neighbor_list); e != NULL; e = list_item_next(e)) {
+    if(id == e->node_j) {
+     remove_neighbor(e);
+     mark_changed(id);
+     return 1;
+    }
+  }
+  return 0;
+}
+
+#if LMST_XTC
+//the rank of a 1-hop neighbour: its weight as the 1-hop table carries it, then its id
+static uint32_t rank_key(struct neighbor *e)
+{
+  return (uint32_t)e->qweight << 8 | (e->node_j & 0xff);
+}
+
+//sorts the 1-hop neighbours by rank (insertion sort, the table is short)
+static void rank_neighbors(void)
+{
+  struct neighbor *sorted[MAX_NEIGHBORS], *e;
+  uint32_t keys[MAX_NEIGHBORS], key;
+  uint8_t n = 0, i;
+
+  while ((e = list_pop(neighbor_list)) != NULL){
+	  key = rank_key(e);
+	  for (i = n; i > 0 && keys[i-1] > key; i--){
+		  sorted[i] = sorted[i-1];
+		  keys[i] = keys[i-1];
+	  }
+	  sorted[i] = e;
+	  keys[i] = key;
+	  n++;
+  }
+  for (i = 0; i < n; i++){
+	  list_add(neighbor_list, sorted[i]);
+  }
+}
+#endif
+
+//----------------------------------------------------------------------
+uint16_t lmst_twohop_payload(uint8_t * msg1)
+{
+  struct neighbor * new;
+  uint16_t i = 0, val;
+
+#if LMST_XTC
+  //the table is the ranked list of the node (see lmst_xtc)
+  rank_neighbors();
+#endif
+  //format is: node id (1B) , weight (2B)
+  for(new = list_head(neighbor_list); new != NULL; new = list_item_next(new))
+  {
+	msg1[i++] =  new->node_j & 0xFF;
+	val = new->qweight;
+	msg1[i++] = val>>8;//msb
+	msg1[i++] = val & 0xFF;//lsb
+  }
+  return i;
+}
+
+//--------------------------LMST calculation--------------------------//
+//drops the 1-hop tables of nodes that are not neighbours, and the neighbours without a 1-hop table; returns 0, or a
+//negative error code
+static short prune_tables(void)
+{
+	struct neighbor *tmpn;
+	struct twohopneighs *tmpnn;
+	uint8_t found;
+
+   numofv = list_length(neighbor_list);
+
+  if (numofv > MAX_NEIGHBORS || list_length(twohopneighs_list) > MAX_NEIGHBORS){
+	  return -255;
+	  }
+
+ 	   //check if in 2-hop neighborhood there are unknown 1st hop neighs
+	   tmpnn = list_head(twohopneighs_list);
+	   while (tmpnn !=NULL){
+	
+		   found = 0;
+		   for (tmpn = list_head(neighbor_list); tmpn !=NULL; tmpn = list_item_next(tmpn)){
+
+				if (tmpnn->id == tmpn->node_j)
+				{
+					found=1;
+				}
+		   }
+	
+		   if (found ==0){
+			
+				if (remove_2hopneighbor(tmpnn)<0){
+					return -5;
+					}
+				tmpnn = list_item_next(tmpnn);
+			}
+		   else {
+			   	tmpnn = list_item_next(tmpnn);
+		   }
+	   }
+	      
+  
+	  tmpn = list_head(neighbor_list);
+	   while (tmpn !=NULL){
+		   found = 0;
+		   for (tmpnn = list_head(twohopneighs_list); tmpnn !=NULL; tmpnn = list_item_next(tmpnn)){
+				if (tmpnn->id == tmpn->node_j)
+				{
+					found=1;
+				}
+		   }
+		   if (found ==0){
+			   if (remove_neighbor(tmpn) <0){
+					return -6;
+					}
+					tmpn = list_item_next(tmpn);
+			}
+		   
+		   else {
+			   	tmpn = list_item_next(tmpn);
+			   }
+	   }
+	   return 0;
+}
+
+short lmst_initialize(uint16_t self)
+{
+	uint16_t ii,jj,kk,maxn;
+	struct neighbor *tmpn;
+	struct twohopneighs *tmpnn;
+	struct edge *tmpe;
+	uint8_t found;
+	short err;
+
+   /*the graph of a previous computation, if any*/
+   free_edges();
+   /*a full computation: the changes so far are in it*/
+   nchanged = 0;
+
+   if ((err = prune_tables()) != 0){
+	   return err;
+   }
+   numofv = list_length(neighbor_list);
+   maxn = list_length(twohopneighs_list);
+   
+//done with 1- and 2-hop checks.
+
+   if (numofv != maxn) {
+	   return -1;
+	   }
+
+//let's try to create the edges for 1- and 2-hop neighbours graph.
+
+  	tmpe = memb_alloc(&edge_memb);
+
+  	if (tmpe !=NULL){
+		tmpe->i_ind = 0;
+		tmpe->j_ind = malloc(sizeof(uint8_t)*(numofv+1));
+		if (tmpe->j_ind == NULL){
+			memb_free(&edge_memb, tmpe);
+			return -254;
+			}
+		tmpe->j_ind[0] = 0; //0x0 element
+		ii=1;
+		for (tmpnn = list_head(twohopneighs_list); tmpnn!=NULL && ii<numofv+1; tmpnn = list_item_next(tmpnn)){
+
+			tmpe->j_ind[ii] = 1;
+			ii++;
+		}
+
+		list_add(edge_list, tmpe);
+	}
+
+	else {
+	   return -2;
+		}
+    ii=1;
+	for(tmpn = list_head(neighbor_list); tmpn != NULL && ii<numofv+1; tmpn = list_item_next(tmpn))
+	{
+		tmpe = memb_alloc(&edge_memb);
+		if ( tmpe!= NULL) {
+
+
+		tmpe->i_ind = ii;
+		tmpe->j_ind = malloc(sizeof(uint8_t)*(numofv+1));
+		for (jj=0;jj<numofv+1;jj++){
+			tmpe->j_ind[jj] = 0;
+
+
+		}
+
+		tmpe->j_ind[0] = 1; // this is the current node index
+		kk=1;
+       for (tmpnn = list_head(twohopneighs_list); tmpnn != NULL && kk<numofv+1; tmpnn = list_item_next(tmpnn)){
+		    found = 2;
+		    
+			if (tmpn->node_j != tmpnn -> id){
+			 if (tmpnn->len > MAX_NEIGHBORS){
+				 free(tmpe->j_ind);
+				 memb_free(&edge_memb, tmpe);
+				 return -3;
+				 }	
+			 for (jj=0;jj<tmpnn->len;jj++){
+				 if (tmpnn->nn[jj] == tmpn->node_j) { //if your 1-st hop neighbour is also my 1-st hop neighbour.
+	       		   found = 0;
+					break;
+				 }
+				 
+			 }
+			 tmpe->j_ind[kk] = found ==0? 1:tmpe->j_ind[kk];
+		  }
+		  kk++;
+		}
+      list_add(edge_list, tmpe); //in list we add the 2-hop edges between 1-st hop neighs of the current node.
+      NOTE_PEAK(LMST_POOL_EDGES, edge_list);
+      
+      }
+      
+      else{
+	   return -4;
+		  }
+      ii++;
+     } 
+
+  return numofv;
+}
+
+static void tree_seed(uint16_t self);
+static uint8_t edge_weight(uint16_t self, uint8_t a, uint8_t b, uint16_t * w);
+static uint32_t edge_key(uint16_t w, uint8_t a, uint8_t b);
+
+//---------------------the PRIM algorithm-----------------------------//
+//the tree grows from the node by the lightest edge to it, with the weights of edge_weight in the order of edge_key, as
+//lmst_repair merges them: the two give the same local MST
+uint8_t lmst_prim(uint16_t self)
+{
+ uint8_t iv, ik, next;
+ uint16_t w;
+ uint32_t key;
+
+ struct neighbor * tmpneigh;
+
+ uint8_t ids[MAX_NEIGHBORS+1], visited[MAX_NEIGHBORS+1];
+ uint32_t keys[MAX_NEIGHBORS+1];
+
+ //every neighbour is reached first by its edge to the node
+ parent[0] = self & 0xff;
+ iv=1;
+ for (tmpneigh = list_head(neighbor_list); tmpneigh!=NULL && iv<numofv+1; tmpneigh= list_item_next(tmpneigh)){
+	ids[iv] = tmpneigh->node_j;
+	visited[iv] = 0;
+	parent[iv] = self & 0xff;
+	keys[iv] = edge_key(tmpneigh->qweight, self, tmpneigh->node_j);
+	iv++;
+ }
+ if (iv != numofv+1){
+	 return 1;
+ }
+
+ for (ik=1; ik<numofv+1; ik++){
+	//the neighbour closest to the tree...
+	next = 0;
+	for (iv=1; iv<numofv+1; iv++){
+		if (!visited[iv] && (next == 0 || keys[iv] < keys[next])){
+			next = iv;
+		}
+	}
+	visited[next] = 1;
+	//...and the edges it brings
+	for (iv=1; iv<numofv+1; iv++){
+		if (!visited[iv] && edge_weight(self, ids[next], ids[iv], &w) && (key = edge_key(w, ids[next], ids[iv])) < keys[iv]){
+			keys[iv] = key;
+			parent[iv] = ids[next];
+		}
+	}
+ }
+
+  linked = 0;
+  for (iv=1; iv<numofv+1; iv++){
+	  if (parent[iv] == (self & 0xff)){
+		  linked |= (uint32_t)1 << iv;
+	  }
+  }
+  tree_seed(self);
+  return 0;
+}
+
+//--------------------incremental update of the local MST--------------------//
+//the weight of the edge between two nodes of the neighbourhood, as lmst_prim and lmst_repair compare it: the node's own
+//for its edges, the lighter of the ones the 1-hop tables of both ends report for the others; returns 0 if there is none
+static uint8_t edge_weight(uint16_t self, uint8_t a, uint8_t b, uint16_t * w)
+{
+  struct neighbor *tmpn;
+  struct twohopneighs *tmpnn;
+  uint8_t i, found = 0;
+
+  if (b == (self & 0xff)){
+	  b = a;
+	  a = self;
+  }
+  if (a == (self & 0xff)){
+	  for (tmpn = list_head(neighbor_list); tmpn != NULL; tmpn = list_item_next(tmpn)){
+		  if (tmpn->node_j == b){
+			  *w = tmpn->qweight;
+			  return 1;
+		  }
+	  }
+	  return 0;
+  }
+  if ((tmpnn = find_twohop(a)) != NULL){
+	  for (i = 0; i < tmpnn->len; i++){
+		  if (tmpnn->nn[i] == b){
+			  *w = tmpnn->w[i];
+			  found = 1;
+			  break;
+		  }
+	  }
+  }
+  if ((tmpnn = find_twohop(b)) != NULL){
+	  for (i = 0; i < tmpnn->len; i++){
+		  if (tmpnn->nn[i] == a){
+			  if (!found || tmpnn->w[i] < *w){
+				  *w = tmpnn->w[i];
+			  }
+			  found = 1;
+			  break;
+		  }
+	  }
+  }
+  return found;
+}
+
+//a strict order of the edges: by weight, and then by the ids of their ends
+static uint32_t edge_key(uint16_t w, uint8_t a, uint8_t b)
+{
+  return (uint32_t)w << 16 | (uint16_t)(a > b ? a : b) << 8 | (a > b ? b : a);
+}
+
+//the tree lmst_prim computed, from parent
+static void tree_seed(uint16_t self)
+{
+  struct neighbor *tmpn;
+  uint8_t iv = 1;
+
+  ntree = 0;
+  tree_valid = 1;
+  for (tmpn = list_head(neighbor_list); tmpn != NULL && iv < numofv+1; tmpn = list_item_next(tmpn)){
+	  tree[ntree].a = tmpn->node_j;
+	  tree[ntree].b = parent[iv++];
+	  if (!edge_weight(self, tree[ntree].a, tree[ntree].b, &tree[ntree].w)){
+		  tree_valid = 0;
+	  }
+	  ntree++;
+  }
+}
+
+//the part of the tree that a node is in (union-find over the indices of ids, with path halving)
+static uint8_t part(uint8_t * parts, uint8_t i)
+{
+  while (parts[i] != i){
+	  parts[i] = parts[parts[i]];
+	  i = parts[i];
+  }
+  return i;
+}
+
+//the index of a node in ids, -1 if it is not there
+static int8_t node_index(const uint8_t * ids, uint8_t n, uint8_t id)
+{
+  int8_t i;
+
+  for (i = 0; i < n && ids[i] != id; i++);
+  return i < n ? i : -1;
+}
+
+//the index of a node in ids, from the indices of ids sorted by id (binary search); -1 if it is not there
+static int8_t sorted_index(const uint8_t * ids, const uint8_t * order, uint8_t n, uint8_t id)
+{
+  uint8_t lo = 0, hi = n, mid;
+
+  while (lo < hi){
+	  mid = (lo + hi) / 2;
+	  if (ids[order[mid]] < id){
+		  lo = mid + 1;
+	  }
+	  else {
+		  hi = mid;
+	  }
+  }
+  return lo < n && ids[order[lo]] == id ? (int8_t)order[lo] : -1;
+}
+
+static int by_key(const void * x, const void * y)
+{
+  const struct tree_edge *ex = x, *ey = y;
+  uint32_t kx = edge_key(ex->w, ex->a, ex->b), ky = edge_key(ey->w, ey->a, ey->b);
+
+  return kx < ky ? -1 : kx > ky;
+}
+
+short lmst_repair(uint16_t self)
+{
+  struct neighbor *tmpn;
+  struct twohopneighs *tmpnn;
+  struct tree_edge *cand;
+  uint8_t ids[MAX_NEIGHBORS+1], order[MAX_NEIGHBORS+1], parts[MAX_NEIGHBORS+1], touched[MAX_NEIGHBORS+1];
+  uint8_t n, i, j, k, done;
+  int8_t a, b;
+  uint16_t size, ncand, c;
+  uint32_t reached;
+  short err;
+
+  if (!tree_valid || nchanged > LMST_REPAIR_MAX){
+	  return LMST_REBUILD;
+  }
+  free_edges();
+  if ((err = prune_tables()) != 0 || list_length(neighbor_list) != list_length(twohopneighs_list)){
+	  return LMST_REBUILD;
+  }
+  numofv = list_length(neighbor_list);
+
+  //the nodes of the neighbourhood: the node itself, and its neighbours in list order (the indices of parent), and
+  //their indices sorted by id for the lookups (insertion sort, there are few)
+  n = 0;
+  ids[n++] = self;
+  for (tmpn = list_head(neighbor_list); tmpn != NULL; tmpn = list_item_next(tmpn)){
+	  ids[n++] = tmpn->node_j;
+  }
+  for (i = 0; i < n; i++){
+	  for (j = i; j > 0 && ids[order[j-1]] > ids[i]; j--){
+		  order[j] = order[j-1];
+	  }
+	  order[j] = i;
+	  touched[i] = is_changed(ids[i]);
+	  parts[i] = i;
+  }
+
+  //the edges of the tree between nodes that are still there and did not change keep their weights
+  for (i = 0, k = 0; i < ntree; i++){
+	  a = sorted_index(ids, order, n, tree[i].a);
+	  b = sorted_index(ids, order, n, tree[i].b);
+	  if (a >= 0 && b >= 0 && !touched[a] && !touched[b]){
+		  tree[k++] = tree[i];
+		  parts[part(parts, a)] = part(parts, b);
+	  }
+  }
+  ntree = k;
+
+  //the candidates, collected once: those edges, every edge of a node that changed or joined, and every edge between
+  //two parts of the kept ones; any other edge is the heaviest of a cycle of kept edges, and not in the new tree
+  size = ntree + n;
+  for (tmpnn = list_head(twohopneighs_list); tmpnn != NULL; tmpnn = list_item_next(tmpnn)){
+	  size += tmpnn->len;
+  }
+  if ((cand = malloc(size * sizeof(struct tree_edge))) == NULL){
+	  tree_valid = 0;
+	  return LMST_REBUILD;
+  }
+  memcpy(cand, tree, ntree * sizeof(struct tree_edge));
+  ncand = ntree;
+  i = 1;
+  for (tmpn = list_head(neighbor_list); tmpn != NULL; tmpn = list_item_next(tmpn), i++){
+	  if (touched[i] || part(parts, 0) != part(parts, i)){
+		  cand[ncand].a = self;
+		  cand[ncand].b = tmpn->node_j;
+		  cand[ncand++].w = tmpn->qweight;
+	  }
+  }
+  //the edges between neighbours as each end reports them: the lighter report comes first, the weight edge_weight gives
+  for (tmpnn = list_head(twohopneighs_list); tmpnn != NULL; tmpnn = list_item_next(tmpnn)){
+	  if ((a = sorted_index(ids, order, n, tmpnn->id)) <= 0){
+		  continue;
+	  }
+	  for (c = 0; c < tmpnn->len; c++){
+		  b = sorted_index(ids, order, n, tmpnn->nn[c]);
+		  if (b > 0 && b != a && (touched[a] || touched[b] || part(parts, a) != part(parts, b))){
+			  cand[ncand].a = ids[a];
+			  cand[ncand].b = ids[b];
+			  cand[ncand++].w = tmpnn->w[c];
+		  }
+	  }
+  }
+
+  //merged in the order of edge_key (Kruskal's algorithm), as lmst_prim takes them
+  qsort(cand, ncand, sizeof(struct tree_edge), by_key);
+  for (i = 0; i < n; i++){
+	  parts[i] = i;
+  }
+  ntree = 0;
+  for (c = 0; c < ncand && ntree < n - 1; c++){
+	  a = part(parts, sorted_index(ids, order, n, cand[c].a));
+	  b = part(parts, sorted_index(ids, order, n, cand[c].b));
+	  if (a != b){
+		  parts[a] = b;
+		  tree[ntree++] = cand[c];
+	  }
+  }
+  free(cand);
+  nchanged = 0;
+
+  if (ntree != n - 1){
+	  tree_valid = 0;
+	  return LMST_REBUILD;
+  }
+
+  //the parent of every neighbour, towards the node (any id may be one, 0 too: the nodes reached so far are a bitset)
+  parent[0] = self;
+  reached = 1;
+  linked = 0;
+  do {
+	  done = 1;
+	  for (k = 0; k < ntree; k++){
+		  i = sorted_index(ids, order, n, tree[k].a);
+		  j = sorted_index(ids, order, n, tree[k].b);
+		  if (!(reached & ((uint32_t)1 << i)) != !(reached & ((uint32_t)1 << j))){
+			  if (reached & ((uint32_t)1 << j)){
+				  parent[i] = ids[j];
+				  reached |= (uint32_t)1 << i;
+				  linked |= j == 0 ? (uint32_t)1 << i : 0;
+			  }
+			  else {
+				  parent[j] = ids[i];
+				  reached |= (uint32_t)1 << j;
+				  linked |= i == 0 ? (uint32_t)1 << j : 0;
+			  }
+			  done = 0;
+		  }
+	  }
+  } while (!done);
+  return numofv;
+}
+
+//--------------------k edge-disjoint local spanning forests--------------------//
+
+//the power level (3..31) that reaches the neighbours whose indices (from 1, as in parent) are in links
+static uint8_t links_power(uint32_t links)
+{
+  struct neighbor *tmpn;
+  uint8_t ii = 1, ll = 0;
+
+  for (tmpn = list_head(neighbor_list); tmpn != NULL; tmpn = list_item_next(tmpn), ii++){
+	  if ((links & ((uint32_t)1 << ii)) && power_level(tmpn->weight) > ll){
+		  ll = power_level(tmpn->weight);
+	  }
+  }
+  return ll < 3 ? 31 : ll;
+}
+
+uint8_t lmst_kforest(uint16_t self, uint8_t k, uint8_t * single)
+{
+  struct neighbor *tmpn;
+  struct twohopneighs *tmpnn;
+  struct edge *tmpe;
+  uint8_t ids[MAX_NEIGHBORS+1], from[MAX_NEIGHBORS+1], n, i, u, f, added;
+  int8_t cols[MAX_NEIGHBORS+1];
+  uint32_t adj[MAX_NEIGHBORS+1], best[MAX_NEIGHBORS+1], in, kept = 0, key;
+  uint16_t w;
+
+  //the nodes of the neighbourhood: the node itself, and its neighbours in list order (the indices of parent)
+  n = 0;
+  ids[n++] = self;
+  for (tmpn = list_head(neighbor_list); tmpn != NULL; tmpn = list_item_next(tmpn)){
+	  ids[n++] = tmpn->node_j;
+  }
+  if (n != numofv + 1 || list_length(edge_list) != n){
+	  return 1;
+  }
+
+  //the graph of lmst_initialize as bitsets of adjacent indices: the columns of its rows follow the 1-hop tables
+  cols[0] = 0;
+  i = 1;
+  for (tmpnn = list_head(twohopneighs_list); tmpnn != NULL && i < n; tmpnn = list_item_next(tmpnn)){
+	  cols[i++] = node_index(ids, n, tmpnn->id);
+  }
+  for (i = 0; i < n; i++){
+	  adj[i] = 0;
+  }
+  for (tmpe = list_head(edge_list); tmpe != NULL; tmpe = list_item_next(tmpe)){
+	  for (i = 0; i < n; i++){
+		  if (tmpe->j_ind[i] && cols[i] >= 0 && cols[i] != tmpe->i_ind && edge_weight(self, ids[tmpe->i_ind], ids[cols[i]], &w)){
+			  adj[tmpe->i_ind] |= (uint32_t)1 << cols[i];
+			  adj[cols[i]] |= (uint32_t)1 << tmpe->i_ind;
+		  }
+	  }
+  }
+
+  //every forest is the minimum spanning forest (Prim's algorithm from every part, in the order of edge_key) of the
+  //edges the ones before it left; the node's edges in any of them are its links
+  for (f = 0; f < k; f++){
+	  in = 0;
+	  added = 0;
+	  for (i = 0; i < n; i++){
+		  best[i] = 0xffffffff;
+	  }
+	  while (in != ((uint32_t)1 << n) - 1){
+		  //the node closest to the forest, or the first one of a new part
+		  u = n;
+		  for (i = 0; i < n; i++){
+			  if (!(in & ((uint32_t)1 << i)) && (u == n || best[i] < best[u])){
+				  u = i;
+			  }
+		  }
+		  in |= (uint32_t)1 << u;
+		  if (best[u] != 0xffffffff){
+			  adj[u] &= ~((uint32_t)1 << from[u]);
+			  adj[from[u]] &= ~((uint32_t)1 << u);
+			  if (u == 0 || from[u] == 0){
+				  kept |= (uint32_t)1 << (u + from[u]);
+			  }
+			  added = 1;
+		  }
+		  for (i = 0; i < n; i++){
+			  if (!(in & ((uint32_t)1 << i)) && (adj[u] & ((uint32_t)1 << i)) && edge_weight(self, ids[u], ids[i], &w)
+				  && (key = edge_key(w, ids[u], ids[i])) < best[i]){
+				  best[i] = key;
+				  from[i] = u;
+			  }
+		  }
+	  }
+	  if (f == 0){
+		  *single = links_power(kept);
+	  }
+	  //no edges left for another forest
+	  if (!added){
+		  break;
+	  }
+  }
+
+  linked = kept;
+  //no single local MST to repair
+  tree_valid = 0;
+  return 0;
+}
+
+#if LMST_XTC
+//--------------------------XTC calculation---------------------------//
+
+//the rank (from 1) of every node id among the 1-hop neighbours, 0 for the others
+static uint8_t rank_of[256];
+
+short lmst_xtc(uint16_t self)
+{
+  struct neighbor *tmpn;
+  struct twohopneighs *tmpnn;
+  uint8_t ids[MAX_NEIGHBORS];
+  uint32_t witnesses;
+  uint8_t ii, kk, r;
+
+  rank_neighbors();
+  numofv = 0;
+  linked = 0;
+  for (tmpn = list_head(neighbor_list); tmpn != NULL; tmpn = list_item_next(tmpn)){
+	  ids[numofv++] = tmpn->node_j;
+	  rank_of[tmpn->node_j & 0xff] = numofv;
+  }
+
+  //parent[ii] is the node for a kept neighbour (as for its neighbours in the local MST), or the best ranked witness
+  //that made it redundant
+  ii = 0;
+  for (tmpn = list_head(neighbor_list); tmpn != NULL; tmpn = list_item_next(tmpn)){
+	  //the neighbours that tmpn ranks above the node (all of its table if the node is not in it)...
+	  witnesses = 0;
+	  if ((tmpnn = find_twohop(tmpn->node_j)) != NULL){
+		  for (kk = 0; kk < tmpnn->len && tmpnn->nn[kk] != (self & 0xff); kk++){
+			  if ((r = rank_of[tmpnn->nn[kk] & 0xff]) > 0){
+				  witnesses |= (uint32_t)1 << (r - 1);
+			  }
+		  }
+	  }
+	  //...and the node ranks above tmpn
+	  witnesses &= ((uint32_t)1 << ii) - 1;
+	  for (r = 0; witnesses != 0 && !(witnesses & 1); r++, witnesses >>= 1);
+	  parent[++ii] = witnesses != 0 ? ids[r] : (self & 0xff);
+	  linked |= witnesses != 0 ? 0 : (uint32_t)1 << ii;
+  }
+
+  for (ii = 0; ii < numofv; ii++){
+	  rank_of[ids[ii]] = 0;
+  }
+  //no local MST to repair
+  tree_valid = 0;
+  return numofv;
+}
+#endif
+
+//--------------------transmission power selection--------------------//
+uint8_t lmst_power(uint16_t self, uint16_t * links)
+{
+  struct neighbor *tmpn;
+  uint16_t ii, maxn = 0;
+  uint8_t ll = 0;
+
+ if (numofv > 1){
+	 ii=1;
+  for (tmpn = list_head(neighbor_list); tmpn !=NULL && ii<numofv+1; tmpn=list_item_next(tmpn))
+  {
+	
+	if (linked & ((uint32_t)1 << ii)) {
+		ll = power_level(tmpn->weight) > ll ? power_level(tmpn->weight) : ll;
+		maxn++;
+	}
+	ii++;  
+  }
+ }
+ else {
+	 if (list_length(neighbor_list) == 1){
+		 maxn++;
+		 tmpn = list_head(neighbor_list);
+		 ll = power_level(tmpn->weight) > ll ? power_level(tmpn->weight) : ll;
+	}
+	else {
+		ll = 31;
+	 }
+ }
+
+ if (ll < 3){
+	 ll = 31;
+ }
+ *links = maxn;
+ return ll;
+}
+
+//----------------------------------------------------------------------
+uint16_t lmst_logical(uint16_t self, uint16_t * ids, uint8_t * levels)
+{
+  struct neighbor *tmpn;
+  uint16_t ii, n = 0;
+
+  if (numofv > 1){
+	ii=1;
+	for (tmpn = list_head(neighbor_list); tmpn !=NULL && ii<numofv+1; tmpn=list_item_next(tmpn)){
+		if (linked & ((uint32_t)1 << ii++)){
+			if (levels){
+				levels[n] = power_level(tmpn->weight);
+			}
+			ids[n++] = tmpn->node_j;
+		}
+	}
+  }
+  else if (list_length(neighbor_list) == 1){
+	tmpn = list_head(neighbor_list);
+	if (levels){
+		levels[n] = power_level(tmpn->weight);
+	}
+	ids[n++] = tmpn->node_j;
+  }
+  return n;
+}
+
+//----------------------------------------------------------------------
+void lmst_pools(uint8_t * used, uint8_t * most)
+{
+  used[LMST_POOL_NEIGHBORS] = list_length(neighbor_list);
+  used[LMST_POOL_TWOHOPS] = list_length(twohopneighs_list);
+  used[LMST_POOL_EDGES] = list_length(edge_list);
+  memcpy(most, peak, sizeof(peak));
+}
+
+//----------------------------------------------------------------------
+int lmst_memory(void)
+{
+  struct twohopneighs *tmpnn;
+  int mem;
+
+ //calc the memory peak..
+   mem = list_length(neighbor_list)*sizeof(struct neighbor) + list_length(twohopneighs_list)*sizeof(struct twohopneighs) + list_length(edge_list)*(sizeof(struct edge)) + (numofv+1)*sizeof(uint8_t);
+   
+   for (tmpnn = list_head(twohopneighs_list); tmpnn != NULL; tmpnn = list_item_next(tmpnn)){
+  	mem = mem + tmpnn->len*(sizeof(uint16_t) +sizeof(uint16_t));
+  }
+  return mem;
+}
@@ -0,0 +1,192 @@
+/*
+ * Copyright (c) 2015, Computer Science Department (CSD), University of Crete, and 
+ * Signal Processing Lab (SPL), Institute of Computer Science (ICS), FORTH, Greece.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of CSD, SPL/ICS-FORTH nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * 
+ */
+
+/**
+ * \file
+ *  The LMST computation of a node, out of its 1-hop and 2-hop neighbourhood: the local minimum spanning tree (Prim's algorithm)
+ *  and the transmission power that reaches the node's neighbours in it. Used by firmware.c, and by the host tools (tools/topoeval).
+ *
+ *  The module keeps the neighbour tables of one node (the node it runs on).
+ */
+
+#ifndef LMST_H_
+#define LMST_H_
+
+#include "contiki.h"
+#include "lib/list.h"
+#include "position.h"
+
+#define PRES_CONST 200000u // for conversion from float to int
+#define PRES_RANGE 1000u // likewise
+
+#define MAX_NEIGHBORS 20 //maximum number of neighbors
+
+/*the most nodes of the neighbourhood that may change (join, leave, move or send a new 1-hop table) between two
+  computations for lmst_repair to update the local MST of the last one; with more, it is computed again*/
+#ifdef LMST_CONF_REPAIR_MAX
+#define LMST_REPAIR_MAX LMST_CONF_REPAIR_MAX
+#else
+#define LMST_REPAIR_MAX 3
+#endif
+
+/*XTC mode: the logical neighbours are picked from the ranked 1-hop tables of the neighbours (lmst_xtc) instead of the local MST*/
+#ifdef LMST_CONF_XTC
+#define LMST_XTC LMST_CONF_XTC
+#else
+#define LMST_XTC 0
+#endif
+
+/*k-LMST: the logical neighbours are the node's links in k edge-disjoint local spanning forests (lmst_kforest) instead of
+  the local MST alone, so that k-1 failed links leave the neighbourhood connected; the shell command k changes it at run time*/
+#ifdef LMST_CONF_K
+#define LMST_K LMST_CONF_K
+#else
+#define LMST_K 1
+#endif
+
+/*returned by lmst_repair when the local MST has to be computed again (lmst_initialize and lmst_prim)*/
+#define LMST_REBUILD (-128)
+
+/*weight of the edge between two nodes: their squared distance*/
+#define LMST_WEIGHT(_x1, _y1, _x2, _y2) ((float)(((_y1) - (_y2)) * ((_y1) - (_y2)) + ((_x1) - (_x2)) * ((_x1) - (_x2))))
+
+/* This structure holds information about 1-hop neighbors. */
+struct neighbor {
+  /* The ->next pointer is needed since we are placing these on a
+     Contiki list. */
+  struct neighbor *next;
+
+  /*current node, 1-hop neighbour */
+  uint16_t node_i;
+  uint16_t node_j;
+  /*weight: distance*/
+  float weight;
+  /*the weight as the 1-hop tables carry it (weight*200), for the integer compares; set with the weight (lmst_set_weight)*/
+  uint16_t qweight;
+  /*position of the neighbour*/
+  float x, y;
+ };
+
+/*this structure holds information about 2-hop neighbors.*/
+
+struct twohopneighs {
+		struct twohopneighs *next;
+		uint16_t id;
+		uint16_t * nn;
+		/*the weights as the table carries them (weight*200)*/
+		uint16_t * w;
+		uint8_t len;
+};
+
+//EDGES for MST calculation
+struct edge {
+	struct edge *next;
+	uint8_t i_ind;
+	uint8_t * j_ind;
+};
+
+/*(re)initializes the neighbour tables, freeing what they hold*/
+void lmst_init(void);
+
+/*1-hop neighbours, in the order they were heard, and the 1-hop tables of the neighbours (2-hop)*/
+struct neighbor * lmst_neighbors(void);
+struct twohopneighs * lmst_twohops(void);
+int lmst_num_neighbors(void);
+int lmst_num_twohops(void);
+
+/*adds a 1-hop neighbour at (x, y); returns 0 if the table is full, it is known or it is the node itself*/
+int lmst_add_neighbor(uint16_t self, uint16_t id, float weight, float x, float y);
+
+/*sets the weight of a 1-hop neighbour, and its quantized value*/
+void lmst_set_weight(struct neighbor * e, float weight);
+
+/*adds the 1-hop table of a neighbour, as broadcasted (see lmst_twohop_payload); returns 0 if not added*/
+int lmst_add_twohop(uint16_t id, const uint8_t * data, uint16_t len);
+
+/*replaces the 1-hop table of a neighbour (or adds it); returns 1 if it changed, 0 otherwise*/
+int lmst_update_twohop(uint16_t id, const uint8_t * data, uint16_t len);
+
+/*removes a 1-hop neighbour and its 1-hop table; returns 0 if it is not known*/
+int lmst_remove_neighbor(uint16_t id);
+
+/*first byte of the 2-hop discovery beacon, before the 1-hop table: a table may start with any id, '$' and 'N' too*/
+#define LMST_TWOHOP_BEACON 'T'
+
+/*writes the 1-hop table of the node (3 bytes per neighbour: id, weight*200) into buf; returns its length. In XTC mode the
+  neighbours are ranked first, and the table lists them by rank*/
+uint16_t lmst_twohop_payload(uint8_t * buf);
+
+/*builds the graph of the 1-hop neighbours, replacing a previous one; returns their number, or a negative error code (printed as INITIALIZE)*/
+short lmst_initialize(uint16_t self);
+
+/*the local minimum spanning tree (Prim's algorithm), over the integer weights of the tables in a strict order of the
+  edges (by weight, then ids), as lmst_repair merges them; returns non zero on error*/
+uint8_t lmst_prim(uint16_t self);
+
+/*updates the local MST of the last computation (lmst_prim, or lmst_repair) to the changes of the neighbourhood since:
+  the edges of the nodes that changed or left are taken out of it, and the rest, every edge of a node that changed or
+  joined and every edge between the parts left are collected once and merged in the order lmst_prim uses (Kruskal's
+  algorithm, union-find), O(m log m) in the m edges of the neighbourhood. The result is the tree lmst_prim would
+  compute; returns the number of neighbours, or LMST_REBUILD after more than LMST_REPAIR_MAX changes*/
+short lmst_repair(uint16_t self);
+
+/*the k-LMST instead of lmst_prim, after lmst_initialize: the union of k edge-disjoint spanning forests of its graph, each
+  the minimum one (as lmst_repair orders the edges) of the edges the ones before it left, O(k d^2) table lookups in the
+  number of neighbours d. lmst_power and lmst_logical then report the node's links in any of them, and single is set to
+  the power level (3..31) of its links in the first one, the local MST, for the power the other k-1 cost; returns non
+  zero on error*/
+uint8_t lmst_kforest(uint16_t self, uint8_t k, uint8_t * single);
+
+/*XTC (R. Wattenhofer and A. Zollinger, "XTC: a practical topology control algorithm for ad-hoc networks", 2004) instead of
+  lmst_initialize and lmst_prim: the neighbours are ranked by weight, then id, as the 1-hop tables list them in XTC mode, and a
+  neighbour is dropped if a better ranked one is ranked above the node by the neighbour too. Bitsets of the ranks and integer
+  compares alone, O(d^2) in the number of neighbours d; a neighbour with no 1-hop table is kept. lmst_power and lmst_logical
+  then report the kept ones; returns the number of neighbours*/
+short lmst_xtc(uint16_t self);
+
+/*the transmission power (3..31) that reaches the node's neighbours in the local MST, and their number in links*/
+uint8_t lmst_power(uint16_t self, uint16_t * links);
+
+/*the node's neighbours in the local MST (after lmst_prim or lmst_repair, its links after lmst_kforest, or the kept ones after lmst_xtc), into ids (MAX_NEIGHBORS entries), and the power level
+  that reaches each of them into levels (unless 0); returns their number*/
+uint16_t lmst_logical(uint16_t self, uint16_t * ids, uint8_t * levels);
+
+/*memory pools of the tables, MAX_NEIGHBORS entries each*/
+enum { LMST_POOL_NEIGHBORS, LMST_POOL_TWOHOPS, LMST_POOL_EDGES, LMST_POOLS };
+
+/*entries of every pool in use now, and at most since lmst_init (LMST_POOLS each)*/
+void lmst_pools(uint8_t * used, uint8_t * most);
+
+/*memory held by the neighbour tables and the graph (bytes)*/
+int lmst_memory(void);
+
+#endif /* LMST_H_ */
@@ -44,6 +44,8 @@
 #define PROJECT_CONF_H_
 
 
-#define NETSTACK_CONF_RDC      nullrdc_driver
+/* duty-cycled radio; the discovery and verification beacons meet in the
+   rendezvous windows of common/rendezvous.h, the radio is off in between */
+#define NETSTACK_CONF_RDC      contikimac_driver
 
 #endif /* PROJECT_CONF_H_ */
@@ -7,7 +7,92 @@ mlog = new FileWriter(sim.getTitle() + ".mlog");
 /*Set speed to normal aka to 100%*/
 sim.setSpeedLimit(1.0);
 
-var motes = sim.getMotes(), i=0, finalmsg = new Array(), min, sec, mse;
+var motes = sim.getMotes(), i=0, finalmsg = new Array(), comments = new Array(), min, sec, mse, t, r;
+
+/*Telemetry frames (see common/telemetry.h): the text line of every event type, and the clock ticks per second of the motes*/
+var TELEMETRY = ["", "DELAUNAY", "INITIALIZE", "REDELCA", "POWER", "MEMORY", "NEIGHBOR", "NEIGHBOR: ERROR", "ENERGY_CPU", "ENERGY_TX", "ENERGY_RX", "DONE", "PROFILE", "ENERGY", "KLMST"];
+var PROFILE = 12, PHASES = ["DISCOVERY", "INITIALIZE", "PRIM", "DELAUNAY", "LEGALIZE", "NEIGHBORS", "PATH", "POWER", "REPAIR", "XTC", "CONE", "KFOREST"];
+var ENERGY = 13, SPANS = ["POSITION", "TWOHOP", "COMPUTE", "VERIFY"];
+var KLMST = 14;
+var CLOCK_SECOND = 128;
+
+/*CRC-16 of contiki lib/crc16*/
+function crc16_add(b, acc){
+	acc ^= b;
+	acc = ((acc >> 8) | (acc << 8)) & 0xffff;
+	acc = (acc ^ ((acc & 0xff00) << 4)) & 0xffff;
+	acc ^= (acc >> 8) >> 4;
+	acc ^= (acc & 0xff00) >> 5;
+	return acc;
+}
+
+/*Unsigned big-endian 32-bit value at b[j]*/
+function get32(b, j){
+	return ((b[j] * 256 + b[j+1]) * 256 + b[j+2]) * 256 + b[j+3];
+}
+
+/*Decodes a telemetry frame into the text line it stands for and the local time of the mote (us); null if it is not valid*/
+function decode(s){
+	var b = new Array(), j, c, n, v, crc = 0;
+
+	for(j=1; j<s.length; ++j){
+		c = s.charCodeAt(j) & 0xff;
+		if(c == 0x7d){
+			if(++j == s.length) return null;
+			c = (s.charCodeAt(j) & 0xff) ^ 0x20;
+		}
+		b.push(c);
+	}
+	if(b.length < 8 || b.length > 8+96) return null;
+	for(j=0; j<b.length-2; ++j) crc = crc16_add(b[j], crc);
+	if(b[b.length-2] != (crc >> 8) || b[b.length-1] != (crc & 0xff)) return null;
+	if(b[0] < 1 || b[0] >= TELEMETRY.length) return null;
+
+	n = b.length - 8;
+	if(b[0] == PROFILE){
+		/*PHASE count min max total, 11 bytes per phase*/
+		if(n % 11 != 0) return null;
+		v = "";
+		for(j=6; j<6+n; j+=11){
+			if(b[j] >= PHASES.length) return null;
+			v += " " + PHASES[b[j]] + " " + (b[j+1]*256 + b[j+2]) + " " + (b[j+3]*256 + b[j+4]) + " " + (b[j+5]*256 + b[j+6]) + " " + (((b[j+7]*256 + b[j+8])*256 + b[j+9])*256 + b[j+10]);
+		}
+		return {
+			text: TELEMETRY[b[0]] + v,
+			time: Math.floor((((b[2] * 256 + b[3]) * 256 + b[4]) * 256 + b[5]) * 1000000 / CLOCK_SECOND)
+		};
+	}
+	if(b[0] == ENERGY){
+		/*SPAN cpu lpm tx rx (4 bytes each) uJ (4 bytes), 21 bytes per span*/
+		if(n % 21 != 0) return null;
+		v = "";
+		for(j=6; j<6+n; j+=21){
+			if(b[j] >= SPANS.length) return null;
+			v += " " + SPANS[b[j]];
+			for(c=1; c<17; c+=4) v += " " + get32(b, j+c);
+			v += " " + (get32(b, j+17) / 1000).toFixed(3);
+		}
+		return {
+			text: TELEMETRY[b[0]] + v,
+			time: Math.floor((((b[2] * 256 + b[3]) * 256 + b[4]) * 256 + b[5]) * 1000000 / CLOCK_SECOND)
+		};
+	}
+	if(b[0] == KLMST){
+		/*k, power of the local MST, power of the k-LMST*/
+		if(n != 3) return null;
+		return {
+			text: TELEMETRY[b[0]] + " " + b[6] + " " + b[7] + " " + b[8],
+			time: Math.floor((((b[2] * 256 + b[3]) * 256 + b[4]) * 256 + b[5]) * 1000000 / CLOCK_SECOND)
+		};
+	}
+	if(n > 4) return null;
+	v = (n > 0 && (b[6] & 0x80)) ? -1 : 0;
+	for(j=0; j<n; ++j) v = v * 256 + b[6+j];
+	return {
+		text: TELEMETRY[b[0]] + (n > 0 ? " " + v : ""),
+		time: Math.floor((((b[2] * 256 + b[3]) * 256 + b[4]) * 256 + b[5]) * 1000000 / CLOCK_SECOND)
+	};
+}
 
 /*Wait for all the motes to start*/
 while(i < motes.length){
@@ -37,6 +122,22 @@ while(i < motes.length){
 	try{
 		/*Wait for a mote to print a message*/
 		YIELD();
+		t = time;
+
+		/*Telemetry frames are replaced by the text line they stand for, at the local time of the mote*/
+		if(String(msg).charAt(0) == "~"){
+			r = decode(String(msg));
+			if(r == null){
+				throw "Bad telemetry frame";
+			}
+			msg = new java.lang.String(r.text);
+			t = r.time;
+		}
+
+		/*Replies of the serial shell (common/shell.h) are not logged*/
+		if(msg.startsWith("> ")){
+			continue;
+		}
 
 		/*If a message is not in a specific format that means something went wrong!*/
 		if(!( msg.startsWith("DELAUNAY")||
@@ -49,7 +150,10 @@ while(i < motes.length){
 		   msg.startsWith("ENERGY_CPU") ||
 		   msg.startsWith("ENERGY_TX")	||
 		   msg.startsWith("ENERGY_RX")	||
-		   msg.startsWith("DONE")		)
+		   msg.startsWith("DONE")		||
+		   msg.startsWith("PROFILE")	||
+		   msg.startsWith("ENERGY ")	||
+		   msg.startsWith("KLMST")		)
 		){
 			throw "Something went terribly wrong - Execution failure";
 		}
@@ -66,6 +170,13 @@ while(i < motes.length){
 		continue;
 	}
 
+	/*The per-phase profile, the energy and the k-LMST power of a mote are written as comment lines after the log*/
+	if(msg.startsWith("PROFILE") || msg.startsWith("ENERGY ") || msg.startsWith("KLMST")){
+		var str = String(msg), k = str.indexOf(" ");
+		comments[id-1] = (comments[id-1] || "") + "#" + str.substring(0, k < 0 ? str.length : k) + " " + id + (k < 0 ? "" : str.substring(k)) + "\n";
+		continue;
+	}
+
 	/*Append the transmition power or the received neighbor to the motes log string*/
 	else if(msg.startsWith("NEIGHBOR") || msg.startsWith("MEMORY") || msg.startsWith("ENERGY_CPU") || msg.startsWith("ENERGY_TX") || msg.startsWith("ENERGY_RX")){
 		var str = msg.split(" ");
@@ -78,9 +189,9 @@ while(i < motes.length){
 	   } 
 	/*The messages starting with DELAUNAY, INITIALIZE and REDELCA are just loged with their times
 	 *Format the time at which the message was printed*/
-	min = Math.floor(time/60000000);
-	sec = Math.floor((time-min*60000000)/1000000);
-	mse = Math.floor((time-min*60000000-sec*1000000)/1000);
+	min = Math.floor(t/60000000);
+	sec = Math.floor((t-min*60000000)/1000000);
+	mse = Math.floor((t-min*60000000-sec*1000000)/1000);
 
 	/*Append the time to the motes log string*/
 	finalmsg[id-1] += ","+min+":"+(sec<10?"0":"")+sec+"."+(mse<10?"00":(mse<100?"0":""))+mse;
@@ -96,6 +207,9 @@ for(var j=0; j<finalmsg.length; ++j){
 	log.log(finalmsg[j]+"\n");
 	mlog.write(finalmsg[j]+"\n");
 }
+for(var j=0; j<comments.length; ++j){
+	if(comments[j]) mlog.write(comments[j]);
+}
 log.log("Simulation success\n");
 mlog.write("#Simulation success\n");
 mlog.close();
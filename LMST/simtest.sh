@@ -4,7 +4,7 @@ for f in deployments/; do
 		filename="${s##*/}";
 		filename=(${filename//./ });
 		printf "\t$filename: "
-		./simgen_rtx ${filename[0]} $s z1
+		../tools/simgen -a LMST -t z1 -i $s ${filename[0]}
 		ex=$?
 		if [[ $ex == 0 ]];
 			then
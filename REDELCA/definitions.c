@@ -44,6 +44,7 @@
 
 
 #include "definitions.h"
+#include "profile.h"
 #include <string.h>
 short int legalizeEdge(Point * p, Triangle * T){
 	short int ut, ua;
@@ -102,7 +103,7 @@ short int delaunay(){
 	float a, b;
 	short int len;
 
-	for(e=0, p=pHead; p; ++e, p=p->next){
+	for(i=0, e=0, p=pHead; p; ++e, p=p->next){
 		if(ABS(p->x) > ABS(p->y)){
 			i = ABS(p->x) > i ? ABS(p->x) : i;
 		}
@@ -165,10 +166,12 @@ short int delaunay(){
 		C->points[1] = A->points[NEXT(m)] == T->points[NEXT(e)] ? A->points[PREV(m)] : A->points[NEXT(m)];
 		T->points[e] = A->points[m] = B->points[2] = C->points[2] = point;
 
+		PROFILE_BEGIN(PROFILE_LEGALIZE);
 		if((i=legalizeEdge(point, T))<0) return i-510;
 		if((i=legalizeEdge(point, A))<0) return i-520;
 		if((i=legalizeEdge(point, B))<0) return i-530;
 		if((i=legalizeEdge(point, C))<0) return i-540;
+		PROFILE_END(PROFILE_LEGALIZE);
 
 		continue;
 
@@ -186,9 +189,11 @@ short int delaunay(){
 		B->points[1] = P0;
 		P2 = A2 = B->points[2] = point;
 
+		PROFILE_BEGIN(PROFILE_LEGALIZE);
 		if((i=legalizeEdge(point, T))<0) return i-610;
 		if((i=legalizeEdge(point, A))<0) return i-620;
 		if((i=legalizeEdge(point, B))<0) return i-630;
+		PROFILE_END(PROFILE_LEGALIZE);
 
 
 	}
@@ -261,20 +266,21 @@ short int delaunay(){
 
 	}
 
-	for(T=tHead, A=NULL; T; A=T, T=(A==NULL?T:T->next)){
+	/*Remove the triangles with external points (the new head of the list is checked too)*/
+	for(T=tHead, A=NULL; T; ){
 		for(i=0, e=0; i<3; e+=(T->points[i]->id<0?1:0), ++i);
-		if(e==0) continue;
-		if(!A){
+		if(e==0){
 			A=T;
 			T=T->next;
-			free(A);
-			A=NULL;
-			tHead=T;
+			continue;
+		}
+		if(!A){
+			tHead=T->next;
 		} else {
 			A->next = T->next;
-			free(T);
-			T=A;
 		}
+		free(T);
+		T = A ? A->next : tHead;
 	}
 
 	for(i=0; i<3; ++i){
@@ -355,19 +361,3 @@ short int swap(Triangle * a, Triangle * b){
 	b->points[b->points[NEXT(ub)] == a->points[PREV(ua)] ? NEXT(ub) : PREV(ub)] = a->points[ua];
 	return 1;
 }
-
-float str2float(char * str)
-{
-	float r, num;
-	char * s = strdup(str);
-	char * a =(char *) strtok(s, "."), b[3];
-	num = atoi(a);
-	r = num;
-	a = (char *) strtok(NULL, ".");
-	b[0] = a[0];
-	b[1] = a[1];
-	b[2] = a[2];
-	num = atoi(b);
-	r += (r<0 ? - (num / 1000) : (num / 1000));
-	return r;
-}
@@ -51,6 +51,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include "position.h"
 
 typedef struct _Triangle Triangle;
 typedef struct _Point Point;
@@ -114,7 +115,6 @@ Triangle * tHead;
 /*REDELCA specific declarations*/
 short int mem;
 void	addREDELCApoint(Point * p);
-float	str2float(char * str);
 
 #endif
 
@@ -53,26 +53,102 @@
 #include "dev/serial-line.h"
 #include "random.h"
 #include "definitions.h" //ALL DELAUNAY-related CALCULATIONS.
+#include "redelca.h"
+#include "telemetry.h"
+#include "profile.h"
+#include "energy.h"
+#include "power.h"
+#include "shell.h"
+#include "rendezvous.h"
+#include "txpower.h"
+#include "topology.h"
+#include "topocache.h"
+#include "linkest.h"
+#include "calibrate.h"
+#include "symmetric.h"
+#include "maintain.h"
+#include "ramp.h"
 
-#define TIMEFRAME 30
-
-//reference to the transmission power for cooja UDGM, using 15m as transmission range.
-static const
-float POWER [8] = {
-    {2.107}  ,
-    {11.472} ,
-    {28.330} ,
-    {52.680} ,
-    {84.520} ,
-    {123.850},
-    {170.680},
-    {225.000}
-};
+/*the quiet phase of the computation: REDELCA must fit in it*/
+#define COMPUTE_TIME (10*CLOCK_SECOND)
+
+#if REDELCA_RING_CHECK
+/*first byte of a ring beacon, followed by the Delaunay neighbours of the sender (one byte each)*/
+#define RING_BEACON 'D'
+/*length of the ring round (ticks)*/
+#ifdef REDELCA_CONF_RING_PHASE
+#define RING_PHASE REDELCA_CONF_RING_PHASE
+#else
+#define RING_PHASE (30*CLOCK_SECOND)
+#endif
+/*edges between Delaunay neighbours kept from the ring beacons*/
+#ifdef REDELCA_CONF_RING_SIZE
+#define RING_SIZE REDELCA_CONF_RING_SIZE
+#else
+#define RING_SIZE 48
+#endif
+#endif
 
 static Point * point;
-static char veri[256];
-static char buff [5];
 static uint8_t numofneighs;
+
+/*the computation: not started yet (or its points set again), in progress, done (it may then be run again from the shell)*/
+static enum { WAITING, COMPUTING, COMPUTED } state;
+/*its Delaunay neighbours and the transmission power it picked*/
+static short maxn;
+static uint8_t maxp;
+#if CALIBRATE_ENABLED
+/*in the calibration phases: beacons starting with CALIBRATE_BEACON and CALIBRATE_REPORT are the calibration's*/
+static uint8_t calibrating;
+#endif
+#if SYMMETRIC_MODE != SYMMETRIC_NONE
+/*in the confirmation phase: beacons starting with SYMMETRIC_BEACON are the confirmation's*/
+static uint8_t confirming;
+#endif
+#if REDELCA_RING_CHECK
+/*in the ring round: beacons starting with RING_BEACON are the round's; the round is over. The Delaunay neighbours
+  (before the filter), and the edges between them that their ends advertised in the round*/
+static uint8_t ringing, ringed;
+static short numdelaunay;
+static uint8_t ring[RING_SIZE][2];
+static uint8_t nring;
+#endif
+#if MAINTAIN_ENABLED
+/*in the maintenance: beacons starting with MAINTAIN_BEACON are the maintenance's; the neighbourhood changed since the
+  last computation*/
+static uint8_t maintaining, dirty;
+#endif
+#if REDELCA_RING_CHECK
+/*whether id is one of the Delaunay neighbours*/
+static short
+delaunay_neighbor(uint8_t id)
+{
+  short i;
+
+  for(i = 0; i < numdelaunay && pHead->neighbors[i]->id != id; ++i);
+  return i < numdelaunay;
+}
+
+/*a ring beacon is in the packet buffer: keeps the edges it advertises between Delaunay neighbours, once per sender*/
+static void
+ring_recv(uint8_t from)
+{
+  uint8_t * buf = packetbuf_dataptr();
+  uint16_t n, len = packetbuf_datalen();
+  uint8_t i;
+
+  for(i = 0; i < nring && ring[i][0] != from; ++i);
+  if(i < nring || !delaunay_neighbor(from)){
+    return;
+  }
+  for(n = 1; n < len && nring < RING_SIZE; ++n){
+    if(delaunay_neighbor(buf[n])){
+      ring[nring][0] = from;
+      ring[nring++][1] = buf[n];
+    }
+  }
+}
+#endif
 /*---------------------------------------------------------------------------*/
 PROCESS(b_thread, "Broadcast thread");
 PROCESS(r_thread, "REDELCA thread");
@@ -81,16 +157,72 @@ AUTOSTART_PROCESSES(&b_thread, &r_thread);
 static void
 broadcast_recv(struct broadcast_conn *c, const rimeaddr_t *from)
 {
-  char * msg = strdup((char *)packetbuf_dataptr()), * x, * y;
+  char * msg, * x, * y;
+
+  rendezvous_recv();
+#if CALIBRATE_ENABLED
+  if(calibrating && ((char *)packetbuf_dataptr())[0] == CALIBRATE_BEACON){
+    calibrate_heard(from->u8[0]);
+    return;
+  }
+  if(calibrating && ((char *)packetbuf_dataptr())[0] == CALIBRATE_REPORT){
+    calibrate_reported(from->u8[0]);
+    return;
+  }
+#endif
+#if SYMMETRIC_MODE != SYMMETRIC_NONE
+  if(confirming && ((char *)packetbuf_dataptr())[0] == SYMMETRIC_BEACON){
+    symmetric_recv(from->u8[0]);
+    return;
+  }
+#endif
+#if REDELCA_RING_CHECK
+  if(ringing && ((char *)packetbuf_dataptr())[0] == RING_BEACON){
+    ring_recv(from->u8[0]);
+    return;
+  }
+#endif
+#if MAINTAIN_ENABLED
+  /*A maintenance beacon: the neighbour is alive, a new or moved one is a change of the neighbourhood*/
+  if(maintaining && ((char *)packetbuf_dataptr())[0] == MAINTAIN_BEACON){
+#if LINKEST_WEIGHT == LINKEST_RSSI
+    linkest_sample(from->u8[0], (int16_t)packetbuf_attr(PACKETBUF_ATTR_RSSI) - 45);
+#endif
+    switch(maintain_heard(from->u8[0], packetbuf_dataptr(), packetbuf_datalen())){
+    case MAINTAIN_NEW:
+    case MAINTAIN_MOVED:
+      dirty = 1;
+      process_poll(&b_thread);
+    }
+    return;
+  }
+#endif
+  msg = strdup((char *)packetbuf_dataptr());
  
   if(msg[0] == 'N'){
-    printf("NEIGHBOR %d\n", from->u8[0]);
+    telemetry_value(TELEMETRY_NEIGHBOR, from->u8[0]);
     return;
   }
-  numofneighs++;
-  point = (Point *) malloc(sizeof(Point));
+#if LINKEST_WEIGHT == LINKEST_RSSI
+  /*Every beacon is a sample of the link; the point is added at the first one*/
+  if(!linkest_sample(from->u8[0], (int16_t)packetbuf_attr(PACKETBUF_ATTR_RSSI) - 45) || linkest_samples(from->u8[0]) > 1){
+    free(msg);
+    return;
+  }
+#endif
+  PROFILE_BEGIN(PROFILE_DISCOVERY);
   x = strtok(msg, "#");
   y = strtok(NULL, "#");
+#if RAMP_ENABLED
+  /*Ramped discovery: the points the node reaches, at their first beacon*/
+  if(!ramp_heard(from->u8[0], str2float(x), str2float(y))){
+    free(msg);
+    PROFILE_END(PROFILE_DISCOVERY);
+    return;
+  }
+#endif
+  numofneighs++;
+  point = (Point *) malloc(sizeof(Point));
   point->id = from->u8[0];
   point->x = str2float(x);
   point->y = str2float(y);
@@ -99,7 +231,12 @@ broadcast_recv(struct broadcast_conn *c, const rimeaddr_t *from)
   free(msg);
   //consider points for delaunay graph calculation.
   point->rssi = packetbuf_attr(PACKETBUF_ATTR_RSSI) - 45;
+#if MAINTAIN_ENABLED
+  /*The triangulation keeps the Delaunay neighbours only: the maintenance keeps every point*/
+  maintain_add(point->id, point->x, point->y);
+#endif
   addREDELCApoint(point);
+  PROFILE_END(PROFILE_DISCOVERY);
 }
 
 static const struct broadcast_callbacks broadcast_call = {broadcast_recv};
@@ -107,21 +244,319 @@ static struct broadcast_conn broadcast;
 
 static process_event_t redelca_start_event;
 static process_event_t redelca_finish_event;
+#if REDELCA_RING_CHECK
+static process_event_t redelca_ring_event;
+#endif
+
+/*the Delaunay neighbours (after redelca_neighbors) that the computed power maxp reaches directly into e, with their power
+  levels and positions; returns their number. The others are reached over a path of them, and are not links*/
+static short
+delaunay_entries(struct topocache_entry *e)
+{
+  Point * p;
+  short i, n;
+  uint8_t level;
+
+  for(i = 0, n = 0; i < maxn && n < TOPOCACHE_SIZE; ++i){
+    p = pHead->neighbors[i];
+    if((level = power_level(REDELCA_DISQR(p))) > maxp){
+      continue;
+    }
+    e[n].id = p->id;
+    e[n].level = level;
+    e[n].x = p->x;
+    e[n].y = p->y;
+    n++;
+  }
+  return n;
+}
+
+/*publishes the Delaunay neighbours to the routing layer, with their power levels for unicasts, and keeps them in flash*/
+static void
+publish_delaunay(void)
+{
+  struct topocache_entry e[TOPOCACHE_SIZE];
+  short n;
+
+  n = delaunay_entries(e);
+#if SYMMETRIC_MODE != SYMMETRIC_NONE
+  /*The symmetric links of the confirmation round, and the power that keeps them*/
+  n = symmetric_links(e, n, TOPOCACHE_SIZE);
+  maxp = symmetric_power(e, n, maxp);
+#endif
+  topocache_store(e, n, maxp);
+  topocache_apply();
+}
+
+/*the result of the computation: the Delaunay neighbours, the power and the memory of the triangulation*/
+static void
+report_delaunay(void)
+{
+  publish_delaunay();
+  telemetry_value(TELEMETRY_POWER, maxp);
+  telemetry_value(TELEMETRY_MEMORY, mem);
+}
+
+#if MAINTAIN_ENABLED
+/*the node and every neighbour the maintenance follows, as the points of a new computation (not a restart from the
+  Delaunay neighbours)*/
+static void
+maintenance_points(void)
+{
+  const struct maintain_neighbor *n;
+  float x = pHead->x, y = pHead->y;
+  uint8_t i;
+
+  redelca_init();
+  point = (Point *) malloc(sizeof(Point));
+  point->id = rimeaddr_node_addr.u8[0];
+  point->x = x;
+  point->y = y;
+  addREDELCApoint(point);
+  for(i = 0; i < maintain_count(); ++i){
+    n = maintain_entry(i);
+    point = (Point *) malloc(sizeof(Point));
+    point->id = n->id;
+    point->x = n->x;
+    point->y = n->y;
+#if LINKEST_WEIGHT == LINKEST_RSSI
+    point->rssi = linkest_rssi(n->id);
+#else
+    point->rssi = 0;
+#endif
+    addREDELCApoint(point);
+  }
+  state = WAITING;
+}
+#endif
+
+#if SYMMETRIC_MODE != SYMMETRIC_NONE
+/*the confirmation beacon: the Delaunay neighbours the computation picked*/
+static void
+confirmation_beacon(void)
+{
+  struct topocache_entry e[TOPOCACHE_SIZE];
+
+  symmetric_beacon(e, maxn > 0 ? delaunay_entries(e) : 0, pHead->x, pHead->y);
+}
+#endif
+
+#if REDELCA_RING_CHECK
+/*the ring beacon: the Delaunay neighbours the computation found*/
+static void
+ring_beacon(void)
+{
+  uint8_t * buf = packetbuf_dataptr();
+  short i;
+
+  buf[0] = RING_BEACON;
+  for(i = 0; i < numdelaunay; ++i){
+    buf[1 + i] = pHead->neighbors[i]->id;
+  }
+  packetbuf_set_datalen(1 + numdelaunay);
+}
+
+/*whether from advertised to as a Delaunay neighbour in the ring round*/
+static short
+ring_confirms(short from, short to)
+{
+  uint8_t i;
+
+  for(i = 0; i < nring; ++i){
+    if(ring[i][0] == from && ring[i][1] == to){
+      return 1;
+    }
+  }
+  return 0;
+}
+#endif
+
+#if LINKEST_WEIGHT == LINKEST_RSSI
+/*keeps the average RSSI of every point, for the power selection (see REDELCA_DISQR)*/
+static void
+average_rssi(void)
+{
+  Point * p;
+
+  for(p = pHead->next; p; p = p->next){
+    p->rssi = linkest_rssi(p->id);
+  }
+}
+#endif
+
+#if CALIBRATE_ENABLED
+/*the squared distance of a point, for the calibration; negative if unknown*/
+static float
+point_weight(uint16_t id)
+{
+  Point * p;
+
+  for(p = pHead->next; p; p = p->next){
+    if(p->id == id){
+      return REDELCA_DISQR(p);
+    }
+  }
+  return -1;
+}
+#endif
+
+/*SHELL COMMANDS---------------------------------------------------------------------------*/
+static void
+shell_nbr(char *args)
+{
+  Point * p;
+  float dis;
+  short i;
+
+  /*the points heard, or once computed the Delaunay neighbours*/
+  if(state == COMPUTED){
+    for(i = 0; i < maxn; ++i){
+      p = pHead->neighbors[i];
+      dis = DISQR(pHead, p);
+      SHELL_PRINTF("%d d2 %u level %u rssi %ld\n", p->id, (unsigned)dis, power_level(dis), (long)p->rssi);
+    }
+    SHELL_PRINTF("%d Delaunay neighbours\n", maxn);
+    return;
+  }
+  for(i = 0, p = pHead ? pHead->next : 0; p; p = p->next, ++i){
+    dis = DISQR(pHead, p);
+    SHELL_PRINTF("%d d2 %u level %u rssi %ld\n", p->id, (unsigned)dis, power_level(dis), (long)p->rssi);
+  }
+  SHELL_PRINTF("%d points\n", i);
+}
+
+static void
+shell_logical(char *args)
+{
+  uint8_t i;
+
+  if(state != COMPUTED){
+    SHELL_PRINTF("not computed yet\n");
+    return;
+  }
+  /*As published (made symmetric with SYMMETRIC_CONF_MODE)*/
+  printf(SHELL_PREFIX "%u:", topology_count());
+  for(i = 0; i < topology_count(); ++i){
+    printf(" %u", topology_neighbor(i));
+  }
+  printf("\n");
+}
+
+static void
+shell_power(char *args)
+{
+  SHELL_PRINTF("txpower %d, computed %u\n", cc2420_get_txpower(), state == COMPUTED ? maxp : 0);
+}
+
+static void
+shell_table(char *args)
+{
+  uint8_t i;
+
+  for(i = 0; i < POWER_LEVELS; ++i){
+    SHELL_PRINTF("level %u d2 %u\n", POWER_LEVEL(i), (unsigned)POWER[i]);
+  }
+}
+
+static void
+shell_txpower(char *args)
+{
+  uint16_t id;
+  uint8_t i, level;
+
+  for(i = 0; i < txpower_count(); ++i){
+    level = txpower_entry(i, &id);
+    SHELL_PRINTF("%u level %u\n", id, level);
+  }
+  SHELL_PRINTF("%u neighbours, others and broadcasts %u\n", txpower_count(), TXPOWER_MAX);
+}
+
+static void
+shell_cache(char *args)
+{
+  const struct topocache_entry *e;
+  uint8_t i;
+
+  if(!topocache_valid()){
+    SHELL_PRINTF("no cache\n");
+    return;
+  }
+  for(i = 0; i < topocache_count(); ++i){
+    e = topocache_entry(i);
+    SHELL_PRINTF("%u level %u at %d#%d\n", e->id, e->level, (int)e->x, (int)e->y);
+  }
+  SHELL_PRINTF("%u neighbours, power %u\n", topocache_count(), topocache_power());
+}
+
+static void
+shell_mem(char *args)
+{
+  /*mem counts the points until the triangulation, then it is the memory it took*/
+  if(state == COMPUTED){
+    SHELL_PRINTF("triangulation %d bytes\n", mem);
+  } else {
+    SHELL_PRINTF("points %d/%d\n", mem + (pHead != 0), MAXPOINTS);
+  }
+}
+
+static void
+shell_run(char *args)
+{
+  if(state != COMPUTED){
+    SHELL_PRINTF("busy\n");
+    return;
+  }
+  process_post(&r_thread, redelca_start_event, NULL);
+}
+
+static const struct shell_command shell_commands[] = {
+  { "nbr", "points heard (Delaunay neighbours once computed): id, d^2, power level, rssi", shell_nbr },
+  { "logical", "Delaunay neighbours", shell_logical },
+  { "power", "transmission power, now and as computed", shell_power },
+  { "table", "power table: level, squared distance it reaches", shell_table },
+  { "txpower", "unicast power level of each Delaunay neighbour", shell_txpower },
+  { "cache", "topology kept in flash: neighbours, level, position", shell_cache },
+  { "mem", "points (used/max) or memory of the triangulation", shell_mem },
+  { "run", "computes the topology again", shell_run },
+  { NULL, NULL, NULL }
+};
 
 /*MAIN THREAD------------------------------------------------------------------------------*/
 PROCESS_THREAD(b_thread, ev, data)
 {
-  static struct etimer send_timer, redelca_timer;
-  
-  static uint32_t start_energy_cpu, start_energy_rx, start_energy_tx;
-  static uint32_t end_energy_cpu, end_energy_rx, end_energy_tx;
   static char * msg, * my_x, * my_y, * position;
   
+#if !RAMP_ENABLED || CALIBRATE_ENABLED || MAINTAIN_ENABLED
+  static struct etimer timer;
+#endif
+  static uint8_t beacon;
+#if RAMP_ENABLED
+  static uint8_t level;
+#endif
+
   PROCESS_EXITHANDLER(broadcast_close(&broadcast);)
   PROCESS_BEGIN();
+  shell_init(shell_commands);
+  linkest_init();
+#if CALIBRATE_ENABLED
+  calibrate_init();
+#endif
+#if SYMMETRIC_MODE != SYMMETRIC_NONE
+  symmetric_init();
+#endif
+#if MAINTAIN_ENABLED
+  maintain_init();
+#endif
+  topology_init();
+  /*The topology of the last run, if any, until the computation confirms or replaces it*/
+  if(topocache_load() >= 0){
+    topocache_apply();
+  }
   broadcast_open(&broadcast, 129, &broadcast_call);
-  /*Wait for the position from Cooja script*/
-  PROCESS_YIELD_UNTIL(ev == serial_line_event_message);
+  /*Radio off until the position discovery*/
+  rendezvous_init();
+  /*Wait for the position (x#y) from Cooja script: the other lines are shell commands*/
+  PROCESS_YIELD_UNTIL(ev == serial_line_event_message && shell_position(data));
   /*Process position string and add to points*/
   msg = strdup((char*) data);
   position = strdup((char*) data);
@@ -133,257 +568,257 @@ PROCESS_THREAD(b_thread, ev, data)
   point->x = str2float(my_x);
   point->y = str2float(my_y);
   addREDELCApoint(point);
+  energy_begin(ENERGY_POSITION);
   free(my_x);
   free(my_y);
   free(msg);
-  /*Set timers redelca timer to 120s and broadcast timer*/
-  etimer_set(&redelca_timer,  120*CLOCK_SECOND);
-  etimer_set(&send_timer,     ((10 + rimeaddr_node_addr.u8[0] % TIMEFRAME) * CLOCK_SECOND));
- 
-  PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&send_timer));
-  /*Prepare broadcast buffer and broadcast message*/
   numofneighs = 0;
-  
-  packetbuf_clear();
-  packetbuf_clear_hdr();
-  packetbuf_copyfrom(position, strlen(position));
-  broadcast_send(&broadcast);
+#if RAMP_ENABLED
+  /*Position discovery, ramped: a phase per step of the power, the position is broadcasted in the node's slot at the
+    level of the phase until the points cover the node (see ramp.h)*/
+  ramp_init(pHead->x, pHead->y);
+  for(beacon = 0; beacon < RAMP_ROUNDS; ++beacon){
+    rendezvous_phase(RAMP_PHASE, rimeaddr_node_addr.u8[0] % RENDEZVOUS_SLOTS);
+    level = ramp_level(beacon);
+    PROCESS_WAIT_UNTIL(rendezvous_slot());
+    if(level > 0){
+      packetbuf_clear();
+      packetbuf_clear_hdr();
+      packetbuf_copyfrom(position, strlen(position));
+      packetbuf_set_attr(PACKETBUF_ATTR_RADIO_TXPOWER, level + 1);
+      rendezvous_send(&broadcast);
+    }
+    PROCESS_WAIT_UNTIL(rendezvous_ended());
+  }
+  free(position);
+  position = 0;
+#else
+  /*Position discovery: 120s, the position is broadcasted in the node's slot of the window*/
+  rendezvous_phase(120*CLOCK_SECOND, rimeaddr_node_addr.u8[0] % RENDEZVOUS_SLOTS);
+ 
+  PROCESS_WAIT_UNTIL(rendezvous_slot());
+  /*Prepare broadcast buffer and broadcast message, LINKEST_BEACONS times within the slot*/
+  for(beacon = 0; beacon < LINKEST_BEACONS; ++beacon){
+    if(beacon > 0){
+      etimer_set(&timer, RENDEZVOUS_SLOT / LINKEST_BEACONS);
+      PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&timer));
+    }
+    packetbuf_clear();
+    packetbuf_clear_hdr();
+    packetbuf_copyfrom(position, strlen(position));
+    rendezvous_send(&broadcast);
+  }
   free(position);
   position = 0;
   
-  PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&redelca_timer));
+  PROCESS_WAIT_UNTIL(rendezvous_ended());
+#endif
+#if LINKEST_WEIGHT == LINKEST_RSSI
+  average_rssi();
+#endif
+#if CALIBRATE_ENABLED
+  /*Calibration of the power table (part of the position discovery): beacons at every power level in the node's slot,
+    then the reports of the neighbours*/
+  calibrating = 1;
+  rendezvous_phase(CALIBRATE_PHASE, rimeaddr_node_addr.u8[0] % RENDEZVOUS_SLOTS);
+  PROCESS_WAIT_UNTIL(rendezvous_slot());
+  for(beacon = 0; beacon < CALIBRATE_FRAMES; ++beacon){
+    if(beacon > 0){
+      etimer_set(&timer, RENDEZVOUS_SLOT / CALIBRATE_FRAMES);
+      PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&timer));
+    }
+    packetbuf_clear();
+    calibrate_beacon(beacon);
+    rendezvous_send(&broadcast);
+  }
+  PROCESS_WAIT_UNTIL(rendezvous_ended());
+
+  rendezvous_phase(CALIBRATE_PHASE, rimeaddr_node_addr.u8[0] % RENDEZVOUS_SLOTS);
+  PROCESS_WAIT_UNTIL(rendezvous_slot());
+  packetbuf_clear();
+  calibrate_report();
+  rendezvous_send(&broadcast);
+  PROCESS_WAIT_UNTIL(rendezvous_ended());
+  calibrating = 0;
+  calibrate_fit(point_weight);
+#endif
+  energy_end(ENERGY_POSITION);
   
-  /*Switch control to REDELCA thread*/
-  start_energy_rx = energest_type_time(ENERGEST_TYPE_LISTEN);
-  start_energy_tx = energest_type_time(ENERGEST_TYPE_TRANSMIT);
-  start_energy_cpu = energest_type_time(ENERGEST_TYPE_CPU);
+  /*Switch control to REDELCA thread, in a quiet phase (radio off) that keeps the next window aligned*/
+  energy_begin(ENERGY_COMPUTE);
+  rendezvous_phase(COMPUTE_TIME, RENDEZVOUS_QUIET);
   process_post(&r_thread, redelca_start_event, NULL);
+#if REDELCA_RING_CHECK
+  /*Ring round, once the Delaunay neighbours are found, at full power: every node advertises them, then the power
+    selection goes on in a second quiet phase (the round's energy is counted in the verification span)*/
+  PROCESS_YIELD_UNTIL(ev == redelca_ring_event);
+  PROCESS_WAIT_UNTIL(rendezvous_ended());
+  energy_end(ENERGY_COMPUTE);
+  energy_begin(ENERGY_VERIFY);
+  ringing = 1;
+  rendezvous_phase(RING_PHASE, rimeaddr_node_addr.u8[0] % RENDEZVOUS_SLOTS);
+  PROCESS_WAIT_UNTIL(rendezvous_slot());
+  packetbuf_clear();
+  ring_beacon();
+  rendezvous_send(&broadcast);
+  PROCESS_WAIT_UNTIL(rendezvous_ended());
+  ringing = 0;
+  ringed = 1;
+  energy_end(ENERGY_VERIFY);
+  energy_begin(ENERGY_COMPUTE);
+  rendezvous_phase(COMPUTE_TIME, RENDEZVOUS_QUIET);
+  process_post(&r_thread, redelca_ring_event, NULL);
+#endif
   /*Wait for the control to switch from the REDELCA thread*/
   PROCESS_YIELD_UNTIL(ev == redelca_finish_event);
-  end_energy_cpu = energest_type_time(ENERGEST_TYPE_CPU);
-  /*Set timers redelca timer to 60s and broadcast timer*/
-  etimer_set(&redelca_timer,  7680);
-  etimer_set(&send_timer,     ((10 + rimeaddr_node_addr.u8[0] % TIMEFRAME) * CLOCK_SECOND));
-  //etimer_set(&send_timer,     ((random_rand() % TIMEFRAME) * CLOCK_SECOND));
-  PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&send_timer));
+  PROCESS_WAIT_UNTIL(rendezvous_ended());
+  energy_end(ENERGY_COMPUTE);
+  energy_begin(ENERGY_VERIFY);
+#if SYMMETRIC_MODE != SYMMETRIC_NONE
+  /*Confirmation round, at the computed power: the Delaunay neighbours each node picked; then the links are made
+    symmetric, the power adjusted to them, and the result published and reported (see symmetric.h)*/
+  if(maxn > 0){
+    cc2420_set_txpower(maxp);
+  }
+  confirming = 1;
+  rendezvous_phase(SYMMETRIC_PHASE, rimeaddr_node_addr.u8[0] % RENDEZVOUS_SLOTS);
+  PROCESS_WAIT_UNTIL(rendezvous_slot());
+  packetbuf_clear();
+  confirmation_beacon();
+  rendezvous_send(&broadcast);
+  PROCESS_WAIT_UNTIL(rendezvous_ended());
+  confirming = 0;
+  symmetric_end();
+  report_delaunay();
+#endif
+  /*The verification beacon goes at the computed power*/
+  if (maxn >0){
+    cc2420_set_txpower(maxp);
+  }
+  /*Verification: 60s*/
+  rendezvous_phase(7680, rimeaddr_node_addr.u8[0] % RENDEZVOUS_SLOTS);
+  PROCESS_WAIT_UNTIL(rendezvous_slot());
   /*Prepare broadcast buffer and broadcast message*/
   packetbuf_clear();
   position = strdup("N\0");
   packetbuf_attr_clear();
   packetbuf_copyfrom(position, strlen(position));
-  broadcast_send(&broadcast);
+  rendezvous_send(&broadcast);
   free(position);
-  PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&redelca_timer));
+  PROCESS_WAIT_UNTIL(rendezvous_ended());
   
-  //calculate the timings per component (to use for power consumption).
-  end_energy_rx = energest_type_time(ENERGEST_TYPE_LISTEN);
-  end_energy_tx = energest_type_time(ENERGEST_TYPE_TRANSMIT);
+  energy_end(ENERGY_VERIFY);
   
-  printf("ENERGY_CPU %lu\n", end_energy_cpu-start_energy_cpu);
-  printf("ENERGY_TX %lu\n", end_energy_tx-start_energy_tx);
-  printf("ENERGY_RX %lu\n", end_energy_rx-start_energy_rx);
-  printf("DONE\n");
+  //CPU of the computation, radio from the computation to the end (to use for power consumption).
+  telemetry_value(TELEMETRY_ENERGY_CPU, energy_ticks(ENERGY_COMPUTE, ENERGY_CPU));
+  telemetry_value(TELEMETRY_ENERGY_TX, energy_ticks(ENERGY_COMPUTE, ENERGY_TX) + energy_ticks(ENERGY_VERIFY, ENERGY_TX));
+  telemetry_value(TELEMETRY_ENERGY_RX, energy_ticks(ENERGY_COMPUTE, ENERGY_RX) + energy_ticks(ENERGY_VERIFY, ENERGY_RX));
+  energy_report();
+  PROFILE_REPORT();
+  telemetry_event(TELEMETRY_DONE);
+  /*The radio is the application's again, duty-cycled: broadcasts at full power, unicasts at the level of their
+    receiver (see txpower.h)*/
+  cc2420_set_txpower(TXPOWER_MAX);
+  rendezvous_stop();
+#if MAINTAIN_ENABLED
+  /*Maintenance (see maintain.h): a beacon per Trickle interval; a change of the neighbourhood, heard or a neighbour
+    expired, ends the interval, and the node computes again and starts over from the shortest one*/
+  maintain_start();
+  maintaining = 1;
+  while(1){
+    etimer_set(&timer, maintain_send_time());
+    PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&timer) || (dirty && maintain_interval() > MAINTAIN_IMIN));
+    if(etimer_expired(&timer)){
+      packetbuf_clear();
+      packetbuf_set_datalen(maintain_beacon(packetbuf_dataptr(), pHead->x, pHead->y));
+      rendezvous_send(&broadcast);
+      etimer_set(&timer, maintain_interval() - maintain_send_time());
+      PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&timer) || (dirty && maintain_interval() > MAINTAIN_IMIN));
+    }
+    if(maintain_expire(NULL) > 0){
+      dirty = 1;
+    }
+    if(dirty){
+      dirty = 0;
+      maintenance_points();
+      process_post(&r_thread, redelca_start_event, NULL);
+      PROCESS_YIELD_UNTIL(ev == redelca_finish_event);
+      maintain_reset();
+    } else {
+      maintain_double();
+    }
+  }
+#endif
   PROCESS_END();
 }
 
 /*REDELCA THREAD---------------------------------------------------------------------------*/
 PROCESS_THREAD(r_thread, ev, data)
 {
-  static struct etimer et;
-  static Triangle * T;
-  static Point * p1;
-  static short i, j, k, maxn, l;
-  static float a, b, dis;
-  static uint16_t maxp;
+  static short i;
   PROCESS_BEGIN();
-  /*Wait until the control switches from the main thread*/
-  PROCESS_YIELD_UNTIL(ev == redelca_start_event);
-  
-  printf("DELAUNAY\n");
-  /*Triangulize received points*/
-  i = delaunay();
-  i = (i== -100) ? 2:i;
-   
-  printf("INITIALIZE %d\n", i-1);
-
-  for(maxn=0, T=tHead; T; maxn+=IN_TRIA(T, pHead)?1:0, T=T->next)
-        T->points[0]->neighbors = T->points[1]->neighbors = T->points[2]->neighbors = 0;
-  maxn++;
-  pHead->neighbors = (Point**) malloc(maxn * sizeof(Point*));
-
-  for(j=0, T=tHead; T; T=tHead){
-    /*Find pHead in triangle*/
-    for(i=0; i<3 && T->points[i] != pHead; ++i);
-    /*If pHead not in triangle just free the triangle*/
-    if(i==3 || T->points[0]->id<0 || T->points[1]->id<0 || T->points[2]->id<0) goto freeTriangle;
-    /*Find NEXT in pHeads' neighbors*/
-    if(T->points[NEXT(i)]->neighbors){
-      /*NEXT is a neighbor, add PREV as its neighbor*/
-      T->points[NEXT(i)]->neighbors[1] = T->points[PREV(i)];
+  /*The first computation is started by the main thread, later ones by the shell (run)*/
+  while(1){
+    /*Wait until the control switches from the main thread*/
+    PROCESS_YIELD_UNTIL(ev == redelca_start_event);
+    if(state == COMPUTED){
+      redelca_restart();
     }
-    else {
-      /*NEXT is not a neighbor, remove from points list, add to neighbors list, initialize its neighbors list*/
-      for(p1=pHead; p1 && p1->next!=T->points[NEXT(i)]; p1=p1->next);
-      p1->next = p1->next->next;
-      pHead->neighbors[j++] = T->points[NEXT(i)];
-      T->points[NEXT(i)]->neighbors = (Point **) malloc(2 * sizeof(Point*));
-      T->points[NEXT(i)]->neighbors[0] = T->points[PREV(i)];
-      T->points[NEXT(i)]->neighbors[1] = 0;
-    }
-    /*Find PREV in pHeads' neighbors*/
-    if(T->points[PREV(i)]->neighbors){
-      /*NEXT is a neighbor, add PREV as its neighbor*/
-      T->points[PREV(i)]->neighbors[1] = T->points[NEXT(i)];
-    }
-    else {
-      /*NEXT is not a neighbor, remove from points list, add to neighbors list, initialize its neighbors list*/
-      for(p1=pHead; p1 && p1->next!=T->points[PREV(i)]; p1=p1->next);
-      p1->next = p1->next->next;
-      pHead->neighbors[j++] = T->points[PREV(i)];
-      T->points[PREV(i)]->neighbors = (Point **) malloc(2 * sizeof(Point*));
-      T->points[PREV(i)]->neighbors[0] = T->points[NEXT(i)];
-      T->points[PREV(i)]->neighbors[1] = 0;
-    }
-    /*Free the triangle from memory*/
-    freeTriangle:
-    tHead=tHead->next;
-    free(T);
-  }
-  /*Free unused points*/
-  for(p1=pHead->next; p1; p1=pHead->next){
-    pHead->next=p1->next;
-    free(p1);
-  }
-  pHead->next = 0;
-  pHead->p = 0;
-  /*Adjust neighbors number*/
-  maxn=j;
+    state = COMPUTING;
   
-  printf("REDELCA %d\n", maxn);
-  maxp = 31;
-    if (maxn >0){
-  maxp = 0;
-
-  for(i=0; i<maxn; ++i){
-	  
-
-    /*Initialize neighbors values*/
-    for(k=0; k<maxn; ++k){
-      dis = DISQR(pHead, pHead->neighbors[k]);
-      a = POWER[7] - dis;
-      j = 7;
-      for (l=0;l<7;l++){
-		  b = POWER[l]-dis;
-		 j = (b >0 && a > b) ? l:j;
-		 a = (b >0 && a > b) ? b:a;  
-		  }
+    telemetry_event(TELEMETRY_DELAUNAY);
+    /*Triangulize received points*/
+    PROFILE_BEGIN(PROFILE_DELAUNAY);
+    i = redelca_triangulate();
+    PROFILE_END(PROFILE_DELAUNAY);
    
-      pHead->neighbors[k]->p = 3 + j * 4;
-      pHead->neighbors[k]->next = 0;
-    }
-    /*Find least power expensive neighbor*/
-    for(j=0, k=1; k<maxn && pHead->neighbors[j] != pHead->neighbors[i]; j = (pHead->neighbors[j]->p > pHead->neighbors[k]->p ? k : j), k++);
-
-    p1 = pHead->neighbors[j]->p == pHead->neighbors[i]->p ? pHead->neighbors[i] : pHead->neighbors[j];
-    p1->next = pHead;
-
-    /*Until i-th neighbor is not found keep searching*/
-    while(p1->id != pHead->neighbors[i]->id){
-      /*If neighbor 0 of p1 exists and hasnt yet been visited estimate transmition power else set power to 500 (just a big value)*/
-      if(p1->neighbors[0] && !p1->neighbors[0]->next){
-        dis = DISQR(p1, p1->neighbors[0]);
-    
-        a = POWER[7] - dis;
-      j = 7;
-      for (l=0;l<7;l++){
-		  b = POWER[l]-dis;
-		 j = (b >0 && a > b) ? l:j;
-		 a = (b >0 && a > b) ? b:a;  
-		  }
-        j = 3 + j * 4;
-      } else {j=500;}
-      /*If neighbor 1 of p1 exists and hasnt yet been visited estimate transmition power else set power to 500 (just a big value)*/
-      if(p1->neighbors[1] && !p1->neighbors[1]->next){
-        dis = DISQR(p1, p1->neighbors[1]);
-      
-        a = POWER[7] - dis;
-      k = 7;
-      for (l=0;l<7;l++){
-		  b = POWER[l]-dis;
-		 k = (b >0 && a > b) ? l:k;
-		 a = (b >0 && a > b) ? b:a;  
-		  }
-        k = 3 + k * 4;
-      } else {k=500;}
-      
-      /*Well this is the case where the shortest path leads to nowhere!*/
-      if(j==500 && k==500 && !pHead->next){
-		 //  printf("NEIGHBOR: **%d\n", pHead->neighbors[i]->id);
-        break;
-      }
-      /*This is a case where the path somewhere has taken a wrong turn, this is the correcting action*/
-      if(j==500 && k==500) {
-        p1 = pHead->next;
-        pHead->next = 0;
-        dis = DISQR(p1, p1->neighbors[0]);
-       
-        a = POWER[7] - dis;
-      j = 7;
-      for (l=0;l<7;l++){
-		  b = POWER[l]-dis;
-		 j = (b >0 && a > b) ? l:j;
-		 a = (b >0 && a > b) ? b:a;  
-		  }
-        p1->neighbors[0]->p = 3 + j * 4;
-        p1->neighbors[0]->next = p1;
-        p1 = p1->neighbors[0];
-        continue;
-      }
-      /*There is a chance the proper neighbor isnt selected, this is done to continue from here*/
-      if(j == k){pHead->next = p1;}
-      /*Set future p1's next to current p1 power needed to reach p1*/
-      p1->neighbors[(j<k ? 0 : 1)]->next = p1;
-      p1->neighbors[(j<k ? 0 : 1)]->p = j<k ? j : k;
-
-      /*Continue to the least power expensive neighbor*/
-      p1 = p1->neighbors[(j<k ? 0 : 1)];
-    }
-    pHead->next = 0;
-    if(j==500 && k==500){
-      //printf("neighbor not found in shortest path!\n");
-      //  printf("NEIGHBOR: ****%d\n", pHead->neighbors[i]->id);
-    }
-    else {
-      j=0;
-      while(p1){
-       j += p1->p;
-       p1 = p1->next;
-      }
+    telemetry_value(TELEMETRY_INITIALIZE, i-1);
+
+    /*Keep the Delaunay neighbours*/
+    PROFILE_BEGIN(PROFILE_NEIGHBORS);
+    maxn = redelca_neighbors();
+#if REDELCA_UNIT
+    /*In range, and their edges in range*/
+    maxn = redelca_unit(maxn);
+#endif
+#if REDELCA_RING_CHECK
+    numdelaunay = maxn;
+#endif
+#if REDELCA_FILTER != REDELCA_FILTER_NONE
+    /*Of which the Gabriel or relative neighbourhood graph ones*/
+    maxn = redelca_filter(maxn);
+#endif
+    PROFILE_END(PROFILE_NEIGHBORS);
+  
+    telemetry_value(TELEMETRY_REDELCA, maxn);
+#if REDELCA_RING_CHECK
+    /*The first computation waits for the ring round (main thread); later ones check against the edges advertised in it,
+      so that the edges of a newer neighbour are dropped*/
+    if(!ringed){
+      process_post(&b_thread, redelca_ring_event, NULL);
+      PROCESS_YIELD_UNTIL(ev == redelca_ring_event);
     }
-    dis = DISQR(pHead, pHead->neighbors[i]);
- 
-    a = POWER[7] - dis;
-      k = 7;
-      for (l=0;l<7;l++){
-		  b = POWER[l]-dis;
-		 k = (b >0 && a > b) ? l:k;
-		 a = (b >0 && a > b) ? b:a;  
-		  }
-    
-    k = 3 + k * 4;
+    /*The ring edges the neighbours do not both have*/
+    redelca_confirm(maxn, ring_confirms);
+#endif
+    /*Select the transmission power*/
+    PROFILE_BEGIN(PROFILE_POWER);
+#if REDELCA_FILTER != REDELCA_FILTER_NONE
+    /*No path search: the filtered neighbours are reached directly*/
+    maxp = redelca_reach(maxn);
+#else
+    maxp = redelca_power(maxn);
+#endif
+    PROFILE_END(PROFILE_POWER);
+    /*The Delaunay neighbours, to the routing layer and with their power levels for unicasts*/
+#if SYMMETRIC_MODE != SYMMETRIC_NONE
+    /*The first computation is published and reported after the confirmation round (main thread)*/
+    if(symmetric_confirmed())
+#endif
+    report_delaunay();
   
-    /*Select the optimal transimtion power for i-th neighbor*/
-    k = k<j?k:j;
-    maxp = maxp>k ? maxp : k;
+    state = COMPUTED;
+    process_post(&b_thread, redelca_finish_event, NULL);
   }
-	if (maxp >0){
-		cc2420_set_txpower(maxp);
-	}
-	else {maxp = 31;} 
-  }
-  printf("POWER %d\n", maxp);
-  printf("MEMORY %d\n", mem);
-  
-  process_post(&b_thread, redelca_finish_event, NULL);
   PROCESS_END();
 }
@@ -0,0 +1,382 @@
+ /* Copyright (c) 2015, Computer Science Department (CSD), University of Crete, and 
+ * Signal Processing Lab (SPL), Institute of Computer Science (ICS), FORTH, Greece.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of CSD, SPL/ICS-FORTH nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+ /**
+  * \file
+ * The REDELCA computation of a node, out of the points (positions) of its neighbours: Delaunay triangulation,
+ * Delaunay neighbours of the node, and the least transmission power that reaches each of them directly or over
+ * a path of Delaunay neighbours. Used by firmware.c, and by the host tools (tools/topoeval).
+ *
+ * \author
+ * Phivos Phivou, Computer Science Department, University of Crete.
+ *
+ * email: fivou@csd.uoc.gr, apanouso@ics.forth.gr
+ *
+ *
+ * This code has been writted for contiki-2.7 distribution.
+*/
+
+#include "redelca.h"
+#include "power.h"
+#include "profile.h"
+
+/*the Delaunay neighbours of pHead, kept for redelca_init*/
+static Point ** neighbors;
+static short numofneighs;
+
+/*---------------------------------------------------------------------------*/
+void redelca_init(void)
+{
+  Triangle * T;
+  Point * p1;
+  short k;
+
+  /*free what a previous computation left*/
+  while(tHead){
+    T = tHead;
+    tHead = tHead->next;
+    free(T);
+  }
+  if(neighbors){
+    for(k=0; k<numofneighs; ++k){
+      free(neighbors[k]->neighbors);
+      free(neighbors[k]);
+    }
+    free(neighbors);
+    neighbors = 0;
+  }
+  while(pHead){
+    p1 = pHead;
+    pHead = pHead->next;
+    free(p1);
+  }
+  numofneighs = 0;
+  mem = 0;
+}
+/*---------------------------------------------------------------------------*/
+void redelca_restart(void)
+{
+  Point * self = pHead, * p1;
+  short k;
+
+  if(!self || !neighbors){
+    return;
+  }
+  /*the Delaunay neighbours become the points again, the node first*/
+  pHead = 0;
+  mem = 0;
+  addREDELCApoint(self);
+  for(k=0; k<numofneighs; ++k){
+    p1 = neighbors[k];
+    free(p1->neighbors);
+    p1->neighbors = 0;
+    p1->next = 0;
+    p1->p = 0;
+    addREDELCApoint(p1);
+  }
+  free(neighbors);
+  self->neighbors = neighbors = 0;
+  numofneighs = 0;
+}
+/*---------------------------------------------------------------------------*/
+short redelca_triangulate(void)
+{
+  short i;
+
+  /*Triangulize received points*/
+  i = delaunay();
+  i = (i== -100) ? 2:i;
+  return i;
+}
+/*---------------------------------------------------------------------------*/
+short redelca_neighbors(void)
+{
+  Triangle * T;
+  Point * p1;
+  short i, j, maxn;
+
+  for(maxn=0, T=tHead; T; maxn+=IN_TRIA(T, pHead)?1:0, T=T->next)
+        T->points[0]->neighbors = T->points[1]->neighbors = T->points[2]->neighbors = 0;
+  maxn++;
+  neighbors = pHead->neighbors = (Point**) malloc(maxn * sizeof(Point*));
+
+  for(j=0, T=tHead; T; T=tHead){
+    /*Find pHead in triangle*/
+    for(i=0; i<3 && T->points[i] != pHead; ++i);
+    /*If pHead not in triangle just free the triangle*/
+    if(i==3 || T->points[0]->id<0 || T->points[1]->id<0 || T->points[2]->id<0) goto freeTriangle;
+    /*Find NEXT in pHeads' neighbors*/
+    if(T->points[NEXT(i)]->neighbors){
+      /*NEXT is a neighbor, add PREV as its neighbor*/
+      T->points[NEXT(i)]->neighbors[1] = T->points[PREV(i)];
+    }
+    else {
+      /*NEXT is not a neighbor, remove from points list, add to neighbors list, initialize its neighbors list*/
+      for(p1=pHead; p1 && p1->next!=T->points[NEXT(i)]; p1=p1->next);
+      p1->next = p1->next->next;
+      pHead->neighbors[j++] = T->points[NEXT(i)];
+      T->points[NEXT(i)]->neighbors = (Point **) malloc(2 * sizeof(Point*));
+      T->points[NEXT(i)]->neighbors[0] = T->points[PREV(i)];
+      T->points[NEXT(i)]->neighbors[1] = 0;
+    }
+    /*Find PREV in pHeads' neighbors*/
+    if(T->points[PREV(i)]->neighbors){
+      /*NEXT is a neighbor, add PREV as its neighbor*/
+      T->points[PREV(i)]->neighbors[1] = T->points[NEXT(i)];
+    }
+    else {
+      /*NEXT is not a neighbor, remove from points list, add to neighbors list, initialize its neighbors list*/
+      for(p1=pHead; p1 && p1->next!=T->points[PREV(i)]; p1=p1->next);
+      p1->next = p1->next->next;
+      pHead->neighbors[j++] = T->points[PREV(i)];
+      T->points[PREV(i)]->neighbors = (Point **) malloc(2 * sizeof(Point*));
+      T->points[PREV(i)]->neighbors[0] = T->points[NEXT(i)];
+      T->points[PREV(i)]->neighbors[1] = 0;
+    }
+    /*Free the triangle from memory*/
+    freeTriangle:
+    tHead=tHead->next;
+    free(T);
+  }
+  /*Free unused points*/
+  for(p1=pHead->next; p1; p1=pHead->next){
+    pHead->next=p1->next;
+    free(p1);
+  }
+  pHead->next = 0;
+  pHead->p = 0;
+  /*Adjust neighbors number*/
+  maxn=j;
+  numofneighs = maxn;
+  return maxn;
+}
+/*---------------------------------------------------------------------------*/
+uint8_t redelca_power(short maxn)
+{
+  Point * p1;
+  short i, j, k;
+  float dis;
+  uint16_t maxp;
+
+  maxp = 31;
+    if (maxn >0){
+  maxp = 0;
+
+  for(i=0; i<maxn; ++i){
+	  
+
+    /*Initialize neighbors values*/
+    for(k=0; k<maxn; ++k){
+      dis = REDELCA_DISQR(pHead->neighbors[k]);
+      j = POWER_INDEX(dis);
+   
+      pHead->neighbors[k]->p = 3 + j * 4;
+      pHead->neighbors[k]->next = 0;
+    }
+    /*Find least power expensive neighbor*/
+    for(j=0, k=1; k<maxn && pHead->neighbors[j] != pHead->neighbors[i]; j = (pHead->neighbors[j]->p > pHead->neighbors[k]->p ? k : j), k++);
+
+    p1 = pHead->neighbors[j]->p == pHead->neighbors[i]->p ? pHead->neighbors[i] : pHead->neighbors[j];
+    p1->next = pHead;
+
+    /*Until i-th neighbor is not found keep searching*/
+    PROFILE_BEGIN(PROFILE_PATH);
+    while(p1->id != pHead->neighbors[i]->id){
+      /*If neighbor 0 of p1 exists and hasnt yet been visited estimate transmition power else set power to 500 (just a big value)*/
+      if(p1->neighbors[0] && !p1->neighbors[0]->next){
+        dis = DISQR(p1, p1->neighbors[0]);
+    
+        j = POWER_INDEX(dis);
+        j = 3 + j * 4;
+      } else {j=500;}
+      /*If neighbor 1 of p1 exists and hasnt yet been visited estimate transmition power else set power to 500 (just a big value)*/
+      if(p1->neighbors[1] && !p1->neighbors[1]->next){
+        dis = DISQR(p1, p1->neighbors[1]);
+      
+        k = POWER_INDEX(dis);
+        k = 3 + k * 4;
+      } else {k=500;}
+      
+      /*Well this is the case where the shortest path leads to nowhere!*/
+      if(j==500 && k==500 && !pHead->next){
+		 //  printf("NEIGHBOR: **%d\n", pHead->neighbors[i]->id);
+        break;
+      }
+      /*This is a case where the path somewhere has taken a wrong turn, this is the correcting action*/
+      if(j==500 && k==500) {
+        p1 = pHead->next;
+        pHead->next = 0;
+        dis = DISQR(p1, p1->neighbors[0]);
+       
+        j = POWER_INDEX(dis);
+        p1->neighbors[0]->p = 3 + j * 4;
+        p1->neighbors[0]->next = p1;
+        p1 = p1->neighbors[0];
+        continue;
+      }
+      /*There is a chance the proper neighbor isnt selected, this is done to continue from here*/
+      if(j == k){pHead->next = p1;}
+      /*Set future p1's next to current p1 power needed to reach p1*/
+      p1->neighbors[(j<k ? 0 : 1)]->next = p1;
+      p1->neighbors[(j<k ? 0 : 1)]->p = j<k ? j : k;
+
+      /*Continue to the least power expensive neighbor*/
+      p1 = p1->neighbors[(j<k ? 0 : 1)];
+    }
+    PROFILE_END(PROFILE_PATH);
+    pHead->next = 0;
+    if(j==500 && k==500){
+      //printf("neighbor not found in shortest path!\n");
+      //  printf("NEIGHBOR: ****%d\n", pHead->neighbors[i]->id);
+    }
+    else {
+      j=0;
+      while(p1){
+       j += p1->p;
+       p1 = p1->next;
+      }
+    }
+    dis = REDELCA_DISQR(pHead->neighbors[i]);
+ 
+    k = POWER_INDEX(dis);
+    
+    k = 3 + k * 4;
+  
+    /*Select the optimal transimtion power for i-th neighbor*/
+    k = k<j?k:j;
+    maxp = maxp>k ? maxp : k;
+  }
+	if (maxp == 0){maxp = 31;}
+  }
+  return maxp;
+}
+/*---------------------------------------------------------------------------*/
+/*The triangulation is over every point heard, so that an edge of it may be longer than any link: to a neighbour heard at
+  a longer range than the power table gives (or weighted by RSSI), and mostly between two neighbours on opposite sides of
+  the node, up to twice the range. redelca_power would take such an edge for a link at full power.*/
+short redelca_unit(short maxn)
+{
+  Point * p1;
+  short i, j, m;
+
+  for(i=0, m=0; i<maxn; ++i){
+    p1 = pHead->neighbors[i];
+    if(REDELCA_DISQR(p1) > POWER[POWER_LEVELS-1]){
+      continue;
+    }
+    /*kept ones first, the others stay in the array (and are freed with it)*/
+    pHead->neighbors[i] = pHead->neighbors[m];
+    pHead->neighbors[m++] = p1;
+  }
+  /*the ring edges to a dropped neighbour, or longer than the range; the path search expects [0] before [1]*/
+  for(i=0; i<m; ++i){
+    p1 = pHead->neighbors[i];
+    for(j=0; j<2; ++j){
+      if(p1->neighbors[j] && (REDELCA_DISQR(p1->neighbors[j]) > POWER[POWER_LEVELS-1] ||
+                              DISQR(p1, p1->neighbors[j]) > POWER[POWER_LEVELS-1])){
+        p1->neighbors[j] = 0;
+      }
+    }
+    if(!p1->neighbors[0]){
+      p1->neighbors[0] = p1->neighbors[1];
+      p1->neighbors[1] = 0;
+    }
+  }
+  return m;
+}
+/*---------------------------------------------------------------------------*/
+void redelca_confirm(short maxn, short (*confirms)(short from, short to))
+{
+  Point * p1;
+  short i, j;
+
+  /*an edge only one end has in its triangulation is not a link the path search may take*/
+  for(i=0; i<maxn; ++i){
+    p1 = pHead->neighbors[i];
+    for(j=0; j<2; ++j){
+      if(p1->neighbors[j] && !(confirms(p1->id, p1->neighbors[j]->id) && confirms(p1->neighbors[j]->id, p1->id))){
+        p1->neighbors[j] = 0;
+      }
+    }
+    if(!p1->neighbors[0]){
+      p1->neighbors[0] = p1->neighbors[1];
+      p1->neighbors[1] = 0;
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+/*A Delaunay edge of the node to p is a Gabriel edge if no point is in the disk of diameter pHead-p, and a relative
+  neighbourhood one if no point is nearer to both of them than they are to each other. The only points that can break
+  the Gabriel test are the two that make a Delaunay triangle with the edge, the ring neighbours of p; the relative
+  neighbourhood test is made against them as well, which keeps every edge of the graph and may keep a few more.*/
+static short witness(Point * p, Point * w)
+{
+  float d = DISQR(pHead, p);
+
+  if(!w){
+    return 0;
+  }
+#if REDELCA_FILTER == REDELCA_FILTER_RNG
+  return DISQR(pHead, w) < d && DISQR(p, w) < d;
+#else
+  return DISQR(pHead, w) + DISQR(p, w) < d;
+#endif
+}
+/*---------------------------------------------------------------------------*/
+short redelca_filter(short maxn)
+{
+  Point * p1;
+  short i, m;
+
+  for(i=0, m=0; i<maxn; ++i){
+    p1 = pHead->neighbors[i];
+    if(witness(p1, p1->neighbors[0]) || witness(p1, p1->neighbors[1])){
+      continue;
+    }
+    /*kept ones first, the others stay in the array (and are freed with it)*/
+    pHead->neighbors[i] = pHead->neighbors[m];
+    pHead->neighbors[m++] = p1;
+  }
+  return m;
+}
+/*---------------------------------------------------------------------------*/
+uint8_t redelca_reach(short maxn)
+{
+  short i;
+  uint8_t k, maxp = 0;
+
+  for(i=0; i<maxn; ++i){
+    k = power_level(REDELCA_DISQR(pHead->neighbors[i]));
+    maxp = maxp>k ? maxp : k;
+  }
+  return maxp ? maxp : 31;
+}
+/*---------------------------------------------------------------------------*/
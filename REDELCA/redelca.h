@@ -0,0 +1,115 @@
+ /* Copyright (c) 2015, Computer Science Department (CSD), University of Crete, and 
+ * Signal Processing Lab (SPL), Institute of Computer Science (ICS), FORTH, Greece.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of CSD, SPL/ICS-FORTH nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+ /**
+  * \file
+ * The header file for the REDELCA computation of a node. The points (positions) of the node (first) and of its
+ * neighbours are added with addREDELCApoint; then the computation runs in three steps:
+ * redelca_triangulate, redelca_neighbors and redelca_power. redelca_restart starts over from the Delaunay neighbours,
+ * which are also the Delaunay neighbours of the node among themselves, so the computation gives the same result.
+ *
+ * \author
+ * Phivos Phivou, Computer Science Department, University of Crete.
+ *
+ * email: fivou@csd.uoc.gr, apanouso@ics.forth.gr
+ *
+ *
+ * This code has been writted for contiki-2.7 distribution.
+*/
+
+#ifndef REDELCA_H
+#define REDELCA_H
+
+#include <stdint.h>
+#include "definitions.h"
+#include "linkest.h"
+
+/*the squared distance from the node to its neighbour _p, as the power selection sees it: from the positions, or from
+  the RSSI kept in _p->rssi (see linkest.h)*/
+#if LINKEST_WEIGHT == LINKEST_RSSI
+#define REDELCA_DISQR(_p) LINKEST_DISQR((_p)->rssi)
+#else
+#define REDELCA_DISQR(_p) DISQR(pHead, (_p))
+#endif
+
+/*filters of the Delaunay neighbours (REDELCA_CONF_FILTER): none, and then the power is that of the least power paths
+  over them (redelca_power), or those of the Gabriel graph or of the relative neighbourhood graph, and then the power is
+  the one that reaches each of them directly (redelca_reach)*/
+#define REDELCA_FILTER_NONE 0
+#define REDELCA_FILTER_GG   1
+#define REDELCA_FILTER_RNG  2
+
+#ifdef REDELCA_CONF_FILTER
+#define REDELCA_FILTER REDELCA_CONF_FILTER
+#else
+#define REDELCA_FILTER REDELCA_FILTER_NONE
+#endif
+
+/*unit Delaunay (REDELCA_CONF_UNIT): the edges of the triangulation longer than the range at full power, POWER[POWER_LEVELS-1],
+  are dropped before the power selection (redelca_unit)*/
+#ifdef REDELCA_CONF_UNIT
+#define REDELCA_UNIT REDELCA_CONF_UNIT
+#else
+#define REDELCA_UNIT 0
+#endif
+
+/*ring check (REDELCA_CONF_RING_CHECK): a node builds its ring from its own triangulation, and a neighbour may not have
+  the edge between two of its Delaunay neighbours. Every node advertises its Delaunay neighbours in a ring round before
+  the power selection, and the ring edges both ends of which do not advertise each other are dropped (redelca_confirm)*/
+#ifdef REDELCA_CONF_RING_CHECK
+#define REDELCA_RING_CHECK REDELCA_CONF_RING_CHECK
+#else
+#define REDELCA_RING_CHECK 0
+#endif
+
+/*(re)initializes the points and triangles lists, freeing what they hold*/
+void		redelca_init		(void);
+/*puts the node and its Delaunay neighbours back as the points, to run the computation again (after redelca_neighbors)*/
+void		redelca_restart		(void);
+/*Delaunay triangulation of the points; returns the number of points (2 for two points) or a negative error code*/
+short int	redelca_triangulate	(void);
+/*keeps the Delaunay neighbours of the node only; returns their number*/
+short int	redelca_neighbors	(void);
+/*the least transmission power (3..31) that reaches every Delaunay neighbour, directly or over a path of them*/
+uint8_t		redelca_power		(short int maxn);
+/*keeps the Delaunay neighbours in range, first in pHead->neighbors, and the edges between them on the ring that are in
+  range, [0] first (after redelca_neighbors); returns their number*/
+short int	redelca_unit		(short int maxn);
+/*keeps the Delaunay neighbours that pass the test of REDELCA_FILTER, first in pHead->neighbors (after
+  redelca_neighbors); returns their number*/
+short int	redelca_filter		(short int maxn);
+/*keeps the edges between the Delaunay neighbours on the ring that both of their ends confirm, confirms(from, to) being
+  whether from advertised to as a Delaunay neighbour; [0] first (after redelca_neighbors)*/
+void		redelca_confirm		(short int maxn, short int (*confirms)(short int from, short int to));
+/*the least transmission power (3..31) that reaches every neighbour directly*/
+uint8_t		redelca_reach		(short int maxn);
+
+#endif
@@ -0,0 +1,406 @@
+/*
+ * Copyright (c) 2015, Computer Science Department (CSD), University of Crete, and 
+ * Signal Processing Lab (SPL), Institute of Computer Science (ICS), FORTH, Greece.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of CSD, SPL/ICS-FORTH nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * 
+ */
+
+/**
+ * \file
+ *         Microbenchmarks of the compute kernels of the LMST and REDELCA
+ *         firmwares, for the Z1 under MSPSim (see README).
+ *
+ *         The kernels run on canned neighbourhoods: BENCH_LAYOUTS random
+ *         layouts (a fixed seed, the same in every run) of n = 5, 10, ..., 30
+ *         neighbours within BENCH_RANGE metres of the node. Each kernel runs
+ *         with the interrupts disabled, and is timed in MCLK cycles with
+ *         Timer B on SMCLK (the low 16 bits) and the rtimer (Timer A on ACLK,
+ *         the rest), less the cost of the timing itself. A kernel must be
+ *         shorter than the rtimer wraps (2 s); one of 2 to 4 s is reported
+ *         as overflow. The stack a kernel takes is found by painting the free
+ *         RAM between the heap and the stack before it runs.
+ *
+ *         Every result is one line on the serial line:
+ *           BENCH <kernel> <n> <layout> <cycles> <stack bytes> <return value>
+ *         and the run ends with "BENCH DONE".
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "contiki.h"
+#include "dev/watchdog.h"
+
+#include "lmst.h"
+#include "redelca.h"
+#include "power.h"
+#include "profile.h"
+
+#ifdef BENCH_CONF_LAYOUTS
+#define BENCH_LAYOUTS BENCH_CONF_LAYOUTS
+#else
+#define BENCH_LAYOUTS 3
+#endif
+
+#ifdef BENCH_CONF_SEED
+#define BENCH_SEED BENCH_CONF_SEED
+#else
+#define BENCH_SEED 1
+#endif
+
+/* neighbourhood sizes */
+#define BENCH_MIN   5
+#define BENCH_MAX   MAXPOINTS
+#define BENCH_STEP  5
+
+/* the node sits at (BENCH_X, BENCH_Y), its neighbours within BENCH_RANGE
+   metres (the range at full power) on a centimetre grid */
+#define BENCH_X     50
+#define BENCH_Y     50
+#define BENCH_RANGE 15
+
+/* rtimer ticks of the calibration of Timer B */
+#define BENCH_CALIBRATION 128
+
+/* bytes left unpainted above the heap (the header of its free block) and
+   below the frame of the caller of the kernel (paint() itself) */
+#define BENCH_HEAP_MARGIN  16
+#define BENCH_STACK_MARGIN 64
+#define BENCH_PAINT        0xa5
+
+static struct {
+  int16_t x, y;                 /* cm */
+} nodes[BENCH_MAX + 1];         /* the node (0) and its neighbours */
+
+static uint32_t seed;
+static uint16_t calibration;    /* cycles per BENCH_CALIBRATION rtimer ticks */
+static uint32_t overhead;       /* cycles of start() and stop() */
+static uint16_t ta0, tb0;
+static int spl;
+static uint8_t overflow;
+
+/* painted RAM, and the highest byte the heap has reached */
+static uint8_t *paint_from, *paint_to;
+static uint8_t *heap_top;
+static uint8_t twohop[3 * MAX_NEIGHBORS];
+/* squared distances of the neighbours to the node */
+static float d2[BENCH_MAX + 1];
+
+PROCESS(bench_process, "Benchmark");
+AUTOSTART_PROCESSES(&bench_process);
+/*---------------------------------------------------------------------------*/
+/* malloc() is wrapped at link time (see Makefile) to follow the heap */
+void *__real_malloc(size_t size);
+
+void *
+__wrap_malloc(size_t size)
+{
+  uint8_t *p = __real_malloc(size);
+
+  if(p != NULL && p + size > heap_top) {
+    heap_top = p + size;
+  }
+  return p;
+}
+/*---------------------------------------------------------------------------*/
+static uint16_t
+rnd(void)
+{
+  seed = seed * 1103515245 + 12345;
+  return seed >> 16;
+}
+/*---------------------------------------------------------------------------*/
+/* cycles since start(), also the PROFILE_NOW() of the profiled phases */
+unsigned long
+bench_now(void)
+{
+  uint16_t tb = TBR;
+  uint16_t ticks = RTIMER_NOW() - ta0;
+  uint32_t estimate;
+
+  /* the rtimer gives the cycles to within a tick, Timer B the exact low
+     16 bits */
+  estimate = (uint32_t)(ticks / BENCH_CALIBRATION) * calibration +
+    (uint32_t)(ticks % BENCH_CALIBRATION) * calibration / BENCH_CALIBRATION;
+  return estimate + (int16_t)((uint16_t)(tb - tb0) - (uint16_t)estimate);
+}
+/*---------------------------------------------------------------------------*/
+static void
+start(void)
+{
+  spl = splhigh();
+  TACTL &= ~TAIFG;
+  ta0 = RTIMER_NOW();
+  tb0 = TBR;
+}
+/*---------------------------------------------------------------------------*/
+static uint32_t
+stop(void)
+{
+  uint32_t cycles = bench_now();
+
+  /* the rtimer wrapped and went past ta0 again */
+  overflow = (TACTL & TAIFG) && RTIMER_NOW() >= ta0;
+  splx(spl);
+  return cycles > overhead ? cycles - overhead : 0;
+}
+/*---------------------------------------------------------------------------*/
+static void
+calibrate(void)
+{
+  rtimer_clock_t t;
+  uint16_t tb;
+
+  /* Timer B counts SMCLK (the MCLK, the DCO) */
+  TBCTL = TBSSEL_2 | MC_2 | TBCLR;
+
+  t = RTIMER_NOW();
+  while(RTIMER_NOW() == t);
+  t = RTIMER_NOW();
+  tb = TBR;
+  while((rtimer_clock_t)(RTIMER_NOW() - t) < BENCH_CALIBRATION);
+  calibration = TBR - tb;
+
+  overhead = 0;
+  start();
+  overhead = stop();
+}
+/*---------------------------------------------------------------------------*/
+static void __attribute__((noinline))
+paint(void)
+{
+  uint8_t here, *p;
+
+  paint_from = heap_top + BENCH_HEAP_MARGIN;
+  paint_to = &here - BENCH_STACK_MARGIN;
+  for(p = paint_from; p < paint_to; ++p) {
+    *p = BENCH_PAINT;
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* bytes of stack below frame, by the lowest byte that lost its paint (the
+   heap may have grown into the paint meanwhile) */
+static int
+stack(uint8_t *frame)
+{
+  uint8_t *p = paint_from;
+
+  if(paint_from >= paint_to) {
+    return -1;
+  }
+  if(heap_top + BENCH_HEAP_MARGIN > p) {
+    p = heap_top + BENCH_HEAP_MARGIN;
+  }
+  while(p < paint_to && *p == BENCH_PAINT) {
+    ++p;
+  }
+  return frame - p;
+}
+/*---------------------------------------------------------------------------*/
+static void
+report(const char *kernel, uint8_t n, uint8_t layout, uint32_t cycles, int stack, int result)
+{
+  if(overflow) {
+    printf("BENCH %s %u %u overflow - %d\n", kernel, n, layout, result);
+  } else if(stack < 0) {
+    printf("BENCH %s %u %u %lu - %d\n", kernel, n, layout, (unsigned long)cycles, result);
+  } else {
+    printf("BENCH %s %u %u %lu %d %d\n", kernel, n, layout, (unsigned long)cycles, stack, result);
+  }
+}
+
+/* runs and reports one kernel */
+#define MEASURE(_kernel, _call) do {                              \
+    paint();                                                      \
+    start();                                                      \
+    result = (_call);                                             \
+    cycles = stop();                                              \
+    report((_kernel), n, layout, cycles, stack(&frame), result);  \
+  } while(0)
+/*---------------------------------------------------------------------------*/
+/* squared distance of nodes i and j, in m^2, as the firmwares have it */
+static float
+distance(uint8_t i, uint8_t j)
+{
+  float x1 = nodes[i].x / 100.0, y1 = nodes[i].y / 100.0;
+  float x2 = nodes[j].x / 100.0, y2 = nodes[j].y / 100.0;
+
+  return LMST_WEIGHT(x1, y1, x2, y2);
+}
+/*---------------------------------------------------------------------------*/
+/* n neighbours of the node, apart from each other and from the node */
+static void
+neighbourhood(uint8_t n)
+{
+  uint8_t i, j;
+  int16_t x, y;
+
+  nodes[0].x = BENCH_X * 100;
+  nodes[0].y = BENCH_Y * 100;
+  for(i = 1; i <= n; ++i) {
+    do {
+      x = (int16_t)(rnd() % (2 * BENCH_RANGE * 100 + 1)) - BENCH_RANGE * 100;
+      y = (int16_t)(rnd() % (2 * BENCH_RANGE * 100 + 1)) - BENCH_RANGE * 100;
+      for(j = 0; j < i && (nodes[j].x != nodes[0].x + x || nodes[j].y != nodes[0].y + y); ++j);
+    } while(j < i || (int32_t)x * x + (int32_t)y * y > (int32_t)BENCH_RANGE * BENCH_RANGE * 10000);
+    nodes[i].x = nodes[0].x + x;
+    nodes[i].y = nodes[0].y + y;
+    d2[i] = distance(0, i);
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* the RSSI attribute the REDELCA firmware gets in the Cooja UDGM (see
+   tools/topoeval.c) */
+static float
+rssi(float dis)
+{
+  int16_t dbm = -10 - (int16_t)(85 * sqrt(dis) / BENCH_RANGE + 0.5);
+
+  return (uint16_t)((uint16_t)(dbm + 45) - 45);
+}
+/*---------------------------------------------------------------------------*/
+static void
+redelca(uint8_t n, uint8_t layout)
+{
+  uint8_t frame, i;
+  uint32_t cycles;
+  int result;
+  short maxn;
+  Point *point;
+
+  redelca_init();
+  for(i = 0; i <= n; ++i) {
+    point = malloc(sizeof(Point));
+    point->id = i + 1;
+    point->x = nodes[i].x / 100.0;
+    point->y = nodes[i].y / 100.0;
+    point->rssi = i == 0 ? 0 : rssi(d2[i]);
+    addREDELCApoint(point);
+  }
+
+  profile_reset();
+  MEASURE("triangulate", redelca_triangulate());
+  report("legalize", n, layout, profile_total(PROFILE_LEGALIZE), -1, profile_count(PROFILE_LEGALIZE));
+  MEASURE("neighbors", maxn = redelca_neighbors());
+  MEASURE("redelca_power", redelca_power(maxn));
+  report("path", n, layout, profile_total(PROFILE_PATH), -1, profile_count(PROFILE_PATH));
+
+  redelca_init();
+}
+/*---------------------------------------------------------------------------*/
+/* the 1-hop table neighbour j broadcasts (see lmst_twohop_payload), of
+   the node and the neighbours in its range; returns its length */
+static uint16_t
+table(uint8_t n, uint8_t j)
+{
+  uint16_t len = 0, val;
+  uint8_t k;
+  float dis;
+
+  for(k = 0; k <= n && len < sizeof(twohop); ++k) {
+    dis = distance(j, k);
+    if(k == j || dis > BENCH_RANGE * BENCH_RANGE) {
+      continue;
+    }
+    val = (uint16_t)floor(dis * PRES_CONST / PRES_RANGE);
+    twohop[len++] = k + 1;
+    twohop[len++] = val >> 8;
+    twohop[len++] = val & 0xff;
+  }
+  return len;
+}
+/*---------------------------------------------------------------------------*/
+static void
+lmst(uint8_t n, uint8_t layout)
+{
+  uint8_t frame, i;
+  uint16_t links;
+  uint32_t cycles;
+  int result;
+
+  lmst_init();
+  for(i = 1; i <= n; ++i) {
+    lmst_add_neighbor(1, i + 1, d2[i], 0, 0);
+  }
+  for(i = 1; i <= n; ++i) {
+    lmst_add_twohop(i + 1, twohop, table(n, i));
+  }
+
+  MEASURE("initialize", lmst_initialize(1));
+  MEASURE("prim", lmst_prim(1));
+  MEASURE("lmst_power", lmst_power(1, &links));
+
+  lmst_init();
+}
+/*---------------------------------------------------------------------------*/
+/* the power level of every neighbour */
+static uint8_t
+levels(uint8_t n)
+{
+  uint8_t i, level = 0;
+
+  for(i = 1; i <= n; ++i) {
+    level |= power_level(d2[i]);
+  }
+  return level;
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(bench_process, ev, data)
+{
+  static uint8_t n, layout;
+  uint8_t frame;
+  uint32_t cycles;
+  int result;
+
+  PROCESS_BEGIN();
+
+  watchdog_stop();
+  calibrate();
+  printf("BENCH CLOCK %u cycles per %u rtimer ticks, overhead %lu\n",
+         calibration, BENCH_CALIBRATION, (unsigned long)overhead);
+
+  seed = BENCH_SEED;
+  for(n = BENCH_MIN; n <= BENCH_MAX; n += BENCH_STEP) {
+    for(layout = 0; layout < BENCH_LAYOUTS; ++layout) {
+      neighbourhood(n);
+      redelca(n, layout);
+      /* the LMST tables hold MAX_NEIGHBORS neighbours */
+      if(n <= MAX_NEIGHBORS) {
+        lmst(n, layout);
+      }
+      MEASURE("power_level", levels(n));
+      PROCESS_PAUSE();
+    }
+  }
+  printf("BENCH DONE\n");
+
+  watchdog_start();
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
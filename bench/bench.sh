@@ -0,0 +1,121 @@
+#!/bin/bash
+#
+# Runs the kernel microbenchmarks (bench.z1) on MSPSim, headless, and sums
+# them up per kernel and neighbourhood size: cycles (mean, min and max over
+# the layouts) and stack peak, followed by the code size of every kernel.
+#
+# Build the image first with: make TARGET=z1
+#
+
+usage() {
+	cat <<EOU
+usage: $0 [options] [bench.z1]
+	-o <file>		results table (default bench.tsv)
+	-l <file>		raw serial output of the run (default bench.log)
+	-t <seconds>		wall-clock time limit of the run (default 600)
+
+MSPSIM_JAR must be set, e.g.:
+	MSPSIM_JAR=~/contiki-2.7/tools/mspsim/mspsim.jar $0
+The code sizes need msp430-nm (or NM) in the path.
+EOU
+	exit 1
+}
+
+RESULTS=bench.tsv
+LOG=bench.log
+TIMEOUT=600
+NM=${NM:-msp430-nm}
+
+while getopts "o:l:t:" opt; do
+	case $opt in
+		o) RESULTS=$OPTARG ;;
+		l) LOG=$OPTARG ;;
+		t) TIMEOUT=$OPTARG ;;
+		*) usage ;;
+	esac
+done
+shift $((OPTIND - 1))
+IMAGE=${1:-bench.z1}
+
+[[ -n $MSPSIM_JAR ]] || usage
+if [[ ! -f $IMAGE ]]; then
+	printf "$IMAGE not found, type make TARGET=z1\n"
+	exit 1
+fi
+
+# MSPSim runs until the image reports BENCH DONE
+java -jar "$MSPSIM_JAR" -platform=z1 -nogui "$IMAGE" > "$LOG" 2>&1 &
+PID=$!
+trap 'kill $PID 2>/dev/null' EXIT
+for ((t = 0; t < TIMEOUT; ++t)); do
+	grep -q "BENCH DONE" "$LOG" && break
+	kill -0 $PID 2>/dev/null || break
+	sleep 1
+done
+if ! grep -q "BENCH DONE" "$LOG"; then
+	printf "the benchmark did not complete, see $LOG\n"
+	exit 1
+fi
+grep -o "BENCH CLOCK.*" "$LOG"
+
+# BENCH <kernel> <n> <layout> <cycles> <stack> <return value>
+printf "#kernel\tn\tlayouts\tmean_cycles\tmin_cycles\tmax_cycles\tmax_stack\n" > "$RESULTS"
+grep -o "BENCH .*" "$LOG" | awk '
+	$2 == "CLOCK" || $2 == "DONE" { next }
+	{
+		k = $2 "\t" $3;
+		if(!(k in n)) order[++keys] = k;
+		n[k]++;
+		if($5 == "overflow") { over[k] = 1; next; }
+		sum[k] += $5;
+		if(!(k in min) || $5 < min[k]) min[k] = $5;
+		if($5 > max[k]) max[k] = $5;
+		if($6 != "-" && $6 > stack[k]) stack[k] = $6;
+	}
+	END {
+		for(i = 1; i <= keys; ++i) {
+			k = order[i];
+			if(over[k]) { printf "%s\t%d\toverflow\t-\t-\t-\n", k, n[k]; continue; }
+			printf "%s\t%d\t%.0f\t%d\t%d\t%s\n", k, n[k], sum[k] / n[k], min[k], max[k],
+			       k in stack ? stack[k] : "-";
+		}
+	}' >> "$RESULTS"
+
+# Code size (bytes) of the functions and tables of every kernel; the
+# soft-float routines of libgcc are shared by all of them.
+printf "\n#kernel\tcode_bytes\n" >> "$RESULTS"
+"$NM" -S --size-sort "$IMAGE" | awk '
+	function hex(s,    v, i) {
+		for(i = 1; i <= length(s); ++i) v = v * 16 + index("0123456789abcdef", tolower(substr(s, i, 1))) - 1;
+		return v;
+	}
+	BEGIN {
+		k["triangulate"] = "redelca_triangulate delaunay addPoint pointInTriangle legalizeEdge swap calcCenter";
+		k["legalize"] = "legalizeEdge swap calcCenter";
+		k["neighbors"] = "redelca_neighbors";
+		k["redelca_power"] = "redelca_power";
+		k["initialize"] = "lmst_initialize free_edges";
+		k["prim"] = "lmst_prim";
+		k["lmst_power"] = "lmst_power";
+		k["power_level"] = "power_level POWER";
+		for(name in k) {
+			split(k[name], s, " ");
+			for(i in s) of[s[i]] = of[s[i]] " " name;
+		}
+	}
+	NF == 4 {
+		size = hex($2);
+		if($4 ~ /^__.*(sf|df|si)[0-9]?$/ || $4 ~ /^__(un)?pack_f$|^_fpadd_parts$|^__fpcmp_parts_f$/) {
+			size_of["softfloat"] += size;
+			next;
+		}
+		split(of[$4], names, " ");
+		for(i in names) size_of[names[i]] += size;
+	}
+	END {
+		split("triangulate legalize neighbors redelca_power initialize prim lmst_power power_level softfloat", order, " ");
+		for(i = 1; i in order; ++i) printf "%s\t%d\n", order[i], size_of[order[i]];
+	}' >> "$RESULTS"
+
+cat "$RESULTS"
+printf "\nresults in %s\n" "$RESULTS"
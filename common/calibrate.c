@@ -0,0 +1,189 @@
+/*
+ * Copyright (c) 2015, Computer Science Department (CSD), University of Crete, and 
+ * Signal Processing Lab (SPL), Institute of Computer Science (ICS), FORTH, Greece.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of CSD, SPL/ICS-FORTH nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * 
+ */
+
+/**
+ * \file
+ *         Online calibration of the power table (see calibrate.h).
+ *
+ *         The beacons received from a node are counted per level, 2 bits
+ *         each, in a 16-bit word; a report entry is the id of the node (one
+ *         byte, as the firmwares take it), the counts and the average RSSI
+ *         at full power (dBm, one signed byte).
+ */
+
+#include <string.h>
+
+#include "calibrate.h"
+#include "linkest.h"
+#include "net/packetbuf.h"
+
+/* the table is const without the calibration */
+#if CALIBRATE_ENABLED
+
+/* dBm of the CC2420 RSSI register */
+#define RSSI_OFFSET -45
+
+#define COUNT(_c, _i) (((_c) >> (2 * (_i))) & 3)
+#define ENTRY 4
+
+/* the nodes heard: beacons per level, RSSI sum at full power */
+static struct {
+  uint16_t id;
+  uint16_t counts;
+  int16_t rssi;
+} heard[CALIBRATE_SIZE];
+static uint8_t nheard;
+
+/* what the neighbours reported about the node */
+static struct {
+  uint16_t id;
+  uint16_t counts;
+  int8_t rssi;
+} reports[CALIBRATE_SIZE];
+static uint8_t nreports;
+
+/*---------------------------------------------------------------------------*/
+void
+calibrate_init(void)
+{
+  nheard = 0;
+  nreports = 0;
+}
+/*---------------------------------------------------------------------------*/
+void
+calibrate_beacon(uint8_t b)
+{
+  uint8_t *buf = packetbuf_dataptr();
+  uint8_t level = b / CALIBRATE_BEACONS;
+
+  buf[0] = CALIBRATE_BEACON;
+  buf[1] = level;
+  packetbuf_set_datalen(2);
+  packetbuf_set_attr(PACKETBUF_ATTR_RADIO_TXPOWER, POWER_LEVEL(level) + 1);
+}
+/*---------------------------------------------------------------------------*/
+void
+calibrate_heard(uint16_t from)
+{
+  uint8_t *buf = packetbuf_dataptr();
+  uint8_t i, level = buf[1];
+
+  if(packetbuf_datalen() < 2 || level >= POWER_LEVELS) {
+    return;
+  }
+  for(i = 0; i < nheard && heard[i].id != from; ++i);
+  if(i == nheard) {
+    if(nheard == CALIBRATE_SIZE) {
+      return;
+    }
+    heard[i].id = from;
+    heard[i].counts = 0;
+    heard[i].rssi = 0;
+    nheard++;
+  }
+  if(COUNT(heard[i].counts, level) < 3) {
+    heard[i].counts += 1 << (2 * level);
+  }
+  if(level == POWER_LEVELS - 1) {
+    heard[i].rssi += (int16_t)packetbuf_attr(PACKETBUF_ATTR_RSSI) + RSSI_OFFSET;
+  }
+}
+/*---------------------------------------------------------------------------*/
+void
+calibrate_report(void)
+{
+  uint8_t *buf = packetbuf_dataptr();
+  uint8_t i, n, top;
+
+  buf[0] = CALIBRATE_REPORT;
+  for(i = 0, n = 1; i < nheard; ++i, n += ENTRY) {
+    top = COUNT(heard[i].counts, POWER_LEVELS - 1);
+    buf[n] = heard[i].id;
+    buf[n + 1] = heard[i].counts & 0xff;
+    buf[n + 2] = heard[i].counts >> 8;
+    buf[n + 3] = (uint8_t)(int8_t)(top ? heard[i].rssi / top : LINKEST_SS_WEAK);
+  }
+  packetbuf_set_datalen(n);
+}
+/*---------------------------------------------------------------------------*/
+void
+calibrate_reported(uint16_t from)
+{
+  uint8_t *buf = packetbuf_dataptr();
+  uint16_t n, len = packetbuf_datalen();
+
+  for(n = 1; n + ENTRY <= len; n += ENTRY) {
+    if(buf[n] == rimeaddr_node_addr.u8[0] && nreports < CALIBRATE_SIZE) {
+      reports[nreports].id = from;
+      reports[nreports].counts = buf[n + 1] | (buf[n + 2] << 8);
+      reports[nreports].rssi = (int8_t)buf[n + 3];
+      nreports++;
+      return;
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+uint8_t
+calibrate_fit(float (* weight)(uint16_t id))
+{
+  float w, reached, missed;
+  uint8_t i, r;
+
+  for(i = 0; i < POWER_LEVELS; ++i) {
+    reached = missed = -1;
+    for(r = 0; r < nreports; ++r) {
+      w = weight(reports[r].id);
+      if(w < 0) {
+        w = LINKEST_DISQR(reports[r].rssi);
+      }
+      if(COUNT(reports[r].counts, i) >= CALIBRATE_RECEIVED) {
+        reached = w > reached ? w : reached;
+      } else if(missed < 0 || w < missed) {
+        missed = w;
+      }
+    }
+    if(missed >= 0) {
+      POWER[i] = missed;
+    } else if(reached >= POWER[i]) {
+      /*reached: strictly below POWER[i]*/
+      POWER[i] = reached * 1.01f + 0.01f;
+    }
+  }
+  for(i = POWER_LEVELS - 1; i > 0; --i) {
+    if(POWER[i - 1] > POWER[i]) {
+      POWER[i - 1] = POWER[i];
+    }
+  }
+  return nreports;
+}
+/*---------------------------------------------------------------------------*/
+#endif /* CALIBRATE_ENABLED */
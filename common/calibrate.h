@@ -0,0 +1,126 @@
+/*
+ * Copyright (c) 2015, Computer Science Department (CSD), University of Crete, and 
+ * Signal Processing Lab (SPL), Institute of Computer Science (ICS), FORTH, Greece.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of CSD, SPL/ICS-FORTH nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * 
+ */
+
+/**
+ * \file
+ *         Online calibration of the power table (POWER, see power.h) from
+ *         the measured link quality.
+ *
+ *         With CALIBRATE_CONF_ENABLED, the firmware runs two more phases
+ *         after the position discovery. In the first one every node sends,
+ *         in its slot, CALIBRATE_BEACONS beacons at each of the
+ *         POWER_LEVELS power levels; its neighbours count the beacons they
+ *         receive at each level, and the RSSI at full power. In the second
+ *         one every node broadcasts its report: for every node it heard,
+ *         the reception ratio at each level and the RSSI. A node then fits
+ *         its own table from the reports about it: POWER[i] is the least
+ *         squared distance of a neighbour that level i does not reach (a
+ *         level reaches a neighbour that received CALIBRATE_RECEIVED of its
+ *         beacons), or, if level i reaches all of them, the larger of the
+ *         value in the table (the default one at first) and the farthest
+ *         one reached. A level is then lowered to the one above it where
+ *         needed, so that the table stays non-decreasing.
+ *
+ *         The squared distance of a neighbour is the weight the firmware
+ *         gives (from the positions or the RSSI, see linkest.h), or, for a
+ *         neighbour the node did not hear, the one of the RSSI it reported.
+ */
+
+#ifndef CALIBRATE_H_
+#define CALIBRATE_H_
+
+#include "contiki.h"
+#include "power.h"
+
+#ifdef CALIBRATE_CONF_ENABLED
+#define CALIBRATE_ENABLED CALIBRATE_CONF_ENABLED
+#else
+#define CALIBRATE_ENABLED 0
+#endif
+
+/* beacons per power level (at most 3), and those a level must get through */
+#ifdef CALIBRATE_CONF_BEACONS
+#define CALIBRATE_BEACONS CALIBRATE_CONF_BEACONS
+#else
+#define CALIBRATE_BEACONS 2
+#endif
+
+#ifdef CALIBRATE_CONF_RECEIVED
+#define CALIBRATE_RECEIVED CALIBRATE_CONF_RECEIVED
+#else
+#define CALIBRATE_RECEIVED ((CALIBRATE_BEACONS + 1) / 2)
+#endif
+
+/* beacons a node sends in its slot */
+#define CALIBRATE_FRAMES (POWER_LEVELS * CALIBRATE_BEACONS)
+
+/* nodes followed, as senders (the report holds 4 bytes each) and as
+   reporters */
+#ifdef CALIBRATE_CONF_SIZE
+#define CALIBRATE_SIZE CALIBRATE_CONF_SIZE
+#else
+#define CALIBRATE_SIZE 20
+#endif
+
+/* length of each of the two phases (ticks) */
+#ifdef CALIBRATE_CONF_PHASE
+#define CALIBRATE_PHASE CALIBRATE_CONF_PHASE
+#else
+#define CALIBRATE_PHASE (15 * CLOCK_SECOND)
+#endif
+
+/* first byte of a beacon, and of a report */
+#define CALIBRATE_BEACON 'C'
+#define CALIBRATE_REPORT 'R'
+
+/* forgets the beacons and reports heard */
+void calibrate_init(void);
+
+/* puts beacon b (0..CALIBRATE_FRAMES - 1) in the packet buffer, with its
+   power level */
+void calibrate_beacon(uint8_t b);
+
+/* a beacon (CALIBRATE_BEACON) is in the packet buffer */
+void calibrate_heard(uint16_t from);
+
+/* puts the report in the packet buffer */
+void calibrate_report(void);
+
+/* a report (CALIBRATE_REPORT) is in the packet buffer: keeps what it says
+   about the node */
+void calibrate_reported(uint16_t from);
+
+/* fits POWER from the reports; weight(id) is the squared distance of a
+   neighbour, negative if unknown; returns the number of reports */
+uint8_t calibrate_fit(float (* weight)(uint16_t id));
+
+#endif /* CALIBRATE_H_ */
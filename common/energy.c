@@ -0,0 +1,131 @@
+/*
+ * Copyright (c) 2015, Computer Science Department (CSD), University of Crete, and 
+ * Signal Processing Lab (SPL), Institute of Computer Science (ICS), FORTH, Greece.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of CSD, SPL/ICS-FORTH nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * 
+ */
+
+/**
+ * \file
+ *         Per-phase energy accounting (see energy.h).
+ */
+
+#include "energy.h"
+#include "telemetry.h"
+
+/* the power of every state, in uW */
+static const uint32_t power[ENERGY_STATES] = {
+  (uint32_t)ENERGY_CURRENT_CPU * ENERGY_VOLTAGE / 1000,
+  (uint32_t)ENERGY_CURRENT_LPM * ENERGY_VOLTAGE / 1000,
+  (uint32_t)ENERGY_CURRENT_TX * ENERGY_VOLTAGE / 1000,
+  (uint32_t)ENERGY_CURRENT_RX * ENERGY_VOLTAGE / 1000
+};
+
+static const uint8_t types[ENERGY_STATES] = {
+  ENERGEST_TYPE_CPU, ENERGEST_TYPE_LPM, ENERGEST_TYPE_TRANSMIT, ENERGEST_TYPE_LISTEN
+};
+
+struct span {
+  uint32_t start[ENERGY_STATES];
+  uint32_t ticks[ENERGY_STATES];
+  uint8_t used;
+};
+
+static struct span spans[ENERGY_SPANS];
+/*---------------------------------------------------------------------------*/
+void
+energy_begin(uint8_t span)
+{
+  uint8_t i;
+
+  for(i = 0; i < ENERGY_STATES; ++i) {
+    spans[span].start[i] = energest_type_time(types[i]);
+  }
+  spans[span].used = 1;
+}
+/*---------------------------------------------------------------------------*/
+void
+energy_end(uint8_t span)
+{
+  uint8_t i;
+
+  for(i = 0; i < ENERGY_STATES; ++i) {
+    spans[span].ticks[i] += energest_type_time(types[i]) - spans[span].start[i];
+  }
+}
+/*---------------------------------------------------------------------------*/
+uint32_t
+energy_ticks(uint8_t span, uint8_t state)
+{
+  return spans[span].ticks[state];
+}
+/*---------------------------------------------------------------------------*/
+uint32_t
+energy_uj(uint8_t span)
+{
+  uint32_t uj = 0, t;
+  uint8_t i;
+
+  /* whole seconds and the rest apart, so that nothing overflows 32 bits */
+  for(i = 0; i < ENERGY_STATES; ++i) {
+    t = spans[span].ticks[i];
+    uj += (t / RTIMER_SECOND) * power[i] +
+      (t % RTIMER_SECOND) * power[i] / RTIMER_SECOND;
+  }
+  return uj;
+}
+/*---------------------------------------------------------------------------*/
+static uint8_t *
+put32(uint8_t *b, uint32_t v)
+{
+  *b++ = v >> 24;
+  *b++ = v >> 16;
+  *b++ = v >> 8;
+  *b++ = v;
+  return b;
+}
+/*---------------------------------------------------------------------------*/
+void
+energy_report(void)
+{
+  uint8_t buf[ENERGY_SPANS * ENERGY_RECORD], *b = buf;
+  uint8_t i, j;
+
+  for(i = 0; i < ENERGY_SPANS; ++i) {
+    if(!spans[i].used) {
+      continue;
+    }
+    *b++ = i;
+    for(j = 0; j < ENERGY_STATES; ++j) {
+      b = put32(b, spans[i].ticks[j]);
+    }
+    b = put32(b, energy_uj(i));
+  }
+  telemetry_data(TELEMETRY_ENERGY, buf, b - buf);
+}
+/*---------------------------------------------------------------------------*/
@@ -0,0 +1,125 @@
+/*
+ * Copyright (c) 2015, Computer Science Department (CSD), University of Crete, and 
+ * Signal Processing Lab (SPL), Institute of Computer Science (ICS), FORTH, Greece.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of CSD, SPL/ICS-FORTH nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * 
+ */
+
+/**
+ * \file
+ *         Per-phase energy accounting, on top of Energest.
+ *
+ *         A firmware splits its run into spans (position discovery, 2-hop
+ *         discovery, computation, verification beacon) and brackets each
+ *         one with energy_begin() and energy_end(); a span may be opened
+ *         and closed more than once, the ticks add up. Every span keeps the
+ *         Energest ticks (RTIMER_SECOND per second) of the CPU, LPM, TX and
+ *         RX states, and its energy in microjoules from the current model
+ *         below. energy_report() emits all spans as one telemetry record.
+ *
+ *         The current model defaults to the Z1 (MSP430 at 8 MHz, CC2420 at
+ *         0 dBm) and can be changed in project-conf.h: ENERGY_CONF_VOLTAGE
+ *         in mV and ENERGY_CONF_CURRENT_<state> in uA. The power of a state
+ *         (current times voltage) must stay under 131 mW.
+ */
+
+#ifndef ENERGY_H_
+#define ENERGY_H_
+
+#include "contiki.h"
+
+#ifdef ENERGY_CONF_VOLTAGE
+#define ENERGY_VOLTAGE ENERGY_CONF_VOLTAGE
+#else
+#define ENERGY_VOLTAGE 3000
+#endif
+
+#ifdef ENERGY_CONF_CURRENT_CPU
+#define ENERGY_CURRENT_CPU ENERGY_CONF_CURRENT_CPU
+#else
+#define ENERGY_CURRENT_CPU 4100
+#endif
+
+#ifdef ENERGY_CONF_CURRENT_LPM
+#define ENERGY_CURRENT_LPM ENERGY_CONF_CURRENT_LPM
+#else
+#define ENERGY_CURRENT_LPM 55
+#endif
+
+#ifdef ENERGY_CONF_CURRENT_TX
+#define ENERGY_CURRENT_TX ENERGY_CONF_CURRENT_TX
+#else
+#define ENERGY_CURRENT_TX 17400
+#endif
+
+#ifdef ENERGY_CONF_CURRENT_RX
+#define ENERGY_CURRENT_RX ENERGY_CONF_CURRENT_RX
+#else
+#define ENERGY_CURRENT_RX 18800
+#endif
+
+/* Spans */
+enum {
+  ENERGY_POSITION,          /* position beacons (1-hop discovery) */
+  ENERGY_TWOHOP,            /* LMST: 2-hop discovery */
+  ENERGY_COMPUTE,           /* computation of the topology */
+  ENERGY_VERIFY,            /* verification beacon at the selected power */
+  ENERGY_SPANS
+};
+
+/* The names of the spans, for decoders */
+#define ENERGY_NAMES { "POSITION", "TWOHOP", "COMPUTE", "VERIFY" }
+
+/* States */
+enum {
+  ENERGY_CPU,
+  ENERGY_LPM,
+  ENERGY_TX,
+  ENERGY_RX,
+  ENERGY_STATES
+};
+
+/* Bytes per span in the ENERGY record: span, cpu, lpm, tx, rx (4 each), energy in uJ (4) */
+#define ENERGY_RECORD 21
+
+/* opens a span */
+void energy_begin(uint8_t span);
+
+/* closes a span, adding the ticks since energy_begin() */
+void energy_end(uint8_t span);
+
+/* the ticks of a state in a span */
+uint32_t energy_ticks(uint8_t span, uint8_t state);
+
+/* the energy of a span, in uJ */
+uint32_t energy_uj(uint8_t span);
+
+/* emits every span that was opened as one ENERGY telemetry record */
+void energy_report(void);
+
+#endif /* ENERGY_H_ */
@@ -0,0 +1,115 @@
+/*
+ * Copyright (c) 2015, Computer Science Department (CSD), University of Crete, and 
+ * Signal Processing Lab (SPL), Institute of Computer Science (ICS), FORTH, Greece.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of CSD, SPL/ICS-FORTH nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * 
+ */
+
+/**
+ * \file
+ *         Link weights from the measured RSSI (see linkest.h).
+ */
+
+#include "linkest.h"
+
+/* the average is kept in 1/16 dBm */
+#define FRACTION 4
+
+static struct {
+  uint16_t id;
+  int16_t average;
+  uint8_t samples;
+} table[LINKEST_SIZE];
+static uint8_t count;
+
+/*---------------------------------------------------------------------------*/
+static int
+lookup(uint16_t id)
+{
+  uint8_t i;
+
+  for(i = 0; i < count; ++i) {
+    if(table[i].id == id) {
+      return i;
+    }
+  }
+  return -1;
+}
+/*---------------------------------------------------------------------------*/
+void
+linkest_init(void)
+{
+  count = 0;
+}
+/*---------------------------------------------------------------------------*/
+int
+linkest_sample(uint16_t id, int16_t dbm)
+{
+  int i = lookup(id);
+
+  if(i < 0) {
+    if(count == LINKEST_SIZE) {
+      return 0;
+    }
+    i = count++;
+    table[i].id = id;
+    table[i].average = dbm * (1 << FRACTION);
+    table[i].samples = 1;
+    return 1;
+  }
+  table[i].average += (dbm * (1 << FRACTION) - table[i].average) / (1 << LINKEST_EWMA_SHIFT);
+  if(table[i].samples < 255) {
+    table[i].samples++;
+  }
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+float
+linkest_rssi(uint16_t id)
+{
+  int i = lookup(id);
+
+  return i < 0 ? LINKEST_SS_WEAK : (float)table[i].average / (1 << FRACTION);
+}
+/*---------------------------------------------------------------------------*/
+float
+linkest_weight(uint16_t id)
+{
+  float dbm = linkest_rssi(id);
+
+  return LINKEST_DISQR(dbm);
+}
+/*---------------------------------------------------------------------------*/
+uint8_t
+linkest_samples(uint16_t id)
+{
+  int i = lookup(id);
+
+  return i < 0 ? 0 : table[i].samples;
+}
+/*---------------------------------------------------------------------------*/
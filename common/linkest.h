@@ -0,0 +1,123 @@
+/*
+ * Copyright (c) 2015, Computer Science Department (CSD), University of Crete, and 
+ * Signal Processing Lab (SPL), Institute of Computer Science (ICS), FORTH, Greece.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of CSD, SPL/ICS-FORTH nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * 
+ */
+
+/**
+ * \file
+ *         Link weights from the measured RSSI, as an alternative to the
+ *         positions written on the serial line.
+ *
+ *         With LINKEST_CONF_WEIGHT set to LINKEST_RSSI, a node keeps an
+ *         exponentially weighted moving average of the RSSI of the beacons
+ *         of each neighbour, and maps it to the squared distance that the
+ *         power levels of power.h are given for: the distance at which the
+ *         UDGM signal model (full power, LINKEST_RANGE meters, from
+ *         LINKEST_SS_STRONG dBm at zero distance down to LINKEST_SS_WEAK dBm
+ *         at the range) gives that RSSI. The weights, and the power levels
+ *         picked from them, are then those of the links the radios measure.
+ *         Every discovery beacon is sent LINKEST_BEACONS times, for several
+ *         samples per neighbour.
+ *
+ *         LINKEST_POSITION (the default) keeps the squared distances of the
+ *         positions, and a single beacon.
+ */
+
+#ifndef LINKEST_H_
+#define LINKEST_H_
+
+#include <stdint.h>
+
+#define LINKEST_POSITION 0
+#define LINKEST_RSSI     1
+
+#ifdef LINKEST_CONF_WEIGHT
+#define LINKEST_WEIGHT LINKEST_CONF_WEIGHT
+#else
+#define LINKEST_WEIGHT LINKEST_POSITION
+#endif
+
+/* beacons per discovery slot */
+#ifdef LINKEST_CONF_BEACONS
+#define LINKEST_BEACONS LINKEST_CONF_BEACONS
+#elif LINKEST_WEIGHT == LINKEST_RSSI
+#define LINKEST_BEACONS 3
+#else
+#define LINKEST_BEACONS 1
+#endif
+
+/* neighbours followed */
+#ifdef LINKEST_CONF_SIZE
+#define LINKEST_SIZE LINKEST_CONF_SIZE
+#else
+#define LINKEST_SIZE 30
+#endif
+
+/* weight of a new sample in the average: 1 / 2^LINKEST_EWMA_SHIFT */
+#define LINKEST_EWMA_SHIFT 2
+
+/* the signal model the RSSI is mapped with (meters, dBm) */
+#ifdef LINKEST_CONF_RANGE
+#define LINKEST_RANGE LINKEST_CONF_RANGE
+#else
+#define LINKEST_RANGE 15.0
+#endif
+#ifdef LINKEST_CONF_SS_STRONG
+#define LINKEST_SS_STRONG LINKEST_CONF_SS_STRONG
+#else
+#define LINKEST_SS_STRONG -10.0
+#endif
+#ifdef LINKEST_CONF_SS_WEAK
+#define LINKEST_SS_WEAK LINKEST_CONF_SS_WEAK
+#else
+#define LINKEST_SS_WEAK -95.0
+#endif
+
+/* the squared distance (m^2) of an RSSI (dBm) */
+#define LINKEST_DISQR(_dbm) ((_dbm) >= LINKEST_SS_STRONG ? 0.0f : \
+  (float)(LINKEST_RANGE * ((_dbm) - LINKEST_SS_STRONG) / (LINKEST_SS_WEAK - LINKEST_SS_STRONG)) * \
+  (float)(LINKEST_RANGE * ((_dbm) - LINKEST_SS_STRONG) / (LINKEST_SS_WEAK - LINKEST_SS_STRONG)))
+
+/* forgets every neighbour */
+void linkest_init(void);
+
+/* adds an RSSI sample (dBm) of neighbour id; returns 0 if the table is full */
+int linkest_sample(uint16_t id, int16_t dbm);
+
+/* the average RSSI (dBm) of neighbour id, LINKEST_SS_WEAK if never heard */
+float linkest_rssi(uint16_t id);
+
+/* the squared distance of neighbour id, from its average RSSI */
+float linkest_weight(uint16_t id);
+
+/* samples of neighbour id (saturates at 255) */
+uint8_t linkest_samples(uint16_t id);
+
+#endif /* LINKEST_H_ */
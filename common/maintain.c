@@ -0,0 +1,232 @@
+/*
+ * Copyright (c) 2015, Computer Science Department (CSD), University of Crete, and 
+ * Signal Processing Lab (SPL), Institute of Computer Science (ICS), FORTH, Greece.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of CSD, SPL/ICS-FORTH nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * 
+ */
+
+/**
+ * \file
+ *         Topology maintenance (see maintain.h).
+ *
+ *         Deadlines are in seconds (clock_seconds()), as the longest
+ *         intervals overflow a 16-bit clock_time_t once multiplied. Two
+ *         beacons of a sender whose interval doubled in between are less
+ *         than 3 of its intervals apart, hence the deadline.
+ */
+
+#include <string.h>
+
+#include "maintain.h"
+#include "linkest.h"
+#include "random.h"
+
+#if MAINTAIN_ENABLED
+
+static struct maintain_neighbor table[MAINTAIN_SIZE];
+static uint8_t count;
+
+/* the interval, as doublings of MAINTAIN_IMIN, and the send time in it */
+static uint8_t doublings;
+static clock_time_t send_time;
+
+/*---------------------------------------------------------------------------*/
+static unsigned long
+deadline(uint8_t d)
+{
+  return clock_seconds() + 1 +
+    MAINTAIN_MISSED * 3 * ((unsigned long)MAINTAIN_IMIN << d) / CLOCK_SECOND;
+}
+/*---------------------------------------------------------------------------*/
+static void
+pick(void)
+{
+  clock_time_t i = maintain_interval();
+
+  send_time = i / 2 + random_rand() % (i - i / 2);
+}
+/*---------------------------------------------------------------------------*/
+void
+maintain_init(void)
+{
+  count = 0;
+  maintain_reset();
+}
+/*---------------------------------------------------------------------------*/
+static int
+find(uint16_t id)
+{
+  uint8_t i;
+
+  for(i = 0; i < count; ++i) {
+    if(table[i].id == id) {
+      return i;
+    }
+  }
+  return -1;
+}
+/*---------------------------------------------------------------------------*/
+int
+maintain_add(uint16_t id, float x, float y)
+{
+  int i = find(id);
+
+  if(i < 0) {
+    if(count == MAINTAIN_SIZE) {
+      return 0;
+    }
+    i = count++;
+  }
+  table[i].id = id;
+  table[i].x = x;
+  table[i].y = y;
+  table[i].deadline = deadline(0);
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+void
+maintain_start(void)
+{
+  uint8_t i;
+
+  for(i = 0; i < count; ++i) {
+    table[i].deadline = deadline(0);
+  }
+  maintain_reset();
+}
+/*---------------------------------------------------------------------------*/
+void
+maintain_reset(void)
+{
+  doublings = 0;
+  pick();
+}
+/*---------------------------------------------------------------------------*/
+void
+maintain_double(void)
+{
+  if(doublings < MAINTAIN_DOUBLINGS) {
+    doublings++;
+  }
+  pick();
+}
+/*---------------------------------------------------------------------------*/
+clock_time_t
+maintain_interval(void)
+{
+  return (clock_time_t)MAINTAIN_IMIN << doublings;
+}
+/*---------------------------------------------------------------------------*/
+clock_time_t
+maintain_send_time(void)
+{
+  return send_time;
+}
+/*---------------------------------------------------------------------------*/
+uint8_t
+maintain_beacon(uint8_t *buf, float x, float y)
+{
+  buf[0] = MAINTAIN_BEACON;
+  buf[1] = doublings;
+  memcpy(buf + 2, &x, sizeof(float));
+  memcpy(buf + 2 + sizeof(float), &y, sizeof(float));
+  return MAINTAIN_HEADER;
+}
+/*---------------------------------------------------------------------------*/
+int
+maintain_heard(uint16_t id, const uint8_t *buf, uint16_t len)
+{
+  float x, y;
+  int i, r = MAINTAIN_SAME;
+
+  if(len < MAINTAIN_HEADER || buf[0] != MAINTAIN_BEACON || buf[1] > MAINTAIN_DOUBLINGS) {
+    return MAINTAIN_IGNORED;
+  }
+  memcpy(&x, buf + 2, sizeof(float));
+  memcpy(&y, buf + 2 + sizeof(float), sizeof(float));
+  i = find(id);
+  if(i < 0) {
+    if(count == MAINTAIN_SIZE) {
+      return MAINTAIN_IGNORED;
+    }
+    i = count++;
+    table[i].id = id;
+    r = MAINTAIN_NEW;
+#if LINKEST_WEIGHT == LINKEST_POSITION
+  } else if((x - table[i].x) * (x - table[i].x) + (y - table[i].y) * (y - table[i].y) >= MAINTAIN_DRIFT) {
+    /* the weights come from the positions only in this mode */
+    r = MAINTAIN_MOVED;
+#endif
+  }
+  table[i].x = x;
+  table[i].y = y;
+  table[i].deadline = deadline(buf[1]);
+  return r;
+}
+/*---------------------------------------------------------------------------*/
+const struct maintain_neighbor *
+maintain_neighbor(uint16_t id)
+{
+  int i = find(id);
+
+  return i < 0 ? NULL : &table[i];
+}
+/*---------------------------------------------------------------------------*/
+uint8_t
+maintain_count(void)
+{
+  return count;
+}
+/*---------------------------------------------------------------------------*/
+const struct maintain_neighbor *
+maintain_entry(uint8_t i)
+{
+  return &table[i];
+}
+/*---------------------------------------------------------------------------*/
+uint8_t
+maintain_expire(void (* expired)(uint16_t id))
+{
+  unsigned long now = clock_seconds();
+  uint8_t i, n = 0;
+
+  for(i = 0; i < count;) {
+    if((long)(now - table[i].deadline) > 0) {
+      if(expired != NULL) {
+        expired(table[i].id);
+      }
+      table[i] = table[--count];
+      n++;
+    } else {
+      ++i;
+    }
+  }
+  return n;
+}
+/*---------------------------------------------------------------------------*/
+#endif /* MAINTAIN_ENABLED */
@@ -0,0 +1,148 @@
+/*
+ * Copyright (c) 2015, Computer Science Department (CSD), University of Crete, and 
+ * Signal Processing Lab (SPL), Institute of Computer Science (ICS), FORTH, Greece.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of CSD, SPL/ICS-FORTH nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * 
+ */
+
+/**
+ * \file
+ *         Topology maintenance after the first computation: Trickle-paced
+ *         beacons and soft-state neighbours.
+ *
+ *         With MAINTAIN_CONF_ENABLED, the firmware does not stop once it is
+ *         DONE. Every node keeps beaconing its position (LMST adds its 1-hop
+ *         table), once per Trickle interval, at a random time in its second
+ *         half. The interval starts at MAINTAIN_IMIN and doubles, up to
+ *         MAINTAIN_DOUBLINGS times, while the neighbourhood stays the same;
+ *         a change brings it back to MAINTAIN_IMIN. There is no suppression:
+ *         the beacons are what keeps a node alive at its neighbours.
+ *
+ *         Every beacon carries the interval of its sender, and a neighbour
+ *         whose MAINTAIN_MISSED next beacons did not come is expired. A new
+ *         neighbour, one that moved or one that expired is a change, and
+ *         the node computes again at the end of the interval; a stable
+ *         network only pays for its beacons, further and further apart.
+ */
+
+#ifndef MAINTAIN_H_
+#define MAINTAIN_H_
+
+#include "contiki.h"
+
+#ifdef MAINTAIN_CONF_ENABLED
+#define MAINTAIN_ENABLED MAINTAIN_CONF_ENABLED
+#else
+#define MAINTAIN_ENABLED 0
+#endif
+
+/* shortest interval (ticks), and doublings up to the longest one */
+#ifdef MAINTAIN_CONF_IMIN
+#define MAINTAIN_IMIN MAINTAIN_CONF_IMIN
+#else
+#define MAINTAIN_IMIN (4 * CLOCK_SECOND)
+#endif
+
+#ifdef MAINTAIN_CONF_DOUBLINGS
+#define MAINTAIN_DOUBLINGS MAINTAIN_CONF_DOUBLINGS
+#else
+#define MAINTAIN_DOUBLINGS 6
+#endif
+
+/* beacons of a neighbour missed before it expires */
+#ifdef MAINTAIN_CONF_MISSED
+#define MAINTAIN_MISSED MAINTAIN_CONF_MISSED
+#else
+#define MAINTAIN_MISSED 3
+#endif
+
+/* neighbours followed */
+#ifdef MAINTAIN_CONF_SIZE
+#define MAINTAIN_SIZE MAINTAIN_CONF_SIZE
+#else
+#define MAINTAIN_SIZE 20
+#endif
+
+/* squared distance (m^2) a neighbour must move to be a change */
+#ifdef MAINTAIN_CONF_DRIFT
+#define MAINTAIN_DRIFT MAINTAIN_CONF_DRIFT
+#else
+#define MAINTAIN_DRIFT 1.0
+#endif
+
+/* first byte of a beacon; bytes of its header: the first byte, the
+   doublings of the interval of the sender and its position */
+#define MAINTAIN_BEACON 'M'
+#define MAINTAIN_HEADER (2 + 2 * sizeof(float))
+
+/* what a beacon says about its sender (maintain_heard) */
+enum { MAINTAIN_SAME, MAINTAIN_NEW, MAINTAIN_MOVED, MAINTAIN_IGNORED };
+
+struct maintain_neighbor {
+  uint16_t id;
+  float x, y;
+  /* clock_seconds() after which it is expired */
+  unsigned long deadline;
+};
+
+/* forgets the neighbours; the interval is MAINTAIN_IMIN */
+void maintain_init(void);
+
+/* a neighbour found by the discovery; returns 0 if the table is full */
+int maintain_add(uint16_t id, float x, float y);
+
+/* the maintenance starts: every neighbour is taken as heard now, and the
+   interval is MAINTAIN_IMIN */
+void maintain_start(void);
+
+/* the interval: back to MAINTAIN_IMIN, or doubled; a new send time is
+   picked in its second half */
+void maintain_reset(void);
+void maintain_double(void);
+clock_time_t maintain_interval(void);
+clock_time_t maintain_send_time(void);
+
+/* writes the header of the beacon of the node at (x, y) into buf; returns
+   MAINTAIN_HEADER */
+uint8_t maintain_beacon(uint8_t *buf, float x, float y);
+
+/* a beacon (MAINTAIN_BEACON) of node id is buf[0..len): the sender is
+   alive; returns MAINTAIN_NEW or MAINTAIN_MOVED (a change),
+   MAINTAIN_SAME, or MAINTAIN_IGNORED (not a beacon, or the table is full) */
+int maintain_heard(uint16_t id, const uint8_t *buf, uint16_t len);
+
+/* the neighbour id, NULL if unknown */
+const struct maintain_neighbor *maintain_neighbor(uint16_t id);
+uint8_t maintain_count(void);
+const struct maintain_neighbor *maintain_entry(uint8_t i);
+
+/* removes the neighbours past their deadline, calling expired (unless
+   NULL) with each; returns their number */
+uint8_t maintain_expire(void (* expired)(uint16_t id));
+
+#endif /* MAINTAIN_H_ */
@@ -0,0 +1,68 @@
+/*
+ * Copyright (c) 2015, Computer Science Department (CSD), University of Crete, and 
+ * Signal Processing Lab (SPL), Institute of Computer Science (ICS), FORTH, Greece.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of CSD, SPL/ICS-FORTH nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * 
+ */
+
+/**
+ * \file
+ *         Positions of the motes (see position.h).
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "position.h"
+
+/*---------------------------------------------------------------------------*/
+float
+str2float(char *str)
+{
+  float r, num;
+  char *s, *a, b[4] = { '0', '0', '0', '\0' };
+  int i;
+
+  if(str == NULL) {
+    return 0;
+  }
+  s = strdup(str);
+  a = strtok(s, ".");
+  num = atoi(a);
+  r = num;
+  a = strtok(NULL, ".");
+  /* keep up to three decimals, right-padded with zeros ("5.5" is 5.500) */
+  for(i = 0; a && i < 3 && a[i] >= '0' && a[i] <= '9'; ++i) {
+    b[i] = a[i];
+  }
+  num = atoi(b);
+  r += ((r < 0 || s[0] == '-') ? -(num / 1000) : (num / 1000));
+  free(s);
+  return r;
+}
+/*---------------------------------------------------------------------------*/
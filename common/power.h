@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2015, Computer Science Department (CSD), University of Crete, and 
+ * Signal Processing Lab (SPL), Institute of Computer Science (ICS), FORTH, Greece.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of CSD, SPL/ICS-FORTH nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * 
+ */
+
+/**
+ * \file
+ *         Transmission power selection for the CC2420: the squared distance a
+ *         power level reaches, and the least power level that reaches a
+ *         squared distance.
+ *
+ *         The reference table is for the Cooja UDGM with a 15m transmission
+ *         range at full power, where the range scales linearly with the
+ *         power level (3, 7, ..., 31). With CALIBRATE_CONF_ENABLED the
+ *         table is in RAM, and fitted to the measured links at runtime (see
+ *         calibrate.h).
+ */
+
+#ifndef POWER_H_
+#define POWER_H_
+
+#include <stdint.h>
+#include "contiki-conf.h"
+
+#define POWER_LEVELS 8
+
+/* squared distance (m^2) reached by CC2420 power level 3 + 4 * i */
+#if CALIBRATE_CONF_ENABLED
+extern float POWER[POWER_LEVELS];
+#else
+extern const float POWER[POWER_LEVELS];
+#endif
+
+/* CC2420 power level of table index i */
+#define POWER_LEVEL(_i) (3 + 4 * (_i))
+
+/*
+ * Index of the least power level that reaches a squared distance dis, i.e.,
+ * the first i where POWER[i] > dis, or the full power index if none does.
+ * Written as a sum of comparisons, so that loops over many distances
+ * vectorize.
+ */
+#define POWER_INDEX(_dis) ((POWER[0] <= (_dis)) + (POWER[1] <= (_dis)) + \
+                           (POWER[2] <= (_dis)) + (POWER[3] <= (_dis)) + \
+                           (POWER[4] <= (_dis)) + (POWER[5] <= (_dis)) + \
+                           (POWER[6] <= (_dis)))
+
+/* The least CC2420 power level (3..31) that reaches squared distance dis */
+uint8_t power_level(float dis);
+
+#endif /* POWER_H_ */
@@ -0,0 +1,133 @@
+/*
+ * Copyright (c) 2015, Computer Science Department (CSD), University of Crete, and 
+ * Signal Processing Lab (SPL), Institute of Computer Science (ICS), FORTH, Greece.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of CSD, SPL/ICS-FORTH nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * 
+ */
+
+/**
+ * \file
+ *         Per-phase profiling (see profile.h).
+ */
+
+#include "profile.h"
+
+#if PROFILE_ENABLED
+
+#include <string.h>
+
+#include "telemetry.h"
+
+struct phase {
+  uint16_t count;
+  profile_time_t min, max;
+  uint32_t total;
+};
+
+profile_time_t profile_start[PROFILE_PHASES];
+static struct phase phases[PROFILE_PHASES];
+/*---------------------------------------------------------------------------*/
+void
+profile_add(uint8_t phase, profile_time_t ticks)
+{
+  struct phase *p = &phases[phase];
+
+  if(p->count == 0 || ticks < p->min) {
+    p->min = ticks;
+  }
+  if(ticks > p->max) {
+    p->max = ticks;
+  }
+  p->total += ticks;
+  p->count++;
+}
+/*---------------------------------------------------------------------------*/
+uint16_t
+profile_count(uint8_t phase)
+{
+  return phases[phase].count;
+}
+/*---------------------------------------------------------------------------*/
+uint32_t
+profile_total(uint8_t phase)
+{
+  return phases[phase].total;
+}
+/*---------------------------------------------------------------------------*/
+void
+profile_reset(void)
+{
+  memset(phases, 0, sizeof(phases));
+}
+/*---------------------------------------------------------------------------*/
+/* a tick count in the 16 bits of the report (a wider PROFILE_CONF_TIME may exceed them) */
+static uint16_t
+saturate(uint32_t ticks)
+{
+  return ticks > 0xffff ? 0xffff : ticks;
+}
+/*---------------------------------------------------------------------------*/
+void
+profile_report(void)
+{
+  /* as many phases as one record holds: more take more records */
+  uint8_t buf[TELEMETRY_MAX_DATA / PROFILE_RECORD * PROFILE_RECORD], *b = buf;
+  uint16_t min, max;
+  uint8_t i, sent = 0;
+
+  /* phases that ran, PROFILE_RECORD bytes each, big-endian */
+  for(i = 0; i < PROFILE_PHASES; ++i) {
+    if(phases[i].count == 0) {
+      continue;
+    }
+    min = saturate(phases[i].min);
+    max = saturate(phases[i].max);
+    *b++ = i;
+    *b++ = phases[i].count >> 8;
+    *b++ = phases[i].count;
+    *b++ = min >> 8;
+    *b++ = min;
+    *b++ = max >> 8;
+    *b++ = max;
+    *b++ = phases[i].total >> 24;
+    *b++ = phases[i].total >> 16;
+    *b++ = phases[i].total >> 8;
+    *b++ = phases[i].total;
+    if(b == buf + sizeof(buf)) {
+      telemetry_data(TELEMETRY_PROFILE, buf, b - buf);
+      b = buf;
+      sent = 1;
+    }
+  }
+  /* the rest, or an empty record if no phase ran */
+  if(b > buf || !sent) {
+    telemetry_data(TELEMETRY_PROFILE, buf, b - buf);
+  }
+}
+/*---------------------------------------------------------------------------*/
+#endif /* PROFILE_ENABLED */
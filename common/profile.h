@@ -0,0 +1,124 @@
+/*
+ * Copyright (c) 2015, Computer Science Department (CSD), University of Crete, and 
+ * Signal Processing Lab (SPL), Institute of Computer Science (ICS), FORTH, Greece.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of CSD, SPL/ICS-FORTH nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * 
+ */
+
+/**
+ * \file
+ *         Per-phase profiling of the computation of a mote, in rtimer ticks
+ *         (RTIMER_SECOND per second, 32768 on the Z1 and the Sky).
+ *
+ *         PROFILE_BEGIN(phase) and PROFILE_END(phase) wrap a piece of code;
+ *         every BEGIN/END pair adds one sample to the count, min, max and
+ *         total of the phase. A BEGIN without an END (e.g., an error return
+ *         in between) is dropped by the next BEGIN of the phase. A sample
+ *         must be shorter than the rtimer wraps (2 s on the Z1).
+ *         PROFILE_REPORT() emits the phases that ran as telemetry records, as
+ *         many phases per record as fit in TELEMETRY_MAX_DATA.
+ *
+ *         Profiling is compiled in with PROFILE_CONF_ENABLED (project-conf.h);
+ *         otherwise the macros expand to nothing. PROFILE_CONF_NOW may give
+ *         a finer timer than RTIMER_NOW(), of type PROFILE_CONF_TIME
+ *         (rtimer_clock_t by default); if it is wider than 16 bits, the
+ *         min and max of the report saturate at 16 bits.
+ */
+
+#ifndef PROFILE_H_
+#define PROFILE_H_
+
+#include "contiki.h"
+
+#ifdef PROFILE_CONF_ENABLED
+#define PROFILE_ENABLED PROFILE_CONF_ENABLED
+#else
+#define PROFILE_ENABLED 0
+#endif
+
+#ifdef PROFILE_CONF_NOW
+#define PROFILE_NOW() PROFILE_CONF_NOW()
+#else
+#define PROFILE_NOW() RTIMER_NOW()
+#endif
+
+#ifdef PROFILE_CONF_TIME
+typedef PROFILE_CONF_TIME profile_time_t;
+#else
+typedef rtimer_clock_t profile_time_t;
+#endif
+
+/* Phases */
+enum {
+  PROFILE_DISCOVERY,        /* handling of a received beacon */
+  PROFILE_INITIALIZE,       /* LMST: graph of the 1-hop neighbourhood */
+  PROFILE_PRIM,             /* LMST: Prim's algorithm */
+  PROFILE_DELAUNAY,         /* REDELCA: delaunay() */
+  PROFILE_LEGALIZE,         /* REDELCA: edge legalization, per inserted point */
+  PROFILE_NEIGHBORS,        /* REDELCA: Delaunay neighbours of the node */
+  PROFILE_PATH,             /* REDELCA: least power path to a neighbour */
+  PROFILE_POWER,            /* transmission power selection */
+  PROFILE_REPAIR,           /* LMST: incremental update of the local MST */
+  PROFILE_XTC,              /* LMST: XTC mode, the kept neighbours */
+  PROFILE_CONE,             /* CBTC: cone condition, shrink-back and pairwise removal */
+  PROFILE_KFOREST,          /* LMST: the k edge-disjoint forests of the k-LMST */
+  PROFILE_PHASES
+};
+
+/* The names of the phases, for decoders */
+#define PROFILE_NAMES { "DISCOVERY", "INITIALIZE", "PRIM", "DELAUNAY", \
+                        "LEGALIZE", "NEIGHBORS", "PATH", "POWER", "REPAIR", "XTC", "CONE", "KFOREST" }
+
+/* Bytes per phase in the PROFILE record: phase, count (2), min (2), max (2), total (4) */
+#define PROFILE_RECORD 11
+
+#if PROFILE_ENABLED
+
+extern profile_time_t profile_start[PROFILE_PHASES];
+
+void profile_add(uint8_t phase, profile_time_t ticks);
+void profile_report(void);
+
+/* samples and total ticks of a phase so far, and a restart of all phases */
+uint16_t profile_count(uint8_t phase);
+uint32_t profile_total(uint8_t phase);
+void profile_reset(void);
+
+#define PROFILE_BEGIN(_p) (profile_start[_p] = PROFILE_NOW())
+#define PROFILE_END(_p)   profile_add((_p), (profile_time_t)(PROFILE_NOW() - profile_start[_p]))
+#define PROFILE_REPORT()  profile_report()
+
+#else /* PROFILE_ENABLED */
+
+#define PROFILE_BEGIN(_p)
+#define PROFILE_END(_p)
+#define PROFILE_REPORT()
+
+#endif /* PROFILE_ENABLED */
+
+#endif /* PROFILE_H_ */
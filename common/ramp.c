@@ -0,0 +1,146 @@
+/*
+ * Copyright (c) 2015, Computer Science Department (CSD), University of Crete, and 
+ * Signal Processing Lab (SPL), Institute of Computer Science (ICS), FORTH, Greece.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of CSD, SPL/ICS-FORTH nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * 
+ */
+
+/**
+ * \file
+ *         Ramped 1-hop discovery (see ramp.h).
+ *
+ *         The direction of a neighbour is kept in 1/256 of a turn, sorted,
+ *         so that the gaps between neighbours are the differences of
+ *         consecutive ones. A full table stops the ramp, and the node keeps
+ *         no more neighbours: those it has are the nearest ones, as far as the
+ *         ramp tells.
+ */
+
+#include <math.h>
+
+#include "ramp.h"
+#include "linkest.h"
+
+#if RAMP_ENABLED
+
+#if LINKEST_WEIGHT == LINKEST_RSSI
+#error "the ramped discovery needs the positions (LINKEST_CONF_WEIGHT)"
+#endif
+
+#define TURN 256
+#define CONE ((uint16_t)RAMP_CONE * TURN / 360)
+#define RADIAN (TURN / (2 * 3.14159265))
+
+static uint8_t ids[RAMP_SIZE], directions[RAMP_SIZE];
+static uint8_t count;
+static float myx, myy;
+
+/* the level of the node: of its last beacon, or of the one of this phase */
+static uint8_t reach;
+
+/*---------------------------------------------------------------------------*/
+void
+ramp_init(float x, float y)
+{
+  myx = x;
+  myy = y;
+  count = reach = 0;
+}
+/*---------------------------------------------------------------------------*/
+uint8_t
+ramp_level(uint8_t r)
+{
+  if(ramp_covered()) {
+    return 0;
+  }
+  r *= RAMP_STEP;
+  reach = POWER_LEVEL(r < POWER_LEVELS - 1 ? r : POWER_LEVELS - 1);
+  return reach;
+}
+/*---------------------------------------------------------------------------*/
+uint8_t
+ramp_neighbor(uint16_t id)
+{
+  uint8_t i;
+
+  for(i = 0; i < count && ids[i] != (id & 0xff); ++i);
+  return i < count;
+}
+/*---------------------------------------------------------------------------*/
+uint8_t
+ramp_heard(uint16_t id, float x, float y)
+{
+  uint8_t i, d;
+
+  if(ramp_neighbor(id) || count == RAMP_SIZE ||
+     power_level((x - myx) * (x - myx) + (y - myy) * (y - myy)) > reach) {
+    return 0;
+  }
+  d = (uint8_t)(int)floor(atan2(y - myy, x - myx) * RADIAN);
+  for(i = count; i > 0 && directions[i - 1] > d; --i) {
+    ids[i] = ids[i - 1];
+    directions[i] = directions[i - 1];
+  }
+  ids[i] = id;
+  directions[i] = d;
+  ++count;
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+uint8_t
+ramp_covered(void)
+{
+#if RAMP_MODE != RAMP_DEGREE_MODE
+  uint8_t i;
+#endif
+
+  if(count == RAMP_SIZE) {
+    return 1;
+  }
+#if RAMP_MODE == RAMP_DEGREE_MODE
+  return count >= RAMP_DEGREE;
+#else
+  if(count < 2 || directions[0] + TURN - directions[count - 1] > CONE) {
+    return 0;
+  }
+  for(i = 1; i < count; ++i) {
+    if(directions[i] - directions[i - 1] > CONE) {
+      return 0;
+    }
+  }
+  return 1;
+#endif
+}
+/*---------------------------------------------------------------------------*/
+uint8_t
+ramp_reach(void)
+{
+  return reach;
+}
+/*---------------------------------------------------------------------------*/
+#endif /* RAMP_ENABLED */
@@ -0,0 +1,142 @@
+/*
+ * Copyright (c) 2015, Computer Science Department (CSD), University of Crete, and 
+ * Signal Processing Lab (SPL), Institute of Computer Science (ICS), FORTH, Greece.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of CSD, SPL/ICS-FORTH nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * 
+ */
+
+/**
+ * \file
+ *         Ramped 1-hop discovery: the position beacons start at the lowest
+ *         power level and go up only until the neighbours heard cover the
+ *         node.
+ *
+ *         With RAMP_CONF_ENABLED, the position discovery is RAMP_ROUNDS
+ *         phases of RAMP_PHASE instead of one. In phase r a node that is
+ *         not covered yet beacons its position at the r-th level of the
+ *         ramp, RAMP_STEP power levels above the one before; it is covered
+ *         once its neighbours leave no angular gap wider than RAMP_CONE
+ *         around it (RAMP_CONE_MODE, the cone condition of CBTC), or once
+ *         it has RAMP_DEGREE of them (RAMP_DEGREE_MODE), or when its table
+ *         is full, and it stays at its level from then on.
+ *
+ *         A node keeps a neighbour only if its own level reaches it (by the
+ *         power table): as the nodes ramp in step, a node that hears a
+ *         neighbour it reaches was heard by it too, and the links are
+ *         symmetric without replies. This is the symmetric subgraph of
+ *         CBTC, which keeps the network connected for RAMP_CONE <= 120.
+ *         The neighbour tables, the computation and the beacons then grow
+ *         with the degree the condition needs, not with the density of the
+ *         field; the discovery listens for RAMP_ROUNDS windows instead of
+ *         one.
+ *
+ *         The beacons carry the position of their sender: the link
+ *         estimation from the RSSI (LINKEST_CONF_WEIGHT) does not work
+ *         with it.
+ */
+
+#ifndef RAMP_H_
+#define RAMP_H_
+
+#include "contiki.h"
+#include "power.h"
+
+#ifdef RAMP_CONF_ENABLED
+#define RAMP_ENABLED RAMP_CONF_ENABLED
+#else
+#define RAMP_ENABLED 0
+#endif
+
+/* coverage conditions */
+#define RAMP_CONE_MODE   0
+#define RAMP_DEGREE_MODE 1
+
+#ifdef RAMP_CONF_MODE
+#define RAMP_MODE RAMP_CONF_MODE
+#else
+#define RAMP_MODE RAMP_CONE_MODE
+#endif
+
+/* widest angular gap between neighbours (degrees), and least degree */
+#ifdef RAMP_CONF_CONE
+#define RAMP_CONE RAMP_CONF_CONE
+#else
+#define RAMP_CONE 120
+#endif
+
+#ifdef RAMP_CONF_DEGREE
+#define RAMP_DEGREE RAMP_CONF_DEGREE
+#else
+#define RAMP_DEGREE 6
+#endif
+
+/* neighbours followed */
+#ifdef RAMP_CONF_SIZE
+#define RAMP_SIZE RAMP_CONF_SIZE
+#else
+#define RAMP_SIZE 20
+#endif
+
+/* power levels (of the table, see power.h) between two phases */
+#ifdef RAMP_CONF_STEP
+#define RAMP_STEP RAMP_CONF_STEP
+#else
+#define RAMP_STEP 1
+#endif
+
+/* length of each phase (ticks), and the phases, up to full power */
+#ifdef RAMP_CONF_PHASE
+#define RAMP_PHASE RAMP_CONF_PHASE
+#else
+#define RAMP_PHASE (10 * CLOCK_SECOND)
+#endif
+
+#define RAMP_ROUNDS ((POWER_LEVELS + RAMP_STEP - 2) / RAMP_STEP + 1)
+
+/* forgets the neighbours heard; the node is at (x, y) */
+void ramp_init(float x, float y);
+
+/* phase r (0..RAMP_ROUNDS - 1) starts: returns the CC2420 power level of
+   the beacon of the node in it, 0 for none */
+uint8_t ramp_level(uint8_t r);
+
+/* the position beacon of node id, at (x, y), was heard; returns 1 if the
+   node is a new neighbour, 0 if it is known or the node does not reach
+   it */
+uint8_t ramp_heard(uint16_t id, float x, float y);
+
+/* node id is a neighbour kept */
+uint8_t ramp_neighbor(uint16_t id);
+
+/* the node is covered by its neighbours */
+uint8_t ramp_covered(void);
+
+/* the level of the node, which reaches all its neighbours */
+uint8_t ramp_reach(void);
+
+#endif /* RAMP_H_ */
@@ -0,0 +1,199 @@
+/*
+ * Copyright (c) 2015, Computer Science Department (CSD), University of Crete, and 
+ * Signal Processing Lab (SPL), Institute of Computer Science (ICS), FORTH, Greece.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of CSD, SPL/ICS-FORTH nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * 
+ */
+
+/**
+ * \file
+ *         Rendezvous windows (see rendezvous.h).
+ */
+
+#include "rendezvous.h"
+#include "net/netstack.h"
+
+/* the next step of the phase */
+static enum { IDLE, OPEN, SEND, CLOSE, END } step;
+static clock_time_t start, length;
+static uint8_t slot, started;
+static struct process *client;
+static struct etimer timer;
+
+PROCESS(rendezvous_process, "Rendezvous");
+/*---------------------------------------------------------------------------*/
+/* ticks until t, 0 if t is past */
+static clock_time_t
+until(clock_time_t t)
+{
+  clock_time_t d = t - clock_time();
+
+  return d > ((clock_time_t)~0 >> 1) ? 0 : d;
+}
+/*---------------------------------------------------------------------------*/
+static clock_time_t
+instant(void)
+{
+  switch(step) {
+  case OPEN:
+    return start;
+  case SEND:
+    return start + RENDEZVOUS_GUARD + slot * RENDEZVOUS_SLOT;
+  case CLOSE:
+    return start + RENDEZVOUS_WINDOW;
+  default:
+    return start + length;
+  }
+}
+/*---------------------------------------------------------------------------*/
+void
+rendezvous_init(void)
+{
+  step = IDLE;
+  started = 0;
+  process_start(&rendezvous_process, NULL);
+  NETSTACK_RDC.off(0);
+}
+/*---------------------------------------------------------------------------*/
+void
+rendezvous_phase(clock_time_t len, uint8_t s)
+{
+  if(!started) {
+    started = 1;
+    start = clock_time();
+  } else {
+    start += length;
+  }
+  length = len;
+  slot = s;
+  step = slot == RENDEZVOUS_QUIET ? END : OPEN;
+  client = PROCESS_CURRENT();
+  process_poll(&rendezvous_process);
+}
+/*---------------------------------------------------------------------------*/
+int
+rendezvous_slot(void)
+{
+  return step != OPEN && step != SEND;
+}
+/*---------------------------------------------------------------------------*/
+int
+rendezvous_ended(void)
+{
+  return step == IDLE;
+}
+/*---------------------------------------------------------------------------*/
+int
+rendezvous_send(struct broadcast_conn *c)
+{
+  uint8_t *b = packetbuf_dataptr();
+  uint16_t len = packetbuf_datalen();
+  /* outside of a phase (e.g., the maintenance beacons) the trailer is
+     0xffff, which no receiver follows */
+  clock_time_t left = step == IDLE ? 0xffff : until(start + length);
+
+  b[len] = left >> 8;
+  b[len + 1] = left;
+  packetbuf_set_datalen(len + RENDEZVOUS_TRAILER);
+  return broadcast_send(c);
+}
+/*---------------------------------------------------------------------------*/
+int
+rendezvous_recv(void)
+{
+  uint8_t *b = packetbuf_dataptr();
+  uint16_t len = packetbuf_datalen();
+  clock_time_t left, own;
+
+  if(len < RENDEZVOUS_TRAILER) {
+    return 0;
+  }
+  len -= RENDEZVOUS_TRAILER;
+  left = ((clock_time_t)b[len] << 8) | b[len + 1];
+  /* the payloads are parsed as strings */
+  b[len] = '\0';
+  packetbuf_set_datalen(len);
+
+  /* the sender's phase ends earlier: follow it */
+  if(step == SEND || step == CLOSE) {
+    own = until(start + length);
+    if(left + 1 < own) {
+      start -= own - left;
+      process_poll(&rendezvous_process);
+    }
+  }
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+void
+rendezvous_stop(void)
+{
+  step = IDLE;
+  etimer_stop(&timer);
+  NETSTACK_RDC.on();
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(rendezvous_process, ev, data)
+{
+  PROCESS_BEGIN();
+
+  while(1) {
+    PROCESS_WAIT_EVENT();
+    if(ev == PROCESS_EVENT_TIMER && data == &timer) {
+      switch(step) {
+      case OPEN:
+        NETSTACK_RDC.on();
+        step = SEND;
+        break;
+      case SEND:
+        step = CLOSE;
+        process_poll(client);
+        break;
+      case CLOSE:
+        NETSTACK_RDC.off(0);
+        step = END;
+        break;
+      case END:
+        step = IDLE;
+        process_poll(client);
+        break;
+      default:
+        break;
+      }
+    } else if(ev != PROCESS_EVENT_POLL) {
+      continue;
+    }
+    /* the next step, or the same one if the schedule moved */
+    if(step != IDLE) {
+      etimer_set(&timer, until(instant()));
+    }
+  }
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
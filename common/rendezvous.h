@@ -0,0 +1,114 @@
+/*
+ * Copyright (c) 2015, Computer Science Department (CSD), University of Crete, and 
+ * Signal Processing Lab (SPL), Institute of Computer Science (ICS), FORTH, Greece.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of CSD, SPL/ICS-FORTH nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * 
+ */
+
+/**
+ * \file
+ *         Rendezvous windows for the discovery and verification phases, so
+ *         that the motes may run a duty-cycled RDC (ContikiMAC) and keep
+ *         their radio off between phases.
+ *
+ *         A firmware runs as a sequence of phases of fixed length, each one
+ *         starting where the previous one ends. A phase opens with a window
+ *         of RENDEZVOUS_WINDOW ticks where the radio is on: a guard, then
+ *         RENDEZVOUS_SLOTS send slots of RENDEZVOUS_SLOT ticks, one of which
+ *         is the mote's (its id modulo RENDEZVOUS_SLOTS), then a guard. The
+ *         radio is off for the rest of the phase. A quiet phase (e.g., the
+ *         computation) has no window.
+ *
+ *         Every beacon carries a 2-byte trailer, the ticks left in the
+ *         phase of its sender. A mote that hears a sender whose phase ends
+ *         earlier than its own moves its schedule to the sender's, so the
+ *         windows of the network align on the earliest mote; motes must
+ *         start within a window of each other. rendezvous_send() adds the
+ *         trailer and rendezvous_recv() strips it, before the firmware looks
+ *         at the payload.
+ *
+ *         The firmware waits on rendezvous_slot() and rendezvous_ended()
+ *         with PROCESS_WAIT_UNTIL(); its process is polled at both.
+ */
+
+#ifndef RENDEZVOUS_H_
+#define RENDEZVOUS_H_
+
+#include "contiki.h"
+#include "net/rime.h"
+
+/* send slots per window, and slot length (ticks) */
+#ifdef RENDEZVOUS_CONF_SLOTS
+#define RENDEZVOUS_SLOTS RENDEZVOUS_CONF_SLOTS
+#else
+#define RENDEZVOUS_SLOTS 30
+#endif
+
+#ifdef RENDEZVOUS_CONF_SLOT
+#define RENDEZVOUS_SLOT RENDEZVOUS_CONF_SLOT
+#else
+#define RENDEZVOUS_SLOT (CLOCK_SECOND / 4)
+#endif
+
+/* listening before the first slot and after the last one (ticks) */
+#ifdef RENDEZVOUS_CONF_GUARD
+#define RENDEZVOUS_GUARD RENDEZVOUS_CONF_GUARD
+#else
+#define RENDEZVOUS_GUARD CLOCK_SECOND
+#endif
+
+#define RENDEZVOUS_WINDOW (2 * RENDEZVOUS_GUARD + RENDEZVOUS_SLOTS * RENDEZVOUS_SLOT)
+
+/* the slot of a quiet phase */
+#define RENDEZVOUS_QUIET 0xff
+
+/* bytes of the trailer of a beacon */
+#define RENDEZVOUS_TRAILER 2
+
+/* turns the radio off until the first phase; at boot */
+void rendezvous_init(void);
+
+/* starts the next phase, of length ticks, with the mote's send slot (or
+   RENDEZVOUS_QUIET); the first phase starts now */
+void rendezvous_phase(clock_time_t length, uint8_t slot);
+
+/* the send slot of the phase has come, the phase is over */
+int rendezvous_slot(void);
+int rendezvous_ended(void);
+
+/* broadcasts the packet buffer with the trailer */
+int rendezvous_send(struct broadcast_conn *c);
+
+/* strips the trailer of a received packet and follows the schedule of its
+   sender; returns 0 if the packet has no trailer */
+int rendezvous_recv(void);
+
+/* turns the radio back on (duty-cycled by the RDC), after the last phase */
+void rendezvous_stop(void);
+
+#endif /* RENDEZVOUS_H_ */
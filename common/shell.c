@@ -0,0 +1,142 @@
+/*
+ * Copyright (c) 2015, Computer Science Department (CSD), University of Crete, and 
+ * Signal Processing Lab (SPL), Institute of Computer Science (ICS), FORTH, Greece.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of CSD, SPL/ICS-FORTH nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * 
+ */
+
+/**
+ * \file
+ *         Serial line command interpreter (see shell.h).
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "dev/serial-line.h"
+#include "shell.h"
+#include "profile.h"
+#include "energy.h"
+
+static const struct shell_command *commands;
+
+PROCESS(shell_process, "Shell");
+/*---------------------------------------------------------------------------*/
+static void
+help(char *args)
+{
+  const struct shell_command *c;
+
+  SHELL_PRINTF("help: this list\n");
+  SHELL_PRINTF("prof: per-phase profile (PROFILE record)\n");
+  SHELL_PRINTF("energy: per-span energy (ENERGY record)\n");
+  for(c = commands; c->name != NULL; ++c) {
+    SHELL_PRINTF("%s: %s\n", c->name, c->help);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+prof(char *args)
+{
+#if PROFILE_ENABLED
+  PROFILE_REPORT();
+#else
+  SHELL_PRINTF("profiling is disabled (PROFILE_CONF_ENABLED)\n");
+#endif
+}
+/*---------------------------------------------------------------------------*/
+static void
+energy(char *args)
+{
+  energy_report();
+}
+/*---------------------------------------------------------------------------*/
+static const struct shell_command builtins[] = {
+  { "help", NULL, help },
+  { "prof", NULL, prof },
+  { "energy", NULL, energy },
+  { NULL, NULL, NULL }
+};
+/*---------------------------------------------------------------------------*/
+static void
+execute(char *line)
+{
+  const struct shell_command *c;
+  char *args;
+
+  args = line + strcspn(line, " ");
+  if(*args != '\0') {
+    *args++ = '\0';
+    args += strspn(args, " ");
+  }
+  for(c = builtins; c->name != NULL && strcmp(c->name, line) != 0; ++c);
+  if(c->name == NULL) {
+    for(c = commands; c->name != NULL && strcmp(c->name, line) != 0; ++c);
+  }
+  if(c->name == NULL) {
+    SHELL_PRINTF("%s: unknown command, try help\n", line);
+    return;
+  }
+  c->exec(args);
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(shell_process, ev, data)
+{
+  static char line[SHELL_LINE];
+
+  PROCESS_BEGIN();
+
+  while(1) {
+    PROCESS_YIELD_UNTIL(ev == serial_line_event_message);
+    if(shell_position(data)) {
+      continue;
+    }
+    strncpy(line, (char *)data + strspn((char *)data, " "), sizeof(line) - 1);
+    line[sizeof(line) - 1] = '\0';
+    line[strcspn(line, "\r\n")] = '\0';
+    if(line[0] != '\0') {
+      execute(line);
+    }
+  }
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
+int
+shell_position(const void *line)
+{
+  return strchr((const char *)line, '#') != NULL;
+}
+/*---------------------------------------------------------------------------*/
+void
+shell_init(const struct shell_command *c)
+{
+  commands = c;
+  process_start(&shell_process, NULL);
+}
+/*---------------------------------------------------------------------------*/
@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2015, Computer Science Department (CSD), University of Crete, and 
+ * Signal Processing Lab (SPL), Institute of Computer Science (ICS), FORTH, Greece.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of CSD, SPL/ICS-FORTH nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * 
+ */
+
+/**
+ * \file
+ *         A command interpreter on the serial line, to inspect a mote at
+ *         runtime without reflashing it.
+ *
+ *         Every line received on the serial line (serial_line_event_message)
+ *         is a command: its first word is looked up in the table the
+ *         firmware passes to shell_init(), and the rest of the line is
+ *         handed to the command. Lines with a '#' are positions (x#y) for
+ *         the firmware itself and are left alone; the firmware waits for
+ *         one with shell_position(), so a command sent before the position
+ *         is not taken for it.
+ *
+ *         Built-in commands: help, prof (PROFILE record, see profile.h) and
+ *         energy (ENERGY record, see energy.h). Replies are text lines that
+ *         start with SHELL_PREFIX, so that they can be told apart from the
+ *         telemetry frames; the records are sent as telemetry frames.
+ */
+
+#ifndef SHELL_H_
+#define SHELL_H_
+
+#include "contiki.h"
+
+#define SHELL_PREFIX "> "
+
+/* the longest command line; longer lines are cut */
+#define SHELL_LINE 40
+
+/* prints one reply line, printf-like; the format ends with "\n" */
+#define SHELL_PRINTF(...) do { printf(SHELL_PREFIX); printf(__VA_ARGS__); } while(0)
+
+struct shell_command {
+  const char *name;
+  const char *help;
+  /* args: the rest of the line after the name, without leading spaces */
+  void (*exec)(char *args);
+};
+
+/* starts the shell with the commands of the firmware, the last with a NULL name */
+void shell_init(const struct shell_command *commands);
+
+/* 1 if the data of a serial_line_event_message is a position (x#y) */
+int shell_position(const void *line);
+
+#endif /* SHELL_H_ */
@@ -0,0 +1,162 @@
+/*
+ * Copyright (c) 2015, Computer Science Department (CSD), University of Crete, and 
+ * Signal Processing Lab (SPL), Institute of Computer Science (ICS), FORTH, Greece.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of CSD, SPL/ICS-FORTH nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * 
+ */
+
+/**
+ * \file
+ *         Symmetric logical links (see symmetric.h).
+ *
+ *         A confirmation beacon is SYMMETRIC_BEACON, the position of the
+ *         sender (two floats) and, for each of its logical neighbours, the
+ *         id (one byte, as the firmwares take it) and the power level.
+ */
+
+#include <string.h>
+
+#include "symmetric.h"
+#include "net/packetbuf.h"
+
+#if SYMMETRIC_MODE != SYMMETRIC_NONE
+
+#define HEADER (1 + 2 * sizeof(float))
+
+/* the nodes that picked the node, with the level they reach it at */
+static struct topocache_entry chosen[SYMMETRIC_SIZE];
+static uint8_t nchosen;
+static uint8_t confirmed;
+
+/*---------------------------------------------------------------------------*/
+void
+symmetric_init(void)
+{
+  nchosen = 0;
+  confirmed = 0;
+}
+/*---------------------------------------------------------------------------*/
+void
+symmetric_beacon(const struct topocache_entry *e, uint8_t n, float x, float y)
+{
+  uint8_t *buf = packetbuf_dataptr();
+  uint8_t i;
+
+  buf[0] = SYMMETRIC_BEACON;
+  memcpy(buf + 1, &x, sizeof(float));
+  memcpy(buf + 1 + sizeof(float), &y, sizeof(float));
+  for(i = 0; i < n; ++i) {
+    buf[HEADER + 2 * i] = e[i].id;
+    buf[HEADER + 2 * i + 1] = e[i].level;
+  }
+  packetbuf_set_datalen(HEADER + 2 * n);
+}
+/*---------------------------------------------------------------------------*/
+void
+symmetric_recv(uint16_t from)
+{
+  uint8_t *buf = packetbuf_dataptr();
+  uint16_t n, len = packetbuf_datalen();
+  uint8_t i;
+
+  for(n = HEADER; n + 2 <= len; n += 2) {
+    if(buf[n] == rimeaddr_node_addr.u8[0]) {
+      break;
+    }
+  }
+  if(n + 2 > len) {
+    return;
+  }
+  for(i = 0; i < nchosen && chosen[i].id != from; ++i);
+  if(i == nchosen) {
+    if(nchosen == SYMMETRIC_SIZE) {
+      return;
+    }
+    nchosen++;
+  }
+  chosen[i].id = from;
+  chosen[i].level = buf[n + 1];
+  memcpy(&chosen[i].x, buf + 1, sizeof(float));
+  memcpy(&chosen[i].y, buf + 1 + sizeof(float), sizeof(float));
+}
+/*---------------------------------------------------------------------------*/
+void
+symmetric_end(void)
+{
+  confirmed = 1;
+}
+/*---------------------------------------------------------------------------*/
+int
+symmetric_confirmed(void)
+{
+  return confirmed;
+}
+/*---------------------------------------------------------------------------*/
+uint8_t
+symmetric_links(struct topocache_entry *e, uint8_t n, uint8_t size)
+{
+  uint8_t i, k;
+
+#if SYMMETRIC_MODE == SYMMETRIC_GMINUS
+  uint8_t j;
+
+  for(i = 0, k = 0; i < n; ++i) {
+    for(j = 0; j < nchosen && chosen[j].id != e[i].id; ++j);
+    if(j < nchosen) {
+      e[k++] = e[i];
+    }
+  }
+  n = k;
+#elif SYMMETRIC_MODE == SYMMETRIC_GPLUS
+  for(i = 0; i < nchosen && n < size; ++i) {
+    for(k = 0; k < n && e[k].id != chosen[i].id; ++k);
+    if(k == n) {
+      e[n++] = chosen[i];
+    }
+  }
+#endif
+  return n;
+}
+/*---------------------------------------------------------------------------*/
+uint8_t
+symmetric_power(const struct topocache_entry *e, uint8_t n, uint8_t power)
+{
+  uint8_t i, level;
+
+  if(n == 0) {
+    return power;
+  }
+  for(i = 0, level = 0; i < n; ++i) {
+    if(e[i].level > level) {
+      level = e[i].level;
+    }
+  }
+  return level;
+}
+/*---------------------------------------------------------------------------*/
+#endif /* SYMMETRIC_MODE != SYMMETRIC_NONE */
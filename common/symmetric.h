@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2015, Computer Science Department (CSD), University of Crete, and 
+ * Signal Processing Lab (SPL), Institute of Computer Science (ICS), FORTH, Greece.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of CSD, SPL/ICS-FORTH nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * 
+ */
+
+/**
+ * \file
+ *         Symmetric logical links, from a confirmation round after the
+ *         computation.
+ *
+ *         Every node picks its logical neighbours on its own, so a node may
+ *         keep a link its neighbour dropped. With SYMMETRIC_CONF_MODE set,
+ *         the firmware runs one more phase after the computation, in which
+ *         every node broadcasts, at the power it picked, its position and
+ *         its logical neighbours with the power level of each. A node then
+ *         keeps:
+ *
+ *           SYMMETRIC_GPLUS   its own neighbours and those that picked it,
+ *                             at the level they reported (G+ of the LMST
+ *                             paper: a link where either end picked it);
+ *           SYMMETRIC_GMINUS  those of its own neighbours that picked it
+ *                             too (G-: a link where both ends did);
+ *
+ *         and the transmission power becomes the least one that reaches
+ *         them: higher than the computed one in G+ where needed, lower in
+ *         G- where it can.
+ */
+
+#ifndef SYMMETRIC_H_
+#define SYMMETRIC_H_
+
+#include "contiki.h"
+#include "topocache.h"
+
+#define SYMMETRIC_NONE   0
+#define SYMMETRIC_GPLUS  1
+#define SYMMETRIC_GMINUS 2
+
+#ifdef SYMMETRIC_CONF_MODE
+#define SYMMETRIC_MODE SYMMETRIC_CONF_MODE
+#else
+#define SYMMETRIC_MODE SYMMETRIC_NONE
+#endif
+
+/* nodes that picked the node, kept */
+#ifdef SYMMETRIC_CONF_SIZE
+#define SYMMETRIC_SIZE SYMMETRIC_CONF_SIZE
+#else
+#define SYMMETRIC_SIZE 20
+#endif
+
+/* length of the confirmation phase (ticks) */
+#ifdef SYMMETRIC_CONF_PHASE
+#define SYMMETRIC_PHASE SYMMETRIC_CONF_PHASE
+#else
+#define SYMMETRIC_PHASE (30 * CLOCK_SECOND)
+#endif
+
+/* first byte of a confirmation beacon */
+#define SYMMETRIC_BEACON 'S'
+
+/* forgets the nodes that picked the node; the round is not done */
+void symmetric_init(void);
+
+/* puts the confirmation beacon in the packet buffer: the position of the
+   node and its logical neighbours e[0..n) */
+void symmetric_beacon(const struct topocache_entry *e, uint8_t n, float x, float y);
+
+/* a confirmation beacon (SYMMETRIC_BEACON) is in the packet buffer */
+void symmetric_recv(uint16_t from);
+
+/* the confirmation round is over (symmetric_confirmed() from now on) */
+void symmetric_end(void);
+int symmetric_confirmed(void);
+
+/* makes the logical neighbours e[0..n) symmetric (SYMMETRIC_MODE); e holds
+   up to size entries; returns the new number of neighbours */
+uint8_t symmetric_links(struct topocache_entry *e, uint8_t n, uint8_t size);
+
+/* the least power level that reaches the neighbours e[0..n), or power if
+   there are none */
+uint8_t symmetric_power(const struct topocache_entry *e, uint8_t n, uint8_t power);
+
+#endif /* SYMMETRIC_H_ */
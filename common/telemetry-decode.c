@@ -0,0 +1,187 @@
+/*
+ * Copyright (c) 2015, Computer Science Department (CSD), University of Crete, and 
+ * Signal Processing Lab (SPL), Institute of Computer Science (ICS), FORTH, Greece.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of CSD, SPL/ICS-FORTH nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * 
+ */
+
+/**
+ * \file
+ *         Decoding of telemetry frames (see telemetry.h), for the host tools.
+ */
+
+#include <stdio.h>
+
+#include "lib/crc16.h"
+#include "energy.h"
+#include "profile.h"
+#include "telemetry.h"
+
+static const char *names[TELEMETRY_TYPES] = {
+  NULL,
+  "DELAUNAY",
+  "INITIALIZE",
+  "REDELCA",
+  "POWER",
+  "MEMORY",
+  "NEIGHBOR",
+  "NEIGHBOR: ERROR",
+  "ENERGY_CPU",
+  "ENERGY_TX",
+  "ENERGY_RX",
+  "DONE",
+  "PROFILE",
+  "ENERGY",
+  "KLMST"
+};
+
+static const char *phases[PROFILE_PHASES] = PROFILE_NAMES;
+static const char *spans[ENERGY_SPANS] = ENERGY_NAMES;
+/*---------------------------------------------------------------------------*/
+static uint32_t
+get(const uint8_t *b, int len)
+{
+  uint32_t v = 0;
+
+  while(len-- > 0) {
+    v = v << 8 | *b++;
+  }
+  return v;
+}
+/*---------------------------------------------------------------------------*/
+int
+telemetry_decode(const char *line, int len, struct telemetry_record *r)
+{
+  uint8_t buf[TELEMETRY_MAX_FRAME];
+  unsigned short crc;
+  int i, n;
+
+  if(len < 1 || line[0] != TELEMETRY_SYNC) {
+    return -1;
+  }
+  for(i = 1, n = 0; i < len; ++i) {
+    if(n == TELEMETRY_MAX_FRAME) {
+      return -1;
+    }
+    if((uint8_t)line[i] == TELEMETRY_ESC) {
+      if(++i == len) {
+        return -1;
+      }
+      buf[n++] = (uint8_t)line[i] ^ 0x20;
+    } else {
+      buf[n++] = (uint8_t)line[i];
+    }
+  }
+  if(n < TELEMETRY_HEADER + 2) {
+    return -1;
+  }
+  crc = crc16_data(buf, n - 2, 0);
+  if(buf[n - 2] != (crc >> 8) || buf[n - 1] != (crc & 0xff)) {
+    return -1;
+  }
+  if(buf[0] == 0 || buf[0] >= TELEMETRY_TYPES) {
+    return -1;
+  }
+
+  r->type = buf[0];
+  r->seq = buf[1];
+  r->time = get(buf + 2, 4);
+  r->len = n - TELEMETRY_HEADER - 2;
+  for(i = 0; i < r->len; ++i) {
+    r->data[i] = buf[TELEMETRY_HEADER + i];
+  }
+  r->has_value = 0;
+  r->value = 0;
+  if(r->type < TELEMETRY_PROFILE) {
+    if(r->len > TELEMETRY_MAX_VALUE) {
+      return -1;
+    }
+    r->has_value = r->len > 0;
+    r->value = r->len > 0 && (r->data[0] & 0x80) ? -1 : 0;
+    for(i = 0; i < r->len; ++i) {
+      r->value = (int32_t)((uint32_t)r->value << 8 | r->data[i]);
+    }
+  } else if(r->type == TELEMETRY_PROFILE) {
+    if(r->len % PROFILE_RECORD != 0) {
+      return -1;
+    }
+    for(i = 0; i < r->len; i += PROFILE_RECORD) {
+      if(r->data[i] >= PROFILE_PHASES) {
+        return -1;
+      }
+    }
+  } else if(r->type == TELEMETRY_ENERGY) {
+    if(r->len % ENERGY_RECORD != 0) {
+      return -1;
+    }
+    for(i = 0; i < r->len; i += ENERGY_RECORD) {
+      if(r->data[i] >= ENERGY_SPANS) {
+        return -1;
+      }
+    }
+  } else if(r->type == TELEMETRY_KLMST) {
+    if(r->len != 3) {
+      return -1;
+    }
+  }
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+int
+telemetry_format(const struct telemetry_record *r, char *buf, int size)
+{
+  const uint8_t *d;
+  int len, i;
+
+  if(r->has_value) {
+    return snprintf(buf, size, "%s %ld", names[r->type], (long)r->value);
+  }
+  len = snprintf(buf, size, "%s", names[r->type]);
+  if(r->type == TELEMETRY_PROFILE) {
+    /* phase count min max total, for every phase that ran */
+    for(i = 0; i < r->len && len < size; i += PROFILE_RECORD) {
+      d = r->data + i;
+      len += snprintf(buf + len, size - len, " %s %lu %lu %lu %lu", phases[d[0]],
+                      (unsigned long)get(d + 1, 2), (unsigned long)get(d + 3, 2),
+                      (unsigned long)get(d + 5, 2), (unsigned long)get(d + 7, 4));
+    }
+  } else if(r->type == TELEMETRY_ENERGY) {
+    /* span cpu lpm tx rx (ticks) and energy (mJ), for every span */
+    for(i = 0; i < r->len && len < size; i += ENERGY_RECORD) {
+      d = r->data + i;
+      len += snprintf(buf + len, size - len, " %s %lu %lu %lu %lu %lu.%03lu", spans[d[0]],
+                      (unsigned long)get(d + 1, 4), (unsigned long)get(d + 5, 4),
+                      (unsigned long)get(d + 9, 4), (unsigned long)get(d + 13, 4),
+                      (unsigned long)get(d + 17, 4) / 1000, (unsigned long)get(d + 17, 4) % 1000);
+    }
+  } else if(r->type == TELEMETRY_KLMST) {
+    len += snprintf(buf + len, size - len, " %u %u %u", r->data[0], r->data[1], r->data[2]);
+  }
+  return len;
+}
+/*---------------------------------------------------------------------------*/
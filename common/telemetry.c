@@ -0,0 +1,128 @@
+/*
+ * Copyright (c) 2015, Computer Science Department (CSD), University of Crete, and 
+ * Signal Processing Lab (SPL), Institute of Computer Science (ICS), FORTH, Greece.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of CSD, SPL/ICS-FORTH nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * 
+ */
+
+/**
+ * \file
+ *         Telemetry records on the serial line (see telemetry.h).
+ */
+
+#include <stdio.h>
+
+#include "contiki.h"
+#include "lib/crc16.h"
+#include "telemetry.h"
+
+static uint8_t seq;
+/*---------------------------------------------------------------------------*/
+static void
+put(uint8_t b)
+{
+  if(b == '\0' || b == '\n' || b == '\r' || b == TELEMETRY_SYNC || b == TELEMETRY_ESC) {
+    putchar(TELEMETRY_ESC);
+    b ^= 0x20;
+  }
+  putchar(b);
+}
+/*---------------------------------------------------------------------------*/
+static void
+frame(uint8_t type, const uint8_t *data, uint8_t len)
+{
+  uint8_t header[TELEMETRY_HEADER], i;
+  uint32_t time;
+  unsigned long seconds;
+  clock_time_t ticks;
+  unsigned short crc;
+
+  /* local time in clock ticks; clock_seconds() and clock_time() advance
+     together, so this does not depend on the width of clock_time_t. The
+     two are read again if a second ended in between (the clock interrupt
+     updates both). */
+  do {
+    seconds = clock_seconds();
+    ticks = clock_time();
+  } while(seconds != clock_seconds());
+  time = seconds * CLOCK_SECOND + ticks % CLOCK_SECOND;
+
+  header[0] = type;
+  header[1] = seq++;
+  header[2] = time >> 24;
+  header[3] = time >> 16;
+  header[4] = time >> 8;
+  header[5] = time;
+  crc = crc16_data(header, TELEMETRY_HEADER, 0);
+  crc = crc16_data(data, len, crc);
+
+  putchar(TELEMETRY_SYNC);
+  for(i = 0; i < TELEMETRY_HEADER; ++i) {
+    put(header[i]);
+  }
+  for(i = 0; i < len; ++i) {
+    put(data[i]);
+  }
+  put(crc >> 8);
+  put(crc);
+  putchar('\n');
+}
+/*---------------------------------------------------------------------------*/
+void
+telemetry_event(uint8_t type)
+{
+  frame(type, NULL, 0);
+}
+/*---------------------------------------------------------------------------*/
+void
+telemetry_value(uint8_t type, int32_t value)
+{
+  uint8_t buf[TELEMETRY_MAX_VALUE], len, i;
+
+  /* the fewest bytes that keep the sign */
+  if(value >= -128 && value <= 127) {
+    len = 1;
+  } else if(value >= -32768L && value <= 32767L) {
+    len = 2;
+  } else if(value >= -8388608L && value <= 8388607L) {
+    len = 3;
+  } else {
+    len = 4;
+  }
+  for(i = 0; i < len; ++i) {
+    buf[i] = value >> (8 * (len - 1 - i));
+  }
+  frame(type, buf, len);
+}
+/*---------------------------------------------------------------------------*/
+void
+telemetry_data(uint8_t type, const uint8_t *data, uint8_t len)
+{
+  frame(type, data, len > TELEMETRY_MAX_DATA ? TELEMETRY_MAX_DATA : len);
+}
+/*---------------------------------------------------------------------------*/
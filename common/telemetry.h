@@ -0,0 +1,121 @@
+/*
+ * Copyright (c) 2015, Computer Science Department (CSD), University of Crete, and 
+ * Signal Processing Lab (SPL), Institute of Computer Science (ICS), FORTH, Greece.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of CSD, SPL/ICS-FORTH nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * 
+ */
+
+/**
+ * \file
+ *         Telemetry: the results and measurements of a mote, as compact binary
+ *         records on the serial line, instead of printf text. Formatting text
+ *         on the MSP430 takes CPU time, which is accounted in the very
+ *         ENERGY_CPU figures the motes report.
+ *
+ *         A record is an event type, the local time of the mote and a
+ *         payload: an optional integer value or, for some types, a block of
+ *         data. On the serial line, every record is one line (a frame):
+ *
+ *           '~' escaped(type, seq, time[4], payload[0..96], crc[2]) '\n'
+ *
+ *         seq counts the records of the mote (modulo 256), time is in clock
+ *         ticks since boot (CLOCK_SECOND per second), a value is big-endian
+ *         two's complement in as few bytes as it takes, and crc is the
+ *         CRC-16 (lib/crc16) of the bytes before it. Bytes that would end
+ *         or break the line are escaped as TELEMETRY_ESC, byte ^ 0x20, so
+ *         that frames go through line-oriented serial consoles (Cooja,
+ *         netsim, serialdump). Host-side decoders: telemetry_decode()
+ *         (telemetry-decode.c), tools/teldecode and LMST/scenario.js.
+ */
+
+#ifndef TELEMETRY_H_
+#define TELEMETRY_H_
+
+#include <stdint.h>
+
+#define TELEMETRY_SYNC      '~'
+#define TELEMETRY_ESC       0x7d
+#define TELEMETRY_MAX_VALUE 4
+#define TELEMETRY_MAX_DATA  96
+/* type, seq, time, payload, crc */
+#define TELEMETRY_HEADER    6
+#define TELEMETRY_MAX_FRAME (TELEMETRY_HEADER + TELEMETRY_MAX_DATA + 2)
+
+/* Event types. The comments give the text line each one replaces. */
+enum {
+  TELEMETRY_DELAUNAY = 1,   /* DELAUNAY: the computation starts */
+  TELEMETRY_INITIALIZE,     /* INITIALIZE <value> */
+  TELEMETRY_REDELCA,        /* REDELCA <value> */
+  TELEMETRY_POWER,          /* POWER <value> */
+  TELEMETRY_MEMORY,         /* MEMORY <value> */
+  TELEMETRY_NEIGHBOR,       /* NEIGHBOR <value> */
+  TELEMETRY_ERROR,          /* NEIGHBOR: ERROR */
+  TELEMETRY_ENERGY_CPU,     /* ENERGY_CPU <value> */
+  TELEMETRY_ENERGY_TX,      /* ENERGY_TX <value> */
+  TELEMETRY_ENERGY_RX,      /* ENERGY_RX <value> */
+  TELEMETRY_DONE,           /* DONE */
+  /* types with a block of data */
+  TELEMETRY_PROFILE,        /* PROFILE <phase> <count> <min> <max> <total>... (profile.h) */
+  TELEMETRY_ENERGY,         /* ENERGY <span> <cpu> <lpm> <tx> <rx> <mJ>... (energy.h) */
+  TELEMETRY_KLMST,          /* KLMST <k> <power of the local MST> <power of the k-LMST> */
+  TELEMETRY_TYPES
+};
+
+/* emits a record without a value */
+void telemetry_event(uint8_t type);
+
+/* emits a record with a value */
+void telemetry_value(uint8_t type, int32_t value);
+
+/* emits a record with a block of data (at most TELEMETRY_MAX_DATA bytes) */
+void telemetry_data(uint8_t type, const uint8_t *data, uint8_t len);
+
+/* A decoded record */
+struct telemetry_record {
+  uint8_t type;
+  uint8_t seq;
+  uint32_t time;            /* clock ticks since boot */
+  uint8_t has_value;
+  int32_t value;
+  uint8_t len;              /* payload */
+  uint8_t data[TELEMETRY_MAX_DATA];
+};
+
+/*
+ * Decodes the frame at line[0..len) (starting with TELEMETRY_SYNC, without
+ * the line end). Returns 0 on success, -1 if it is not a valid frame.
+ */
+int telemetry_decode(const char *line, int len, struct telemetry_record *r);
+
+/*
+ * Writes the text line of a record (e.g., "POWER 27") into buf; returns
+ * its length.
+ */
+int telemetry_format(const struct telemetry_record *r, char *buf, int size);
+
+#endif /* TELEMETRY_H_ */
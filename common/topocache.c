@@ -0,0 +1,173 @@
+/*
+ * Copyright (c) 2015, Computer Science Department (CSD), University of Crete, and 
+ * Signal Processing Lab (SPL), Institute of Computer Science (ICS), FORTH, Greece.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of CSD, SPL/ICS-FORTH nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * 
+ */
+
+/**
+ * \file
+ *         The topology of the node kept in flash (see topocache.h).
+ *
+ *         The file is a header (version, number of neighbours, power), the
+ *         neighbours, and the CRC-16 of both.
+ */
+
+#include <string.h>
+
+#include "topocache.h"
+#include "txpower.h"
+#include "cfs/cfs.h"
+#include "lib/crc16.h"
+
+struct header {
+  uint8_t version;
+  uint8_t n;
+  uint8_t power;
+  uint8_t valid;
+};
+
+static struct header cache;
+static struct topocache_entry entries[TOPOCACHE_SIZE];
+/* the file does not hold the cache: its last write failed */
+static uint8_t dirty;
+
+/*---------------------------------------------------------------------------*/
+static unsigned short
+checksum(void)
+{
+  unsigned short crc;
+
+  crc = crc16_data((unsigned char *)&cache, sizeof(cache), 0);
+  return crc16_data((unsigned char *)entries, cache.n * sizeof(struct topocache_entry), crc);
+}
+/*---------------------------------------------------------------------------*/
+int
+topocache_load(void)
+{
+  unsigned short crc;
+  int fd, ok;
+
+  memset(&cache, 0, sizeof(cache));
+  fd = cfs_open(TOPOCACHE_FILE, CFS_READ);
+  if(fd < 0) {
+    return -1;
+  }
+  ok = cfs_read(fd, &cache, sizeof(cache)) == sizeof(cache) &&
+       cache.version == TOPOCACHE_VERSION && cache.valid && cache.n <= TOPOCACHE_SIZE &&
+       cfs_read(fd, entries, cache.n * sizeof(struct topocache_entry)) == (int)(cache.n * sizeof(struct topocache_entry)) &&
+       cfs_read(fd, &crc, sizeof(crc)) == sizeof(crc) && crc == checksum();
+  cfs_close(fd);
+  if(!ok) {
+    memset(&cache, 0, sizeof(cache));
+    return -1;
+  }
+  return cache.n;
+}
+/*---------------------------------------------------------------------------*/
+int
+topocache_store(const struct topocache_entry *e, uint8_t n, uint8_t power)
+{
+  unsigned short crc;
+  uint8_t i, changed;
+  int fd, ok;
+
+  n = n > TOPOCACHE_SIZE ? TOPOCACHE_SIZE : n;
+  changed = dirty || !cache.valid || cache.n != n || cache.power != power;
+  for(i = 0; i < n; ++i) {
+    changed |= entries[i].id != e[i].id || entries[i].level != e[i].level ||
+               entries[i].x != e[i].x || entries[i].y != e[i].y;
+    /*field by field, so that the padding is zero and the CRC does not depend on it*/
+    memset(&entries[i], 0, sizeof(struct topocache_entry));
+    entries[i].id = e[i].id;
+    entries[i].level = e[i].level;
+    entries[i].x = e[i].x;
+    entries[i].y = e[i].y;
+  }
+  cache.version = TOPOCACHE_VERSION;
+  cache.n = n;
+  cache.power = power;
+  cache.valid = 1;
+  if(!changed) {
+    return 0;
+  }
+
+  /*written anew: Coffee does not truncate a file opened for writing*/
+  cfs_remove(TOPOCACHE_FILE);
+  dirty = 1;
+  fd = cfs_open(TOPOCACHE_FILE, CFS_WRITE);
+  if(fd < 0) {
+    return -1;
+  }
+  crc = checksum();
+  ok = cfs_write(fd, &cache, sizeof(cache)) == sizeof(cache) &&
+       cfs_write(fd, entries, n * sizeof(struct topocache_entry)) == (int)(n * sizeof(struct topocache_entry)) &&
+       cfs_write(fd, &crc, sizeof(crc)) == sizeof(crc);
+  cfs_close(fd);
+  dirty = !ok;
+  return ok ? 1 : -1;
+}
+/*---------------------------------------------------------------------------*/
+void
+topocache_apply(void)
+{
+  uint16_t ids[TOPOCACHE_SIZE];
+  uint8_t i;
+
+  txpower_clear();
+  for(i = 0; i < cache.n; ++i) {
+    txpower_set(entries[i].id, entries[i].level);
+    ids[i] = entries[i].id;
+  }
+  topology_update(ids, cache.n);
+}
+/*---------------------------------------------------------------------------*/
+int
+topocache_valid(void)
+{
+  return cache.valid;
+}
+/*---------------------------------------------------------------------------*/
+uint8_t
+topocache_count(void)
+{
+  return cache.n;
+}
+/*---------------------------------------------------------------------------*/
+const struct topocache_entry *
+topocache_entry(uint8_t i)
+{
+  return &entries[i];
+}
+/*---------------------------------------------------------------------------*/
+uint8_t
+topocache_power(void)
+{
+  return cache.power;
+}
+/*---------------------------------------------------------------------------*/
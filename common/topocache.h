@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2015, Computer Science Department (CSD), University of Crete, and 
+ * Signal Processing Lab (SPL), Institute of Computer Science (ICS), FORTH, Greece.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of CSD, SPL/ICS-FORTH nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * 
+ */
+
+/**
+ * \file
+ *         The topology of the node kept in flash (CFS, Coffee on the motes),
+ *         for a warm restart.
+ *
+ *         Every computation stores its result: the logical neighbours, the
+ *         power level and the position of each, and the transmission power
+ *         it picked. The file is written only when the result changes, and
+ *         it carries a version and a CRC-16. At boot the firmware loads it
+ *         and applies it at once (the unicast power table and the logical
+ *         neighbours, see txpower.h and topology.h), so the node runs at the
+ *         reduced power from its first milliseconds; discovery then runs as
+ *         usual and its computation confirms or replaces the cached result.
+ */
+
+#ifndef TOPOCACHE_H_
+#define TOPOCACHE_H_
+
+#include "contiki.h"
+#include "topology.h"
+
+#ifdef TOPOCACHE_CONF_FILE
+#define TOPOCACHE_FILE TOPOCACHE_CONF_FILE
+#else
+#define TOPOCACHE_FILE "topology"
+#endif
+
+/* the layout of the file; a file of another version is ignored */
+#define TOPOCACHE_VERSION 1
+
+/* logical neighbours kept */
+#define TOPOCACHE_SIZE TOPOLOGY_SIZE
+
+struct topocache_entry {
+  uint16_t id;
+  uint8_t level;
+  float x, y;
+};
+
+/* reads the file; returns the number of neighbours, or -1 if there is no
+   valid cache */
+int topocache_load(void);
+
+/* sets the cache to the result of a computation (at most TOPOCACHE_SIZE
+   neighbours) and writes it to the file if it has changed, or if the last
+   write failed; returns 1 if written, 0 if unchanged, -1 on a file error */
+int topocache_store(const struct topocache_entry *e, uint8_t n, uint8_t power);
+
+/* applies the cache: the unicast power table and the logical neighbours */
+void topocache_apply(void);
+
+/* the cache is set (loaded or stored); its neighbours and power */
+int topocache_valid(void);
+uint8_t topocache_count(void);
+const struct topocache_entry *topocache_entry(uint8_t i);
+uint8_t topocache_power(void);
+
+#endif /* TOPOCACHE_H_ */
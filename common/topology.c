@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) 2015, Computer Science Department (CSD), University of Crete, and 
+ * Signal Processing Lab (SPL), Institute of Computer Science (ICS), FORTH, Greece.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of CSD, SPL/ICS-FORTH nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * 
+ */
+
+/**
+ * \file
+ *         The logical topology of the node (see topology.h).
+ */
+
+#include "topology.h"
+
+process_event_t topology_event;
+
+static uint16_t neighbors[TOPOLOGY_SIZE];
+static uint8_t count, ready;
+
+/*---------------------------------------------------------------------------*/
+void
+topology_init(void)
+{
+  topology_event = process_alloc_event();
+  count = 0;
+  ready = 0;
+}
+/*---------------------------------------------------------------------------*/
+int
+topology_update(const uint16_t *ids, uint8_t n)
+{
+  uint8_t i, changed;
+
+  n = n > TOPOLOGY_SIZE ? TOPOLOGY_SIZE : n;
+  /*a new set has the same size and all of its ids in the old one (the ids are distinct)*/
+  changed = !ready || n != count;
+  for(i = 0; i < n && !changed; ++i) {
+    changed = !topology_contains(ids[i]);
+  }
+  if(!changed) {
+    return 0;
+  }
+  for(i = 0; i < n; ++i) {
+    neighbors[i] = ids[i];
+  }
+  count = n;
+  ready = 1;
+  process_post(PROCESS_BROADCAST, topology_event, NULL);
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+int
+topology_ready(void)
+{
+  return ready;
+}
+/*---------------------------------------------------------------------------*/
+uint8_t
+topology_count(void)
+{
+  return count;
+}
+/*---------------------------------------------------------------------------*/
+uint16_t
+topology_neighbor(uint8_t i)
+{
+  return neighbors[i];
+}
+/*---------------------------------------------------------------------------*/
+int
+topology_contains(uint16_t id)
+{
+  uint8_t i;
+
+  for(i = 0; i < count; ++i) {
+    if(neighbors[i] == id) {
+      return 1;
+    }
+  }
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+int
+topology_filter(const rimeaddr_t *addr)
+{
+  return !ready || topology_contains(addr->u8[0]);
+}
+/*---------------------------------------------------------------------------*/
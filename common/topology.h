@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2015, Computer Science Department (CSD), University of Crete, and 
+ * Signal Processing Lab (SPL), Institute of Computer Science (ICS), FORTH, Greece.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of CSD, SPL/ICS-FORTH nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * 
+ */
+
+/**
+ * \file
+ *         The logical topology of the node, for the routing and data
+ *         collection layers above it.
+ *
+ *         The topology control computation (LMST, REDELCA) publishes the
+ *         node's logical neighbours with topology_update(); when the set
+ *         changes, topology_event is posted to every process. Until the
+ *         first update the set is not known, and every neighbour is
+ *         accepted.
+ *
+ *         topology_filter() is the neighbour filter of the routing layer:
+ *         it is called with the address of a neighbour before a link to it
+ *         is kept (a collect neighbour, an RPL parent), and it returns 0 for
+ *         physical neighbours that are not logical ones, so that routing
+ *         state and route computation stay on the sparse topology.
+ */
+
+#ifndef TOPOLOGY_H_
+#define TOPOLOGY_H_
+
+#include "contiki.h"
+#include "net/rimeaddr.h"
+
+/* logical neighbours kept */
+#ifdef TOPOLOGY_CONF_SIZE
+#define TOPOLOGY_SIZE TOPOLOGY_CONF_SIZE
+#else
+#define TOPOLOGY_SIZE 20
+#endif
+
+/* posted (to PROCESS_BROADCAST) when the set of logical neighbours changes */
+extern process_event_t topology_event;
+
+/* the set is not known yet; at boot */
+void topology_init(void);
+
+/* sets the logical neighbours (at most TOPOLOGY_SIZE are kept); returns 1
+   and posts topology_event if the set has changed */
+int topology_update(const uint16_t *ids, uint8_t n);
+
+/* the set is known (after the first update) */
+int topology_ready(void);
+
+/* the logical neighbours: their number, the i-th of them */
+uint8_t topology_count(void);
+uint16_t topology_neighbor(uint8_t i);
+
+/* id is a logical neighbour */
+int topology_contains(uint16_t id);
+
+/* a link to addr may be used: the set is not known yet, or addr is in it */
+int topology_filter(const rimeaddr_t *addr);
+
+#endif /* TOPOLOGY_H_ */
@@ -0,0 +1,114 @@
+/*
+ * Copyright (c) 2015, Computer Science Department (CSD), University of Crete, and 
+ * Signal Processing Lab (SPL), Institute of Computer Science (ICS), FORTH, Greece.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of CSD, SPL/ICS-FORTH nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * 
+ */
+
+/**
+ * \file
+ *         Per-neighbour transmission power (see txpower.h).
+ */
+
+#include "txpower.h"
+#include "net/packetbuf.h"
+
+static struct {
+  uint16_t id;
+  uint8_t level;
+} table[TXPOWER_SIZE];
+static uint8_t count;
+
+/*---------------------------------------------------------------------------*/
+void
+txpower_clear(void)
+{
+  count = 0;
+}
+/*---------------------------------------------------------------------------*/
+int
+txpower_set(uint16_t id, uint8_t level)
+{
+  uint8_t i;
+
+  for(i = 0; i < count && table[i].id != id; ++i);
+  if(i == TXPOWER_SIZE) {
+    return 0;
+  }
+  if(i == count) {
+    table[count++].id = id;
+  }
+  table[i].level = level > TXPOWER_MAX ? TXPOWER_MAX : level;
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+uint8_t
+txpower_get(uint16_t id)
+{
+  uint8_t i;
+
+  for(i = 0; i < count; ++i) {
+    if(table[i].id == id) {
+      return table[i].level;
+    }
+  }
+  return TXPOWER_MAX;
+}
+/*---------------------------------------------------------------------------*/
+uint8_t
+txpower_count(void)
+{
+  return count;
+}
+/*---------------------------------------------------------------------------*/
+uint8_t
+txpower_entry(uint8_t i, uint16_t *id)
+{
+  *id = table[i].id;
+  return table[i].level;
+}
+/*---------------------------------------------------------------------------*/
+void
+txpower_frame(void)
+{
+  const rimeaddr_t *to = packetbuf_addr(PACKETBUF_ADDR_RECEIVER);
+  uint8_t level = TXPOWER_MAX;
+
+  if(!rimeaddr_cmp(to, &rimeaddr_null)) {
+    level = txpower_get(to->u8[0]);
+  }
+  packetbuf_set_attr(PACKETBUF_ATTR_RADIO_TXPOWER, level + 1);
+}
+/*---------------------------------------------------------------------------*/
+int
+txpower_unicast_send(struct unicast_conn *c, const rimeaddr_t *to)
+{
+  packetbuf_set_attr(PACKETBUF_ATTR_RADIO_TXPOWER, txpower_get(to->u8[0]) + 1);
+  return unicast_send(c, to);
+}
+/*---------------------------------------------------------------------------*/
@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2015, Computer Science Department (CSD), University of Crete, and 
+ * Signal Processing Lab (SPL), Institute of Computer Science (ICS), FORTH, Greece.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of CSD, SPL/ICS-FORTH nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * 
+ */
+
+/**
+ * \file
+ *         Per-neighbour transmission power for unicast frames.
+ *
+ *         The topology computation fills a table with the CC2420 power level
+ *         (3..31) that reaches each of the node's logical neighbours. Every
+ *         unicast frame is then sent at the level of its receiver, while
+ *         broadcasts, and frames to nodes not in the table, keep the full
+ *         power, so that they reach the whole physical neighbourhood.
+ *
+ *         The level is set with the PACKETBUF_ATTR_RADIO_TXPOWER attribute
+ *         of the frame (level + 1), which the CC2420 driver applies for that
+ *         frame only. Unicast traffic goes either through
+ *         txpower_unicast_send(), or through any other primitive with
+ *         txpower_frame() called by the MAC (or before the send) once the
+ *         receiver address of the frame is set.
+ */
+
+#ifndef TXPOWER_H_
+#define TXPOWER_H_
+
+#include "contiki.h"
+#include "net/rime.h"
+
+/* entries of the table */
+#ifdef TXPOWER_CONF_SIZE
+#define TXPOWER_SIZE TXPOWER_CONF_SIZE
+#else
+#define TXPOWER_SIZE 20
+#endif
+
+/* the level of broadcasts and of receivers not in the table */
+#define TXPOWER_MAX 31
+
+/* empties the table */
+void txpower_clear(void);
+
+/* sets the level of neighbour id; returns 0 if the table is full */
+int txpower_set(uint16_t id, uint8_t level);
+
+/* the level of neighbour id, TXPOWER_MAX if not in the table */
+uint8_t txpower_get(uint16_t id);
+
+/* entries in the table, and the i-th of them (id, returns its level) */
+uint8_t txpower_count(void);
+uint8_t txpower_entry(uint8_t i, uint16_t *id);
+
+/* sets the level of the frame in the packet buffer, from its receiver */
+void txpower_frame(void);
+
+/* sends the packet buffer to a neighbour at its level */
+int txpower_unicast_send(struct unicast_conn *c, const rimeaddr_t *to);
+
+#endif /* TXPOWER_H_ */
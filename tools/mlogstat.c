@@ -0,0 +1,779 @@
+/*
+ * Copyright (c) 2015, Computer Science Department (CSD), University of Crete, and 
+ * Signal Processing Lab (SPL), Institute of Computer Science (ICS), FORTH, Greece.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of CSD, SPL/ICS-FORTH nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * 
+ */
+/**
+ * \file
+ *         mlogstat, analysis of motes logs. For every .mlog it reads the
+ *         matching .dat (same name, same folder), rebuilds the logical
+ *         topology the motes picked from their NEIGHBOR columns and compares
+ *         it with the topology at full power (unit disk graph). One line per
+ *         run is printed, so that runs can be compared side by side.
+ *
+ *         The mlog rows of LMST and REDELCA differ (CBTC writes those of
+ *         REDELCA), but both end the same way:
+ *         the last time (min:sec.mse) of a row is followed by POWER, PEAK
+ *         MEMORY ALLOCATION, the NEIGHBOR ids and, last, ENERGY_CPU,
+ *         ENERGY_TX and ENERGY_RX.
+ *
+ *         A NEIGHBOR b in the row of a means that a received the final
+ *         beacon of b, i.e., b reaches a at the power it picked. The logical
+ *         topology G+ has an edge where at least one of the two directions
+ *         exists, G- where both do.
+ *
+ *         The "#ENERGY <id> <span> <cpu> <lpm> <tx> <rx> <mJ>..." comment
+ *         lines (common/energy.h) give the energy of every span of a mote.
+ */
+
+#include <dirent.h>
+#include <errno.h>
+#include <getopt.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#define MAX_LINE    65536
+
+struct node {
+  unsigned id;
+  double x, y;
+  int power;               /* -1: the mote did not log its POWER */
+  long cpu, tx, rx;        /* energest ticks, -1: not logged */
+  int nlogged, *logged;    /* NEIGHBOR column, as logged (low byte of ids) */
+};
+
+struct graph {
+  int *start, *adj;        /* compressed adjacency: adj[start[i]..start[i+1]) */
+  double *cost;            /* d^2 of every adjacency entry */
+};
+
+/* the spans of common/energy.h, in the same order */
+static const char *spans[] = { "POSITION", "TWOHOP", "COMPUTE", "VERIFY" };
+#define SPANS (sizeof(spans) / sizeof(spans[0]))
+
+static double span_mj[SPANS];
+static long span_n[SPANS];
+
+static struct {
+  double range;
+  int minus;               /* stretch over G- instead of G+ */
+  int tsv;
+  int sources;             /* stretch from this many nodes at most, 0: all */
+} conf = { 15.0, 0, 0, 200 };
+
+static struct node *nodes;
+static int nnodes;
+
+/*---------------------------------------------------------------------------*/
+static int
+find(int *parent, int i)
+{
+  while(parent[i] != i) {
+    parent[i] = parent[parent[i]];
+    i = parent[i];
+  }
+  return i;
+}
+/*---------------------------------------------------------------------------*/
+static int
+components(const struct graph *g)
+{
+  int *parent = malloc(nnodes * sizeof(int));
+  int i, k, a, b, n = nnodes;
+
+  for(i = 0; i < nnodes; ++i) {
+    parent[i] = i;
+  }
+  for(i = 0; i < nnodes; ++i) {
+    for(k = g->start[i]; k < g->start[i + 1]; ++k) {
+      a = find(parent, i);
+      b = find(parent, g->adj[k]);
+      if(a != b) {
+        parent[a] = b;
+        n--;
+      }
+    }
+  }
+  free(parent);
+  return n;
+}
+/*---------------------------------------------------------------------------*/
+static double
+dist2(int a, int b)
+{
+  double dx = nodes[a].x - nodes[b].x, dy = nodes[a].y - nodes[b].y;
+
+  return dx * dx + dy * dy;
+}
+/*---------------------------------------------------------------------------*/
+/* Builds a graph out of a list of undirected edges (pairs of indices) */
+static void
+build_graph(struct graph *g, const int *edges, int nedges)
+{
+  int i, *fill;
+
+  g->start = calloc(nnodes + 1, sizeof(int));
+  g->adj = malloc(2 * nedges * sizeof(int) + 1);
+  g->cost = malloc(2 * nedges * sizeof(double) + 1);
+  fill = malloc(nnodes * sizeof(int));
+  for(i = 0; i < nedges; ++i) {
+    g->start[edges[2 * i] + 1]++;
+    g->start[edges[2 * i + 1] + 1]++;
+  }
+  for(i = 0; i < nnodes; ++i) {
+    g->start[i + 1] += g->start[i];
+    fill[i] = g->start[i];
+  }
+  for(i = 0; i < nedges; ++i) {
+    int a = edges[2 * i], b = edges[2 * i + 1];
+    g->adj[fill[a]] = b;
+    g->cost[fill[a]++] = dist2(a, b);
+    g->adj[fill[b]] = a;
+    g->cost[fill[b]++] = dist2(a, b);
+  }
+  free(fill);
+}
+/*---------------------------------------------------------------------------*/
+static void
+free_graph(struct graph *g)
+{
+  free(g->start);
+  free(g->adj);
+  free(g->cost);
+}
+/*---------------------------------------------------------------------------*/
+/*
+ * The full power graph: every pair within range. Pairs are found through a
+ * uniform grid of range-sized cells, each node is checked against its own
+ * and the eight surrounding cells only.
+ */
+static int
+udg_edges(int **edges)
+{
+  double minx = nodes[0].x, miny = nodes[0].y, maxx = minx, maxy = miny;
+  double r2 = conf.range * conf.range;
+  int *head, *next, cols, rows, i, j, c, cx, cy, dx, dy, n = 0, size = 1024;
+
+  for(i = 1; i < nnodes; ++i) {
+    minx = fmin(minx, nodes[i].x);
+    maxx = fmax(maxx, nodes[i].x);
+    miny = fmin(miny, nodes[i].y);
+    maxy = fmax(maxy, nodes[i].y);
+  }
+  cols = (int)((maxx - minx) / conf.range) + 1;
+  rows = (int)((maxy - miny) / conf.range) + 1;
+  head = malloc((size_t)cols * rows * sizeof(int));
+  next = malloc(nnodes * sizeof(int));
+  memset(head, -1, (size_t)cols * rows * sizeof(int));
+  for(i = 0; i < nnodes; ++i) {
+    c = (int)((nodes[i].y - miny) / conf.range) * cols +
+        (int)((nodes[i].x - minx) / conf.range);
+    next[i] = head[c];
+    head[c] = i;
+  }
+  *edges = malloc(2 * size * sizeof(int));
+  for(i = 0; i < nnodes; ++i) {
+    cx = (int)((nodes[i].x - minx) / conf.range);
+    cy = (int)((nodes[i].y - miny) / conf.range);
+    for(dy = -1; dy <= 1; ++dy) {
+      for(dx = -1; dx <= 1; ++dx) {
+        if(cx + dx < 0 || cx + dx >= cols || cy + dy < 0 || cy + dy >= rows) {
+          continue;
+        }
+        for(j = head[(cy + dy) * cols + cx + dx]; j >= 0; j = next[j]) {
+          if(j <= i || dist2(i, j) > r2) {
+            continue;
+          }
+          if(n == size) {
+            size *= 2;
+            *edges = realloc(*edges, 2 * size * sizeof(int));
+          }
+          (*edges)[2 * n] = i;
+          (*edges)[2 * n + 1] = j;
+          n++;
+        }
+      }
+    }
+  }
+  free(head);
+  free(next);
+  return n;
+}
+/*---------------------------------------------------------------------------*/
+/* Binary heap of (distance, node) for Dijkstra */
+static double *heap_key;
+static int *heap_node, heap_len;
+
+static void
+heap_push(double key, int node)
+{
+  int i = heap_len++, p;
+
+  while(i > 0 && heap_key[p = (i - 1) / 2] > key) {
+    heap_key[i] = heap_key[p];
+    heap_node[i] = heap_node[p];
+    i = p;
+  }
+  heap_key[i] = key;
+  heap_node[i] = node;
+}
+/*---------------------------------------------------------------------------*/
+static int
+heap_pop(double *key)
+{
+  int top = heap_node[0], i = 0, c;
+  double k = heap_key[--heap_len];
+  int n = heap_node[heap_len];
+
+  *key = heap_key[0];
+  while((c = 2 * i + 1) < heap_len) {
+    if(c + 1 < heap_len && heap_key[c + 1] < heap_key[c]) {
+      c++;
+    }
+    if(heap_key[c] >= k) {
+      break;
+    }
+    heap_key[i] = heap_key[c];
+    heap_node[i] = heap_node[c];
+    i = c;
+  }
+  heap_key[i] = k;
+  heap_node[i] = n;
+  return top;
+}
+/*---------------------------------------------------------------------------*/
+/* Least total power (sum of d^2) from src to every node */
+static void
+shortest_power(const struct graph *g, int src, double *d)
+{
+  double key;
+  int i, k;
+
+  for(i = 0; i < nnodes; ++i) {
+    d[i] = INFINITY;
+  }
+  d[src] = 0;
+  heap_len = 0;
+  heap_push(0, src);
+  while(heap_len > 0) {
+    i = heap_pop(&key);
+    if(key > d[i]) {
+      continue;
+    }
+    for(k = g->start[i]; k < g->start[i + 1]; ++k) {
+      if(key + g->cost[k] < d[g->adj[k]]) {
+        d[g->adj[k]] = key + g->cost[k];
+        heap_push(d[g->adj[k]], g->adj[k]);
+      }
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Least number of hops from src to every node (-1: unreachable) */
+static void
+shortest_hops(const struct graph *g, int src, int *h, int *queue)
+{
+  int i, k, first = 0, last = 0;
+
+  for(i = 0; i < nnodes; ++i) {
+    h[i] = -1;
+  }
+  h[src] = 0;
+  queue[last++] = src;
+  while(first < last) {
+    i = queue[first++];
+    for(k = g->start[i]; k < g->start[i + 1]; ++k) {
+      if(h[g->adj[k]] < 0) {
+        h[g->adj[k]] = h[i] + 1;
+        queue[last++] = g->adj[k];
+      }
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+static int
+compare_id(const void *a, const void *b)
+{
+  const struct node *na = a, *nb = b;
+
+  return na->id < nb->id ? -1 : na->id > nb->id;
+}
+/*---------------------------------------------------------------------------*/
+static int
+index_of(unsigned id)
+{
+  struct node key, *n;
+
+  key.id = id;
+  n = bsearch(&key, nodes, nnodes, sizeof(struct node), compare_id);
+  return n == NULL ? -1 : (int)(n - nodes);
+}
+/*---------------------------------------------------------------------------*/
+/*
+ * The motes log the low byte of their neighbours' ids only (u8[0] of the
+ * Rime address); with ids above 255, the nearest node with that low byte
+ * is taken. topoeval logs full ids: one above 255 is taken as it is.
+ */
+static int *bucket_start, *bucket;
+
+static void
+index_low_bytes(void)
+{
+  int i, fill[257];
+
+  bucket_start = calloc(257, sizeof(int));
+  bucket = malloc(nnodes * sizeof(int));
+  for(i = 0; i < nnodes; ++i) {
+    bucket_start[(nodes[i].id & 0xff) + 1]++;
+  }
+  for(i = 0; i < 256; ++i) {
+    bucket_start[i + 1] += bucket_start[i];
+  }
+  memcpy(fill, bucket_start, sizeof(fill));
+  for(i = 0; i < nnodes; ++i) {
+    bucket[fill[nodes[i].id & 0xff]++] = i;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static int
+resolve(int a, unsigned logged)
+{
+  int k, i, best = -1;
+
+  if(nodes[nnodes - 1].id <= 255 || logged > 255) {
+    return index_of(logged);
+  }
+  if(bucket == NULL) {
+    index_low_bytes();
+  }
+  for(k = bucket_start[logged & 0xff]; k < bucket_start[(logged & 0xff) + 1]; ++k) {
+    i = bucket[k];
+    if(i != a && (best < 0 || dist2(a, i) < dist2(a, best))) {
+      best = i;
+    }
+  }
+  return best;
+}
+/*---------------------------------------------------------------------------*/
+static void
+clear_nodes(void)
+{
+  int i;
+
+  for(i = 0; i < nnodes; ++i) {
+    free(nodes[i].logged);
+  }
+  free(nodes);
+  free(bucket_start);
+  free(bucket);
+  nodes = NULL;
+  bucket_start = bucket = NULL;
+  nnodes = 0;
+}
+/*---------------------------------------------------------------------------*/
+static int
+load_deployment(const char *file)
+{
+  FILE *f = fopen(file, "r");
+  char line[256];
+  int size = 0;
+  unsigned id;
+  double x, y;
+
+  if(f == NULL) {
+    return -1;
+  }
+  while(fgets(line, sizeof(line), f) != NULL) {
+    if(sscanf(line, " %u , %lf , %lf", &id, &x, &y) != 3) {
+      continue;
+    }
+    if(nnodes == size) {
+      size = size ? size * 2 : 256;
+      nodes = realloc(nodes, size * sizeof(struct node));
+    }
+    memset(&nodes[nnodes], 0, sizeof(struct node));
+    nodes[nnodes].id = id;
+    nodes[nnodes].x = x;
+    nodes[nnodes].y = y;
+    nodes[nnodes].power = -1;
+    nodes[nnodes].cpu = nodes[nnodes].tx = nodes[nnodes].rx = -1;
+    nnodes++;
+  }
+  fclose(f);
+  qsort(nodes, nnodes, sizeof(struct node), compare_id);
+  return nnodes > 0 ? 0 : -1;
+}
+/*---------------------------------------------------------------------------*/
+/* Parses one mlog row, see the layout at the top of this file */
+static void
+parse_row(char *line)
+{
+  char *fields[MAX_LINE / 2], *p;
+  int n = 0, last = -1, i, k, a;
+  struct node *node;
+
+  line[strcspn(line, "\r\n")] = '\0';
+  for(p = strtok(line, ","); p != NULL && n < MAX_LINE / 2; p = strtok(NULL, ",")) {
+    if(strchr(p, ':') != NULL) {
+      last = n;
+    }
+    fields[n++] = p;
+  }
+  if(n < 1 || (a = index_of((unsigned)atol(fields[0]))) < 0) {
+    return;
+  }
+  node = &nodes[a];
+  /* the POWER, MEMORY and the three energy fields must follow the time */
+  if(last < 0 || n - last < 6) {
+    return;
+  }
+  node->power = atoi(fields[last + 1]);
+  node->cpu = atol(fields[n - 3]);
+  node->tx = atol(fields[n - 2]);
+  node->rx = atol(fields[n - 1]);
+  node->nlogged = n - 3 - (last + 3);
+  node->logged = malloc((node->nlogged + 1) * sizeof(int));
+  for(i = last + 3, k = 0; i < n - 3; ++i) {
+    node->logged[k++] = atoi(fields[i]);
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Parses an "#ENERGY <id> <span> <cpu> <lpm> <tx> <rx> <mJ>..." line */
+static void
+parse_energy(char *line)
+{
+  char *p;
+  unsigned s;
+
+  strtok(line, " \r\n");
+  strtok(NULL, " \r\n");
+  while((p = strtok(NULL, " \r\n")) != NULL) {
+    for(s = 0; s < SPANS && strcmp(p, spans[s]) != 0; ++s);
+    /* cpu lpm tx rx, then the energy */
+    strtok(NULL, " \r\n");
+    strtok(NULL, " \r\n");
+    strtok(NULL, " \r\n");
+    strtok(NULL, " \r\n");
+    if((p = strtok(NULL, " \r\n")) == NULL) {
+      return;
+    }
+    if(s < SPANS) {
+      span_mj[s] += atof(p);
+      span_n[s]++;
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+static int
+compare_edge(const void *a, const void *b)
+{
+  const int *ea = a, *eb = b;
+
+  return ea[0] != eb[0] ? ea[0] - eb[0] : ea[1] - eb[1];
+}
+/*---------------------------------------------------------------------------*/
+static void
+header(void)
+{
+  if(conf.tsv) {
+    printf("#run\tnodes\tlogged\tedges\tsym\tcomp_udg\tcomp_plus\tcomp_minus\t"
+           "deg_avg\tdeg_max\tpower_avg\tpower_save\tpstretch_avg\tpstretch_max\t"
+           "hstretch_avg\thstretch_max\tcpu_avg\ttx_avg\trx_avg\t"
+           "position_mj\ttwohop_mj\tcompute_mj\tverify_mj\n");
+  } else {
+    printf("%-32s %6s %6s %7s %5s %4s %4s %4s %6s %4s %6s %6s %7s %7s %7s %7s %8s %6s %9s %8s %8s %8s %8s\n",
+           "#run", "nodes", "logged", "edges", "sym", "cUDG", "cG+", "cG-",
+           "degavg", "dmax", "power", "save", "pstr", "pstrmax", "hstr",
+           "hstrmax", "cpu", "tx", "rx", "mJpos", "mJ2hop", "mJcomp", "mJver");
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+analyse(const char *mlog, const char *dat)
+{
+  FILE *f;
+  char *line, *name;
+  int i, s, k, j, b, all, nedges = 0, nudg, nsym, nplus, logged = 0, degmax = 0;
+  int *edges, *udg, *minus, *hops_h, *hops_g, *queue, c_udg, c_plus, c_minus;
+  struct graph g_udg, g_plus, g_minus, *h;
+  double *pw_h, *pw_g, power = 0, save = 0, cpu = 0, tx = 0, rx = 0;
+  double ps_sum = 0, ps_max = 0, hs_sum = 0, hs_max = 0;
+  long pairs = 0, nenergy = 0;
+
+  if(load_deployment(dat) < 0) {
+    fprintf(stderr, "mlogstat: %s: no deployment %s\n", mlog, dat);
+    clear_nodes();
+    return;
+  }
+  if((f = fopen(mlog, "r")) == NULL) {
+    fprintf(stderr, "mlogstat: %s: %s\n", mlog, strerror(errno));
+    clear_nodes();
+    return;
+  }
+  memset(span_mj, 0, sizeof(span_mj));
+  memset(span_n, 0, sizeof(span_n));
+  line = malloc(MAX_LINE);
+  while(fgets(line, MAX_LINE, f) != NULL) {
+    if(line[0] != '#') {
+      parse_row(line);
+    } else if(strncmp(line, "#ENERGY ", 8) == 0) {
+      parse_energy(line);
+    }
+  }
+  fclose(f);
+  free(line);
+
+  /* directed edges b -> a, as pairs (min, max) with the direction in bit 0 */
+  for(i = 0; i < nnodes; ++i) {
+    nedges += nodes[i].nlogged;
+  }
+  edges = malloc((2 * nedges + 2) * sizeof(int));
+  for(i = 0, nedges = 0; i < nnodes; ++i) {
+    if(nodes[i].power < 0) {
+      continue;
+    }
+    logged++;
+    power += nodes[i].power;
+    save += 1 - (nodes[i].power / 31.0) * (nodes[i].power / 31.0);
+    if(nodes[i].cpu >= 0) {
+      cpu += nodes[i].cpu;
+      tx += nodes[i].tx;
+      rx += nodes[i].rx;
+      nenergy++;
+    }
+    for(k = 0; k < nodes[i].nlogged; ++k) {
+      if((b = resolve(i, nodes[i].logged[k])) < 0 || b == i) {
+        continue;
+      }
+      edges[2 * nedges] = b < i ? b : i;
+      edges[2 * nedges + 1] = (b < i ? i : b) * 2 + (b < i);
+      nedges++;
+    }
+  }
+  qsort(edges, nedges, 2 * sizeof(int), compare_edge);
+
+  /* collapse to undirected edges: G+ all of them, G- those seen both ways */
+  minus = malloc((2 * nedges + 2) * sizeof(int));
+  for(i = 0, nplus = 0, nsym = 0; i < nedges; i = j) {
+    int dirs = 0;
+    for(j = i; j < nedges && edges[2 * j] == edges[2 * i] &&
+          edges[2 * j + 1] / 2 == edges[2 * i + 1] / 2; ++j) {
+      dirs |= 1 << (edges[2 * j + 1] & 1);
+    }
+    edges[2 * nplus] = edges[2 * i];
+    edges[2 * nplus + 1] = edges[2 * i + 1] / 2;
+    if(dirs == 3) {
+      minus[2 * nsym] = edges[2 * nplus];
+      minus[2 * nsym + 1] = edges[2 * nplus + 1];
+      nsym++;
+    }
+    nplus++;
+  }
+  nudg = udg_edges(&udg);
+  build_graph(&g_udg, udg, nudg);
+  build_graph(&g_plus, edges, nplus);
+  build_graph(&g_minus, minus, nsym);
+  c_udg = components(&g_udg);
+  c_plus = components(&g_plus);
+  c_minus = components(&g_minus);
+  h = conf.minus ? &g_minus : &g_plus;
+  for(i = 0; i < nnodes; ++i) {
+    k = h->start[i + 1] - h->start[i];
+    degmax = k > degmax ? k : degmax;
+  }
+
+  /* stretch over all pairs connected at full power and in the topology or,
+     with more than conf.sources nodes, over the pairs of that many sources
+     spread evenly over the .dat order (one shortest path pass each) */
+  pw_h = malloc(nnodes * sizeof(double));
+  pw_g = malloc(nnodes * sizeof(double));
+  hops_h = malloc(nnodes * sizeof(int));
+  hops_g = malloc(nnodes * sizeof(int));
+  queue = malloc(nnodes * sizeof(int));
+  heap_key = malloc((2 * nudg + nnodes + 1) * sizeof(double));
+  heap_node = malloc((2 * nudg + nnodes + 1) * sizeof(int));
+  all = conf.sources == 0 || nnodes <= conf.sources;
+  for(s = 0; s < (all ? nnodes : conf.sources); ++s) {
+    i = all ? s : (int)((long)s * nnodes / conf.sources);
+    shortest_power(&g_udg, i, pw_g);
+    shortest_power(h, i, pw_h);
+    shortest_hops(&g_udg, i, hops_g, queue);
+    shortest_hops(h, i, hops_h, queue);
+    for(j = all ? i + 1 : 0; j < nnodes; ++j) {
+      double ps, hs;
+      if(j == i || hops_h[j] < 0 || hops_g[j] < 0) {
+        continue;
+      }
+      ps = pw_g[j] > 0 ? pw_h[j] / pw_g[j] : 1;
+      hs = (double)hops_h[j] / hops_g[j];
+      ps_sum += ps;
+      hs_sum += hs;
+      ps_max = ps > ps_max ? ps : ps_max;
+      hs_max = hs > hs_max ? hs : hs_max;
+      pairs++;
+    }
+  }
+
+  name = strrchr(mlog, '/') ? strrchr(mlog, '/') + 1 : (char *)mlog;
+#define AVG(s, n) ((n) > 0 ? (s) / (n) : 0.0)
+  printf(conf.tsv ?
+         "%s\t%d\t%d\t%d\t%.3f\t%d\t%d\t%d\t%.2f\t%d\t%.2f\t%.3f\t%.3f\t%.3f\t%.3f\t%.3f\t%.1f\t%.1f\t%.1f\t%.3f\t%.3f\t%.3f\t%.3f\n" :
+         "%-32s %6d %6d %7d %5.3f %4d %4d %4d %6.2f %4d %6.2f %6.3f %7.3f %7.3f %7.3f %7.3f %8.1f %6.1f %9.1f %8.1f %8.1f %8.1f %8.1f\n",
+         name, nnodes, logged, nplus, AVG((double)nsym, nplus), c_udg, c_plus,
+         c_minus, AVG(2.0 * (conf.minus ? nsym : nplus), nnodes), degmax,
+         AVG(power, logged), AVG(save, logged), AVG(ps_sum, pairs), ps_max,
+         AVG(hs_sum, pairs), hs_max, AVG(cpu, nenergy), AVG(tx, nenergy),
+         AVG(rx, nenergy), AVG(span_mj[0], span_n[0]), AVG(span_mj[1], span_n[1]),
+         AVG(span_mj[2], span_n[2]), AVG(span_mj[3], span_n[3]));
+  fflush(stdout);
+
+  free(pw_h);
+  free(pw_g);
+  free(hops_h);
+  free(hops_g);
+  free(queue);
+  free(heap_key);
+  free(heap_node);
+  free(edges);
+  free(minus);
+  free(udg);
+  free_graph(&g_udg);
+  free_graph(&g_plus);
+  free_graph(&g_minus);
+  clear_nodes();
+}
+/*---------------------------------------------------------------------------*/
+static void
+analyse_file(const char *mlog)
+{
+  size_t len = strlen(mlog);
+  char *dat = malloc(len + 5);
+
+  strcpy(dat, mlog);
+  if(len > 5 && strcmp(mlog + len - 5, ".mlog") == 0) {
+    dat[len - 5] = '\0';
+  }
+  strcat(dat, ".dat");
+  analyse(mlog, dat);
+  free(dat);
+}
+/*---------------------------------------------------------------------------*/
+static int
+compare_name(const void *a, const void *b)
+{
+  return strcmp(*(char * const *)a, *(char * const *)b);
+}
+/*---------------------------------------------------------------------------*/
+static void
+analyse_dir(const char *dir)
+{
+  DIR *d = opendir(dir);
+  struct dirent *e;
+  char **files = NULL;
+  int n = 0, size = 0, i;
+  size_t len;
+
+  if(d == NULL) {
+    fprintf(stderr, "mlogstat: %s: %s\n", dir, strerror(errno));
+    return;
+  }
+  while((e = readdir(d)) != NULL) {
+    len = strlen(e->d_name);
+    if(len <= 5 || strcmp(e->d_name + len - 5, ".mlog") != 0) {
+      continue;
+    }
+    if(n == size) {
+      size = size ? size * 2 : 64;
+      files = realloc(files, size * sizeof(char *));
+    }
+    files[n] = malloc(strlen(dir) + len + 2);
+    sprintf(files[n++], "%s/%s", dir, e->d_name);
+  }
+  closedir(d);
+  qsort(files, n, sizeof(char *), compare_name);
+  for(i = 0; i < n; ++i) {
+    analyse_file(files[i]);
+    free(files[i]);
+  }
+  free(files);
+}
+/*---------------------------------------------------------------------------*/
+static void
+usage(void)
+{
+  fprintf(stderr,
+          "usage: mlogstat [options] <directory|file.mlog>...\n"
+          "  -r <m>   transmitting range at full power (default 15)\n"
+          "  -m       stretch and degree over G- (symmetric links) instead of G+\n"
+          "  -s <n>   stretch from n sources at most (default 200, 0: all nodes)\n"
+          "  -t       tab separated output\n");
+  exit(2);
+}
+/*---------------------------------------------------------------------------*/
+int
+main(int argc, char **argv)
+{
+  struct stat st;
+  int c, i;
+
+  while((c = getopt(argc, argv, "r:ms:t")) != -1) {
+    switch(c) {
+    case 'r':
+      conf.range = atof(optarg);
+      break;
+    case 'm':
+      conf.minus = 1;
+      break;
+    case 's':
+      conf.sources = atoi(optarg);
+      break;
+    case 't':
+      conf.tsv = 1;
+      break;
+    default:
+      usage();
+    }
+  }
+  if(optind == argc || conf.range <= 0 || conf.sources < 0) {
+    usage();
+  }
+  header();
+  for(i = optind; i < argc; ++i) {
+    if(stat(argv[i], &st) == 0 && S_ISDIR(st.st_mode)) {
+      analyse_dir(argv[i]);
+    } else {
+      analyse_file(argv[i]);
+    }
+  }
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
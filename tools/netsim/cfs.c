@@ -0,0 +1,170 @@
+/*
+ * Copyright (c) 2015, Computer Science Department (CSD), University of Crete, and 
+ * Signal Processing Lab (SPL), Institute of Computer Science (ICS), FORTH, Greece.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of CSD, SPL/ICS-FORTH nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * 
+ */
+
+/**
+ * \file
+ *         The flash file system of a simulated mote: the CFS calls on files
+ *         kept in memory. Files are not persistent, a mote boots once.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "netsim.h"
+#include "cfs/cfs.h"
+
+/*---------------------------------------------------------------------------*/
+static struct netsim_file *
+lookup(const char *name)
+{
+  struct netsim_file *f;
+
+  for(f = netsim_current->files; f != NULL; f = f->next) {
+    if(strcmp(f->name, name) == 0) {
+      return f;
+    }
+  }
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
+static struct netsim_fd *
+descriptor(int fd)
+{
+  if(fd < 0 || fd >= NETSIM_FDS || netsim_current->fds[fd].file == NULL) {
+    return NULL;
+  }
+  return &netsim_current->fds[fd];
+}
+/*---------------------------------------------------------------------------*/
+int
+cfs_open(const char *name, int flags)
+{
+  struct netsim_file *f = lookup(name);
+  int fd;
+
+  for(fd = 0; fd < NETSIM_FDS && netsim_current->fds[fd].file != NULL; ++fd);
+  if(fd == NETSIM_FDS || (f == NULL && !(flags & (CFS_WRITE | CFS_APPEND)))) {
+    return -1;
+  }
+  if(f == NULL) {
+    f = calloc(1, sizeof(struct netsim_file));
+    f->name = strdup(name);
+    f->next = netsim_current->files;
+    netsim_current->files = f;
+  }
+  netsim_current->fds[fd].file = f;
+  netsim_current->fds[fd].flags = flags;
+  netsim_current->fds[fd].pos = flags & CFS_APPEND ? f->len : 0;
+  return fd;
+}
+/*---------------------------------------------------------------------------*/
+void
+cfs_close(int fd)
+{
+  if(descriptor(fd) != NULL) {
+    netsim_current->fds[fd].file = NULL;
+  }
+}
+/*---------------------------------------------------------------------------*/
+int
+cfs_read(int fd, void *buf, unsigned int len)
+{
+  struct netsim_fd *d = descriptor(fd);
+
+  if(d == NULL || !(d->flags & CFS_READ)) {
+    return -1;
+  }
+  if(len > d->file->len - d->pos) {
+    len = d->file->len - d->pos;
+  }
+  memcpy(buf, d->file->data + d->pos, len);
+  d->pos += len;
+  return len;
+}
+/*---------------------------------------------------------------------------*/
+int
+cfs_write(int fd, const void *buf, unsigned int len)
+{
+  struct netsim_fd *d = descriptor(fd);
+
+  if(d == NULL || !(d->flags & (CFS_WRITE | CFS_APPEND))) {
+    return -1;
+  }
+  if(d->pos + len > d->file->len) {
+    d->file->data = realloc(d->file->data, d->pos + len);
+    d->file->len = d->pos + len;
+  }
+  memcpy(d->file->data + d->pos, buf, len);
+  d->pos += len;
+  return len;
+}
+/*---------------------------------------------------------------------------*/
+cfs_offset_t
+cfs_seek(int fd, cfs_offset_t offset, int whence)
+{
+  struct netsim_fd *d = descriptor(fd);
+  cfs_offset_t pos;
+
+  if(d == NULL) {
+    return -1;
+  }
+  pos = whence == CFS_SEEK_END ? d->file->len + offset :
+        whence == CFS_SEEK_CUR ? d->pos + offset : offset;
+  if(pos < 0 || pos > d->file->len) {
+    return -1;
+  }
+  d->pos = pos;
+  return pos;
+}
+/*---------------------------------------------------------------------------*/
+int
+cfs_remove(const char *name)
+{
+  struct netsim_file **p, *f;
+  int fd;
+
+  for(p = &netsim_current->files; *p != NULL && strcmp((*p)->name, name) != 0; p = &(*p)->next);
+  if((f = *p) == NULL) {
+    return -1;
+  }
+  for(fd = 0; fd < NETSIM_FDS; ++fd) {
+    if(netsim_current->fds[fd].file == f) {
+      netsim_current->fds[fd].file = NULL;
+    }
+  }
+  *p = f->next;
+  free(f->name);
+  free(f->data);
+  free(f);
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) 2015, Computer Science Department (CSD), University of Crete, and 
+ * Signal Processing Lab (SPL), Institute of Computer Science (ICS), FORTH, Greece.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of CSD, SPL/ICS-FORTH nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * 
+ */
+
+/**
+ * \file
+ *         Protothreads, with the same semantics as contiki-2.7 core/sys/pt.h.
+ */
+
+#ifndef PT_H_
+#define PT_H_
+
+#include "sys/lc.h"
+
+struct pt {
+  lc_t lc;
+};
+
+#define PT_WAITING 0
+#define PT_YIELDED 1
+#define PT_EXITED  2
+#define PT_ENDED   3
+
+#define PT_THREAD(name_args) char name_args
+
+#define PT_INIT(pt)   LC_INIT((pt)->lc)
+
+#define PT_BEGIN(pt) { char PT_YIELD_FLAG = 1; if (PT_YIELD_FLAG) {;} LC_RESUME((pt)->lc)
+
+#define PT_END(pt) LC_END((pt)->lc); PT_YIELD_FLAG = 0; \
+                   PT_INIT(pt); return PT_ENDED; }
+
+#define PT_WAIT_UNTIL(pt, condition)          \
+  do {                                        \
+    LC_SET((pt)->lc);                         \
+    if(!(condition)) {                        \
+      return PT_WAITING;                      \
+    }                                         \
+  } while(0)
+
+#define PT_WAIT_WHILE(pt, cond)  PT_WAIT_UNTIL((pt), !(cond))
+
+#define PT_EXIT(pt)                           \
+  do {                                        \
+    PT_INIT(pt);                              \
+    return PT_EXITED;                         \
+  } while(0)
+
+#define PT_YIELD(pt)                          \
+  do {                                        \
+    PT_YIELD_FLAG = 0;                        \
+    LC_SET((pt)->lc);                         \
+    if(PT_YIELD_FLAG == 0) {                  \
+      return PT_YIELDED;                      \
+    }                                         \
+  } while(0)
+
+#define PT_YIELD_UNTIL(pt, cond)              \
+  do {                                        \
+    PT_YIELD_FLAG = 0;                        \
+    LC_SET((pt)->lc);                         \
+    if((PT_YIELD_FLAG == 0) || !(cond)) {     \
+      return PT_YIELDED;                      \
+    }                                         \
+  } while(0)
+
+#endif /* PT_H_ */
@@ -0,0 +1,202 @@
+/*
+ * Copyright (c) 2015, Computer Science Department (CSD), University of Crete, and 
+ * Signal Processing Lab (SPL), Institute of Computer Science (ICS), FORTH, Greece.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of CSD, SPL/ICS-FORTH nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * 
+ */
+
+/**
+ * \file
+ *         The motes log (.mlog). This is a port of the message handling in
+ *         LMST/scenario.js, so that a netsim run and a Cooja run of the same
+ *         deployment produce logs of the same layout.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "netsim.h"
+
+static const char *messages[] = {
+  "DELAUNAY", "INITIALIZE", "REDELCA", "POWER", "MEMORY", "NEIGHBOR",
+  "TEST", "ENERGY_CPU", "ENERGY_TX", "ENERGY_RX", "DONE", "PROFILE", "ENERGY ",
+  "KLMST", NULL
+};
+
+static int motes_done;
+static const char *exception;
+
+/*---------------------------------------------------------------------------*/
+static int
+starts_with(const char *msg, const char *prefix)
+{
+  return strncmp(msg, prefix, strlen(prefix)) == 0;
+}
+/*---------------------------------------------------------------------------*/
+static void
+append(struct netsim_mote *m, const char *str, size_t len)
+{
+  if(m->rowlen + len + 1 > (size_t)m->rowsize) {
+    m->rowsize = (m->rowlen + len + 1) * 2;
+    m->row = realloc(m->row, m->rowsize);
+  }
+  memcpy(m->row + m->rowlen, str, len);
+  m->rowlen += len;
+  m->row[m->rowlen] = '\0';
+}
+/*---------------------------------------------------------------------------*/
+/* Appends "#"+msg, with the id of the mote after the first word, to the comments */
+static void
+comment(struct netsim_mote *m, const char *msg)
+{
+  size_t len = strcspn(msg, " "), old = m->comments ? strlen(m->comments) : 0;
+  char *c = realloc(m->comments, old + strlen(msg) + 16);
+
+  if(c == NULL) {
+    return;
+  }
+  sprintf(c + old, "#%.*s %u%s\n", (int)len, msg, m->id, msg + len);
+  m->comments = c;
+}
+/*---------------------------------------------------------------------------*/
+/* Appends ","+msg.split(" ")[1] */
+static void
+append_value(struct netsim_mote *m, const char *msg)
+{
+  const char *v = strchr(msg, ' ');
+  size_t len;
+
+  append(m, ",", 1);
+  if(v == NULL) {
+    append(m, "undefined", 9);
+    return;
+  }
+  v++;
+  len = strcspn(v, " ");
+  append(m, v, len);
+}
+/*---------------------------------------------------------------------------*/
+/* Appends the time of a message, as min:sec.mse */
+static void
+append_time(struct netsim_mote *m, netsim_time_t t)
+{
+  char buf[64];
+  unsigned long long time = t / 1000;
+  unsigned long min, sec, mse;
+
+  min = (unsigned long)(time / 60000000);
+  sec = (unsigned long)((time - min * 60000000ULL) / 1000000);
+  mse = (unsigned long)((time - min * 60000000ULL - sec * 1000000ULL) / 1000);
+  snprintf(buf, sizeof(buf), ",%lu:%s%lu.%s%lu", min, sec < 10 ? "0" : "", sec,
+           mse < 10 ? "00" : (mse < 100 ? "0" : ""), mse);
+  append(m, buf, strlen(buf));
+}
+/*---------------------------------------------------------------------------*/
+void
+netsim_mlog_init(void)
+{
+  char buf[16];
+  int i;
+
+  for(i = 0; i < netsim_nmotes; ++i) {
+    snprintf(buf, sizeof(buf), "%u", netsim_motes[i].id);
+    append(&netsim_motes[i], buf, strlen(buf));
+  }
+}
+/*---------------------------------------------------------------------------*/
+void
+netsim_mlog_message(struct netsim_mote *m, const char *msg, netsim_time_t time)
+{
+  int i;
+
+  /* shell replies (common/shell.h), and whatever a mote says after its
+     DONE (e.g., a computation run again from the shell), are not logged */
+  if(exception != NULL || m->done || starts_with(msg, "> ")) {
+    return;
+  }
+  for(i = 0; messages[i] != NULL && !starts_with(msg, messages[i]); ++i);
+  if(messages[i] == NULL) {
+    exception = "Something went terribly wrong - Execution failure";
+    return;
+  }
+
+  if(starts_with(msg, "DONE")) {
+    if(!m->done) {
+      m->done = 1;
+      motes_done++;
+    }
+    return;
+  }
+  if(starts_with(msg, "PROFILE") || starts_with(msg, "ENERGY ") ||
+     starts_with(msg, "KLMST")) {
+    /* kept aside, written as a "#<TYPE> <id> ..." line after the rows */
+    comment(m, msg);
+    return;
+  }
+  if(starts_with(msg, "NEIGHBOR") || starts_with(msg, "MEMORY") ||
+     starts_with(msg, "ENERGY_CPU") || starts_with(msg, "ENERGY_TX") ||
+     starts_with(msg, "ENERGY_RX")) {
+    append_value(m, msg);
+    return;
+  }
+  if(starts_with(msg, "INITIALIZE") || starts_with(msg, "REDELCA")) {
+    append_value(m, msg);
+  }
+  append_time(m, time);
+  if(starts_with(msg, "POWER")) {
+    append_value(m, msg);
+  }
+}
+/*---------------------------------------------------------------------------*/
+int
+netsim_mlog_status(int *done)
+{
+  *done = motes_done;
+  return exception != NULL || motes_done == netsim_nmotes;
+}
+/*---------------------------------------------------------------------------*/
+void
+netsim_mlog_write(FILE *f, int success)
+{
+  int i;
+
+  fprintf(f, "#All motes up and running\n#ID, DELAUNAY start time, INITIALIZATION start time, REDELCA start time, REDELCA end time, POWER, PEAK MEMORY ALLOCATION, NEIGHBORS...\n");
+  if(exception != NULL) {
+    fprintf(f, "#Exception: %s\n", exception);
+  }
+  for(i = 0; i < netsim_nmotes; ++i) {
+    fprintf(f, "%s\n", netsim_motes[i].row);
+  }
+  for(i = 0; i < netsim_nmotes; ++i) {
+    if(netsim_motes[i].comments != NULL) {
+      fputs(netsim_motes[i].comments, f);
+    }
+  }
+  fprintf(f, success || exception != NULL ? "#Simulation success\n" : "#Simulation timeout\n");
+}
+/*---------------------------------------------------------------------------*/
@@ -0,0 +1,514 @@
+/*
+ * Copyright (c) 2015, Computer Science Department (CSD), University of Crete, and 
+ * Signal Processing Lab (SPL), Institute of Computer Science (ICS), FORTH, Greece.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of CSD, SPL/ICS-FORTH nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * 
+ */
+
+/**
+ * \file
+ *         The Contiki kernel services of a simulated mote: processes,
+ *         event timers, clocks, random numbers, Energest, the serial line,
+ *         the console and the heap.
+ */
+
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "netsim.h"
+#include "dev/serial-line.h"
+#include "random.h"
+#include "cc2420.h"
+#include "telemetry.h"
+
+struct netsim_post {
+  struct process *p;
+  process_event_t ev;
+  process_data_t data;
+};
+
+struct process *process_current;
+process_event_t serial_line_event_message = PROCESS_EVENT_MAX;
+
+rimeaddr_t rimeaddr_node_addr;
+const rimeaddr_t rimeaddr_null = { { 0, 0 } };
+
+/*---------------------------------------------------------------------------*/
+unsigned long
+netsim_ticks(netsim_time_t ns)
+{
+  return (unsigned long)(ns * RTIMER_SECOND / NETSIM_SECOND);
+}
+/*---------------------------------------------------------------------------*/
+static void
+exit_process(struct process *p, struct process *fromprocess)
+{
+  struct process *q;
+  struct process *old_current = process_current;
+
+  if(!process_is_running(p)) {
+    return;
+  }
+  p->state = 0;
+
+  for(q = netsim_current->processes; q != NULL; q = q->next) {
+    if(p != q) {
+      process_current = q;
+      q->thread(&q->pt, PROCESS_EVENT_EXITED, (process_data_t)p);
+    }
+  }
+
+  if(p->thread != NULL && p != fromprocess) {
+    process_current = p;
+    p->thread(&p->pt, PROCESS_EVENT_EXIT, NULL);
+  }
+
+  if(p == netsim_current->processes) {
+    netsim_current->processes = netsim_current->processes->next;
+  } else {
+    for(q = netsim_current->processes; q != NULL; q = q->next) {
+      if(q->next == p) {
+        q->next = p->next;
+        break;
+      }
+    }
+  }
+  process_current = old_current;
+}
+/*---------------------------------------------------------------------------*/
+static void
+call_process(struct process *p, process_event_t ev, process_data_t data)
+{
+  int ret;
+  struct process *caller = process_current;
+
+  if(process_is_running(p) && p->thread != NULL) {
+    process_current = p;
+    ret = p->thread(&p->pt, ev, data);
+    if(ret == PT_EXITED || ret == PT_ENDED || ev == PROCESS_EVENT_EXIT) {
+      exit_process(p, p);
+    }
+  }
+  process_current = caller;
+}
+/*---------------------------------------------------------------------------*/
+static void
+deliver(struct process *p, process_event_t ev, process_data_t data)
+{
+  struct process *q, *next;
+
+  if(p == PROCESS_BROADCAST) {
+    for(q = netsim_current->processes; q != NULL; q = next) {
+      next = q->next;
+      call_process(q, ev, data);
+    }
+  } else {
+    call_process(p, ev, data);
+  }
+}
+/*---------------------------------------------------------------------------*/
+void
+process_start(struct process *p, const char *arg)
+{
+  struct process *q;
+
+  for(q = netsim_current->processes; q != p && q != NULL; q = q->next);
+  if(q == p) {
+    return;
+  }
+  p->next = netsim_current->processes;
+  netsim_current->processes = p;
+  p->state = 1;
+  PT_INIT(&p->pt);
+  call_process(p, PROCESS_EVENT_INIT, (process_data_t)arg);
+}
+/*---------------------------------------------------------------------------*/
+int
+process_is_running(struct process *p)
+{
+  return p->state != 0;
+}
+/*---------------------------------------------------------------------------*/
+void
+process_exit(struct process *p)
+{
+  exit_process(p, process_current);
+}
+/*---------------------------------------------------------------------------*/
+int
+process_post(struct process *p, process_event_t ev, process_data_t data)
+{
+  struct netsim_post *post = malloc(sizeof(struct netsim_post));
+
+  post->p = p;
+  post->ev = ev;
+  post->data = data;
+  netsim_schedule(netsim_time(), NETSIM_EV_POST, netsim_current, post, 0);
+  return PROCESS_ERR_OK;
+}
+/*---------------------------------------------------------------------------*/
+void
+process_post_synch(struct process *p, process_event_t ev, process_data_t data)
+{
+  call_process(p, ev, data);
+}
+/*---------------------------------------------------------------------------*/
+void
+process_poll(struct process *p)
+{
+  process_post(p, PROCESS_EVENT_POLL, NULL);
+}
+/*---------------------------------------------------------------------------*/
+process_event_t
+process_alloc_event(void)
+{
+  return netsim_current->lastevent++;
+}
+/*---------------------------------------------------------------------------*/
+void
+netsim_mote_post(void *ptr)
+{
+  struct netsim_post *post = ptr;
+
+  deliver(post->p, post->ev, post->data);
+  free(post);
+}
+/*---------------------------------------------------------------------------*/
+void
+netsim_mote_boot(struct netsim_mote *m)
+{
+  int i;
+
+  rimeaddr_node_addr = m->addr;
+  /* The Z1 platform seeds every mote alike; in Cooja all motes draw the
+     same random sequence, and so do they here. */
+  random_init(0);
+  netsim_radio_set(m, 1);
+  for(i = 0; autostart_processes[i] != NULL; ++i) {
+    process_start(autostart_processes[i], NULL);
+  }
+}
+/*---------------------------------------------------------------------------*/
+void
+netsim_mote_serial(struct netsim_mote *m, char *line)
+{
+  deliver(PROCESS_BROADCAST, serial_line_event_message, line);
+}
+/*---------------------------------------------------------------------------*/
+clock_time_t
+clock_time(void)
+{
+  return (clock_time_t)((netsim_time() - netsim_current->boot) / NETSIM_CLOCK_TICK);
+}
+/*---------------------------------------------------------------------------*/
+unsigned long
+clock_seconds(void)
+{
+  return (unsigned long)((netsim_time() - netsim_current->boot) / NETSIM_SECOND);
+}
+/*---------------------------------------------------------------------------*/
+rtimer_clock_t
+rtimer_arch_now(void)
+{
+  return (rtimer_clock_t)netsim_ticks(netsim_time() - netsim_current->boot);
+}
+/*---------------------------------------------------------------------------*/
+static void
+etimer_schedule(struct etimer *et)
+{
+  netsim_time_t t;
+
+  et->p = process_current;
+  et->seq = ++netsim_current->timer_seq;
+  t = netsim_current->boot + (et->start + et->interval) * NETSIM_CLOCK_TICK;
+  if(t < netsim_time()) {
+    t = netsim_time();
+  }
+  netsim_schedule(t, NETSIM_EV_TIMER, netsim_current, et, et->seq);
+}
+/*---------------------------------------------------------------------------*/
+void
+etimer_set(struct etimer *et, clock_time_t interval)
+{
+  et->start = clock_time();
+  et->interval = interval;
+  etimer_schedule(et);
+}
+/*---------------------------------------------------------------------------*/
+void
+etimer_reset(struct etimer *et)
+{
+  et->start += et->interval;
+  etimer_schedule(et);
+}
+/*---------------------------------------------------------------------------*/
+void
+etimer_restart(struct etimer *et)
+{
+  et->start = clock_time();
+  etimer_schedule(et);
+}
+/*---------------------------------------------------------------------------*/
+void
+etimer_stop(struct etimer *et)
+{
+  et->p = PROCESS_NONE;
+}
+/*---------------------------------------------------------------------------*/
+int
+etimer_expired(struct etimer *et)
+{
+  return et->p == PROCESS_NONE;
+}
+/*---------------------------------------------------------------------------*/
+void
+netsim_mote_timer(struct etimer *et, unsigned long seq)
+{
+  struct process *p = et->p;
+
+  /* A timer that was stopped or set again since is stale. */
+  if(p == PROCESS_NONE || et->seq != seq) {
+    return;
+  }
+  et->p = PROCESS_NONE;
+  deliver(p, PROCESS_EVENT_TIMER, et);
+}
+/*---------------------------------------------------------------------------*/
+void
+random_init(unsigned short seed)
+{
+  netsim_current->rand = seed ^ (uint32_t)netsim_conf.seed;
+}
+/*---------------------------------------------------------------------------*/
+unsigned short
+random_rand(void)
+{
+  return netsim_rand(netsim_current);
+}
+/*---------------------------------------------------------------------------*/
+unsigned long
+energest_type_time(int type)
+{
+  struct netsim_mote *m = netsim_current;
+  netsim_time_t now = netsim_time();
+  netsim_time_t on = m->radio_total;
+
+  if(m->radio_on) {
+    on += now - m->radio_since;
+  }
+  switch(type) {
+  case ENERGEST_TYPE_CPU:
+    return netsim_ticks(m->cpu_total);
+  case ENERGEST_TYPE_LPM:
+    return netsim_ticks(now - m->boot - m->cpu_total);
+  case ENERGEST_TYPE_TRANSMIT:
+    return netsim_ticks(m->tx_total);
+  case ENERGEST_TYPE_LISTEN:
+    return netsim_ticks(on > m->tx_total ? on - m->tx_total : 0);
+  }
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+void
+cc2420_set_txpower(unsigned char power)
+{
+  netsim_current->txpower = power & 0x1f;
+}
+/*---------------------------------------------------------------------------*/
+int
+cc2420_get_txpower(void)
+{
+  return netsim_current->txpower;
+}
+/*---------------------------------------------------------------------------*/
+void
+rimeaddr_copy(rimeaddr_t *dest, const rimeaddr_t *src)
+{
+  *dest = *src;
+}
+/*---------------------------------------------------------------------------*/
+int
+rimeaddr_cmp(const rimeaddr_t *addr1, const rimeaddr_t *addr2)
+{
+  return addr1->u8[0] == addr2->u8[0] && addr1->u8[1] == addr2->u8[1];
+}
+/*---------------------------------------------------------------------------*/
+void
+rimeaddr_set_node_addr(rimeaddr_t *addr)
+{
+  rimeaddr_node_addr = *addr;
+}
+/*---------------------------------------------------------------------------*/
+/*
+ * Console. Characters are collected per mote and every complete line is
+ * time-stamped and handed over to the motes log, as Cooja does for the
+ * serial output of its motes. Telemetry frames are decoded into the text
+ * line they stand for, time-stamped with the local time of the mote.
+ */
+int
+netsim_putchar(int c)
+{
+  struct netsim_mote *m = netsim_current;
+  struct telemetry_record r;
+  char text[2 * NETSIM_LINE];
+  const char *msg = m->line;
+  netsim_time_t t;
+
+  if(c == '\n') {
+    m->line[m->linelen] = '\0';
+    t = netsim_time();
+    if(telemetry_decode(m->line, m->linelen, &r) == 0) {
+      telemetry_format(&r, text, sizeof(text));
+      msg = text;
+      t = m->boot + r.time * NETSIM_CLOCK_TICK;
+    }
+    if(netsim_conf.log != NULL) {
+      fprintf(netsim_conf.log, "%llu\tID:%u\t%s\n",
+              (unsigned long long)(t / 1000000), m->id, msg);
+    }
+    netsim_mlog_message(m, msg, t);
+    m->linelen = 0;
+  } else if(c != '\r' && m->linelen < NETSIM_LINE - 1) {
+    m->line[m->linelen++] = c;
+  }
+  return c;
+}
+/*---------------------------------------------------------------------------*/
+int
+netsim_printf(const char *fmt, ...)
+{
+  char buf[NETSIM_LINE];
+  va_list ap;
+  int i, len;
+
+  va_start(ap, fmt);
+  len = vsnprintf(buf, sizeof(buf), fmt, ap);
+  va_end(ap);
+  for(i = 0; i < len && i < (int)sizeof(buf) - 1; ++i) {
+    netsim_putchar((unsigned char)buf[i]);
+  }
+  return len;
+}
+/*---------------------------------------------------------------------------*/
+/*
+ * Heap. The firmwares were written against the forgiving msp430 libc and
+ * occasionally free() pointers they never allocated, or free the same
+ * block twice. Live blocks are therefore tracked, unknown pointers are
+ * ignored, and released blocks are never handed out again so that a stale
+ * pointer can not alias a newer allocation.
+ */
+static void **heap_live;
+static size_t heap_size, heap_used;
+
+static size_t
+heap_slot(void *ptr)
+{
+  return (size_t)(((uintptr_t)ptr >> 4) * 2654435761u) & (heap_size - 1);
+}
+/*---------------------------------------------------------------------------*/
+static void
+heap_insert(void *ptr)
+{
+  void **old = heap_live;
+  size_t i, n = heap_size;
+
+  if((heap_used + 1) * 2 > heap_size) {
+    heap_size = heap_size ? heap_size * 2 : 1024;
+    heap_live = calloc(heap_size, sizeof(void *));
+    heap_used = 0;
+    for(i = 0; i < n; ++i) {
+      if(old[i] != NULL && old[i] != (void *)old) {
+        heap_insert(old[i]);
+      }
+    }
+    free(old);
+  }
+  for(i = heap_slot(ptr); heap_live[i] != NULL; i = (i + 1) & (heap_size - 1));
+  heap_live[i] = ptr;
+  heap_used++;
+}
+/*---------------------------------------------------------------------------*/
+static int
+heap_release(void *ptr)
+{
+  size_t i;
+
+  if(ptr == NULL || heap_size == 0) {
+    return 0;
+  }
+  for(i = heap_slot(ptr); heap_live[i] != NULL; i = (i + 1) & (heap_size - 1)) {
+    if(heap_live[i] == ptr) {
+      /* Tombstone: keeps the probe chain intact. */
+      heap_live[i] = (void *)heap_live;
+      return 1;
+    }
+  }
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+void *
+netsim_malloc(size_t size)
+{
+  void *ptr = malloc(size ? size : 1);
+
+  if(ptr != NULL) {
+    heap_insert(ptr);
+  }
+  return ptr;
+}
+/*---------------------------------------------------------------------------*/
+void *
+netsim_calloc(size_t nmemb, size_t size)
+{
+  void *ptr = netsim_malloc(nmemb * size);
+
+  if(ptr != NULL) {
+    memset(ptr, 0, nmemb * size);
+  }
+  return ptr;
+}
+/*---------------------------------------------------------------------------*/
+void
+netsim_free(void *ptr)
+{
+  heap_release(ptr);
+}
+/*---------------------------------------------------------------------------*/
+char *
+netsim_strdup(const char *s)
+{
+  size_t len = strlen(s) + 1;
+  char *d = netsim_malloc(len);
+
+  if(d != NULL) {
+    memcpy(d, s, len);
+  }
+  return d;
+}
+/*---------------------------------------------------------------------------*/
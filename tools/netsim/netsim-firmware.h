@@ -0,0 +1,62 @@
+/*
+ * Copyright (c) 2015, Computer Science Department (CSD), University of Crete, and 
+ * Signal Processing Lab (SPL), Institute of Computer Science (ICS), FORTH, Greece.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of CSD, SPL/ICS-FORTH nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * 
+ */
+
+/**
+ * \file
+ *         Forced include for firmware sources compiled into the simulator
+ *         (gcc -include). Heap and console calls are routed to the
+ *         simulator so that every mote gets its own heap bookkeeping and
+ *         its own console line, without touching the firmware sources.
+ */
+
+#ifndef NETSIM_FIRMWARE_H_
+#define NETSIM_FIRMWARE_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+int   netsim_printf(const char *fmt, ...);
+int   netsim_putchar(int c);
+void *netsim_malloc(size_t size);
+void *netsim_calloc(size_t nmemb, size_t size);
+void  netsim_free(void *ptr);
+char *netsim_strdup(const char *s);
+
+#define printf  netsim_printf
+#define putchar netsim_putchar
+#define malloc  netsim_malloc
+#define calloc  netsim_calloc
+#define free    netsim_free
+#define strdup  netsim_strdup
+
+#endif /* NETSIM_FIRMWARE_H_ */
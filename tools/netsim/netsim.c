@@ -0,0 +1,462 @@
+/*
+ * Copyright (c) 2015, Computer Science Department (CSD), University of Crete, and 
+ * Signal Processing Lab (SPL), Institute of Computer Science (ICS), FORTH, Greece.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of CSD, SPL/ICS-FORTH nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * 
+ */
+
+/**
+ * \file
+ *         netsim: a headless discrete-event simulator that runs the
+ *         topology control firmwares natively on the host.
+ *
+ *         The simulator reads a deployment (.dat, "<id>,<x>,<y>" per line),
+ *         boots one mote per line, writes every mote its coordinates over
+ *         the serial line exactly like scenario.js does, and produces the
+ *         same motes log (.mlog) as the Cooja scenario.
+ */
+
+#include <errno.h>
+#include <getopt.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "netsim.h"
+
+/* Random start-up delay of the motes, as <motedelay_us> in the .csc files. */
+#define MOTE_DELAY          NETSIM_SECOND
+
+struct netsim_event {
+  netsim_time_t time;
+  unsigned long long seq;
+  int type;
+  struct netsim_mote *mote;
+  void *ptr;
+  unsigned long arg;
+};
+
+struct netsim_config netsim_conf = {
+  1,                     /* seed */
+  15.0,                  /* range: <transmitting_range> */
+  2.0,                   /* interference: <interference_range> / range */
+  1.0,                   /* cpu_scale */
+  1800 * NETSIM_SECOND,  /* duration */
+  NULL                   /* log */
+};
+
+struct netsim_mote *netsim_motes;
+int netsim_nmotes;
+struct netsim_mote *netsim_current;
+
+extern unsigned char __start_netsim_data[] __attribute__((weak));
+extern unsigned char __stop_netsim_data[] __attribute__((weak));
+extern unsigned char __start_netsim_bss[] __attribute__((weak));
+extern unsigned char __stop_netsim_bss[] __attribute__((weak));
+
+static size_t data_size, bss_size;
+static unsigned char *pristine;
+static struct netsim_mote *resident;
+
+static struct netsim_event *queue;
+static size_t queue_len, queue_size;
+static unsigned long long queue_seq;
+static netsim_time_t now;
+
+static struct timespec cpu_start;
+static uint32_t sim_rand;
+
+/*---------------------------------------------------------------------------*/
+static int
+event_before(const struct netsim_event *a, const struct netsim_event *b)
+{
+  return a->time < b->time || (a->time == b->time && a->seq < b->seq);
+}
+/*---------------------------------------------------------------------------*/
+void
+netsim_schedule(netsim_time_t t, int type, struct netsim_mote *m,
+                void *ptr, unsigned long arg)
+{
+  struct netsim_event e;
+  size_t i, parent;
+
+  if(queue_len == queue_size) {
+    queue_size = queue_size ? queue_size * 2 : 1024;
+    queue = realloc(queue, queue_size * sizeof(struct netsim_event));
+  }
+  e.time = t < now ? now : t;
+  e.seq = queue_seq++;
+  e.type = type;
+  e.mote = m;
+  e.ptr = ptr;
+  e.arg = arg;
+  for(i = queue_len++; i > 0; i = parent) {
+    parent = (i - 1) / 2;
+    if(!event_before(&e, &queue[parent])) {
+      break;
+    }
+    queue[i] = queue[parent];
+  }
+  queue[i] = e;
+}
+/*---------------------------------------------------------------------------*/
+static struct netsim_event
+next_event(void)
+{
+  struct netsim_event top = queue[0], last = queue[--queue_len];
+  size_t i = 0, child;
+
+  while((child = 2 * i + 1) < queue_len) {
+    if(child + 1 < queue_len && event_before(&queue[child + 1], &queue[child])) {
+      child++;
+    }
+    if(!event_before(&queue[child], &last)) {
+      break;
+    }
+    queue[i] = queue[child];
+    i = child;
+  }
+  queue[i] = last;
+  return top;
+}
+/*---------------------------------------------------------------------------*/
+unsigned short
+netsim_rand(struct netsim_mote *m)
+{
+  uint32_t *state = m != NULL ? &m->rand : &sim_rand;
+
+  *state = *state * 1103515245u + 12345u;
+  return (unsigned short)(*state >> 16);
+}
+/*---------------------------------------------------------------------------*/
+static netsim_time_t
+cpu_elapsed(void)
+{
+  struct timespec ts;
+  double ns;
+
+  if(netsim_conf.cpu_scale <= 0) {
+    return 0;
+  }
+  clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+  ns = (ts.tv_sec - cpu_start.tv_sec) * 1e9 + (ts.tv_nsec - cpu_start.tv_nsec);
+  return (netsim_time_t)(ns * netsim_conf.cpu_scale);
+}
+/*---------------------------------------------------------------------------*/
+netsim_time_t
+netsim_time(void)
+{
+  if(netsim_current == NULL) {
+    return now;
+  }
+  return netsim_current->now + cpu_elapsed();
+}
+/*---------------------------------------------------------------------------*/
+void
+netsim_activate(struct netsim_mote *m, netsim_time_t t)
+{
+  if(resident != m) {
+    if(resident != NULL) {
+      memcpy(resident->image, __start_netsim_data, data_size);
+      memcpy(resident->image + data_size, __start_netsim_bss, bss_size);
+    }
+    memcpy(__start_netsim_data, m->image, data_size);
+    memcpy(__start_netsim_bss, m->image + data_size, bss_size);
+    resident = m;
+  }
+  rimeaddr_node_addr = m->addr;
+  m->now = t > m->busy_until ? t : m->busy_until;
+  netsim_current = m;
+  if(netsim_conf.cpu_scale > 0) {
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &cpu_start);
+  }
+}
+/*---------------------------------------------------------------------------*/
+void
+netsim_deactivate(void)
+{
+  struct netsim_mote *m = netsim_current;
+  netsim_time_t cpu = cpu_elapsed();
+
+  m->cpu_total += cpu;
+  m->busy_until = m->now + cpu;
+  netsim_current = NULL;
+}
+/*---------------------------------------------------------------------------*/
+static void
+load_deployment(const char *file)
+{
+  FILE *f = fopen(file, "r");
+  char line[256];
+  struct netsim_mote *m;
+  unsigned id;
+  double x, y;
+  int size = 0;
+
+  if(f == NULL) {
+    fprintf(stderr, "netsim: unable to open data file %s: %s\n", file, strerror(errno));
+    exit(1);
+  }
+  while(fgets(line, sizeof(line), f) != NULL) {
+    if(sscanf(line, " %u , %lf , %lf", &id, &x, &y) != 3) {
+      continue;
+    }
+    if(netsim_nmotes == size) {
+      size = size ? size * 2 : 64;
+      netsim_motes = realloc(netsim_motes, size * sizeof(struct netsim_mote));
+    }
+    m = &netsim_motes[netsim_nmotes++];
+    memset(m, 0, sizeof(struct netsim_mote));
+    m->id = id;
+    m->x = x;
+    m->y = y;
+    m->addr.u8[0] = id & 0xff;
+    m->addr.u8[1] = id >> 8;
+    m->lastevent = PROCESS_EVENT_MAX + 1;
+    m->txpower = 31;
+  }
+  fclose(f);
+  if(netsim_nmotes == 0) {
+    fprintf(stderr, "netsim: no motes in %s\n", file);
+    exit(1);
+  }
+}
+/*---------------------------------------------------------------------------*/
+/*
+ * Coordinates are written the way the JavaScript engine of Cooja prints a
+ * double: the shortest representation that reads back to the same value.
+ * A decimal point is always kept, str2float() in the firmwares relies on it.
+ */
+static void
+format_coordinate(char *buf, size_t size, double v)
+{
+  int prec;
+
+  for(prec = 1; prec < 17; ++prec) {
+    snprintf(buf, size, "%.*f", prec, v);
+    if(strtod(buf, NULL) == v) {
+      break;
+    }
+  }
+  while(prec > 1 && buf[strlen(buf) - 1] == '0') {
+    buf[strlen(buf) - 1] = '\0';
+    prec--;
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Schedules a -x command (<s>,<id>,<command>) on the serial line of its motes */
+static void
+schedule_command(const char *arg, netsim_time_t *until)
+{
+  char id[16];
+  double s;
+  int n = 0, i;
+  netsim_time_t t;
+
+  if(sscanf(arg, "%lf , %15[^,] ,%n", &s, id, &n) != 2 || n == 0 || s < 0) {
+    fprintf(stderr, "netsim: bad command %s\n", arg);
+    exit(2);
+  }
+  t = (netsim_time_t)(s * NETSIM_SECOND);
+  for(i = 0; i < netsim_nmotes; ++i) {
+    if(strcmp(id, "*") == 0 || (unsigned)atoi(id) == netsim_motes[i].id) {
+      netsim_schedule(t, NETSIM_EV_SERIAL, &netsim_motes[i], strdup(arg + n), 0);
+    }
+  }
+  /* a second for the replies */
+  if(t + NETSIM_SECOND > *until) {
+    *until = t + NETSIM_SECOND;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+usage(void)
+{
+  fprintf(stderr,
+          "usage: netsim [options] <deployment.dat>\n"
+          "  -o <file>   motes log to write (default: <deployment>.mlog)\n"
+          "  -l <file>   also write every console line of every mote\n"
+          "  -s <seed>   random seed (default 1)\n"
+          "  -r <m>      transmitting range at full power (default 15)\n"
+          "  -i <ratio>  interference range / transmitting range (default 2)\n"
+          "  -t <s>      simulated time limit in seconds (default 1800)\n"
+          "  -c <scale>  host CPU time to mote CPU time factor; 0 makes the\n"
+          "              simulation deterministic (default 1)\n"
+          "  -x <s>,<id>,<command>\n"
+          "              write a command line to the serial line of mote id (* for\n"
+          "              all) at s seconds; the run lasts at least until then\n");
+  exit(2);
+}
+/*---------------------------------------------------------------------------*/
+int
+main(int argc, char **argv)
+{
+  const char *mlogfile = NULL;
+  char *title, *p, x[32], y[32];
+  struct netsim_event e;
+  struct netsim_mote *m;
+  FILE *f;
+  clock_t wall = clock();
+  int c, i, done, success;
+  char **commands = NULL;
+  int ncommands = 0;
+  netsim_time_t until = 0;
+
+  while((c = getopt(argc, argv, "o:l:s:r:i:t:c:x:")) != -1) {
+    switch(c) {
+    case 'x':
+      commands = realloc(commands, (ncommands + 1) * sizeof(char *));
+      commands[ncommands++] = optarg;
+      break;
+    case 'o':
+      mlogfile = optarg;
+      break;
+    case 'l':
+      if((netsim_conf.log = fopen(optarg, "w")) == NULL) {
+        fprintf(stderr, "netsim: unable to open %s\n", optarg);
+        return 1;
+      }
+      break;
+    case 's':
+      netsim_conf.seed = strtoul(optarg, NULL, 0);
+      break;
+    case 'r':
+      netsim_conf.range = atof(optarg);
+      break;
+    case 'i':
+      netsim_conf.interference = atof(optarg);
+      break;
+    case 't':
+      netsim_conf.duration = (netsim_time_t)(atof(optarg) * NETSIM_SECOND);
+      break;
+    case 'c':
+      netsim_conf.cpu_scale = atof(optarg);
+      break;
+    default:
+      usage();
+    }
+  }
+  if(optind != argc - 1) {
+    usage();
+  }
+
+  load_deployment(argv[optind]);
+  sim_rand = (uint32_t)netsim_conf.seed;
+
+  /* Snapshot of the initial firmware image, shared by all motes. */
+  data_size = __stop_netsim_data - __start_netsim_data;
+  bss_size = __stop_netsim_bss - __start_netsim_bss;
+  pristine = malloc(data_size + bss_size + 1);
+  memcpy(pristine, __start_netsim_data, data_size);
+  memset(pristine + data_size, 0, bss_size);
+  for(i = 0; i < netsim_nmotes; ++i) {
+    m = &netsim_motes[i];
+    m->image = malloc(data_size + bss_size + 1);
+    memcpy(m->image, pristine, data_size + bss_size);
+    m->boot = (netsim_time_t)netsim_rand(NULL) * MOTE_DELAY / 65536;
+    netsim_schedule(m->boot, NETSIM_EV_BOOT, m, NULL, 0);
+    format_coordinate(x, sizeof(x), m->x);
+    format_coordinate(y, sizeof(y), m->y);
+    snprintf(m->serial, sizeof(m->serial), "%s#%s", x, y);
+    netsim_schedule(MOTE_DELAY, NETSIM_EV_SERIAL, m, NULL, 0);
+  }
+  for(c = 0; c < ncommands; ++c) {
+    schedule_command(commands[c], &until);
+  }
+  free(commands);
+  netsim_radio_init();
+  netsim_mlog_init();
+
+  done = 0;
+  success = 0;
+  while(queue_len > 0) {
+    e = next_event();
+    if(e.time > netsim_conf.duration) {
+      break;
+    }
+    now = e.time;
+    netsim_activate(e.mote, e.time);
+    switch(e.type) {
+    case NETSIM_EV_BOOT:
+      netsim_mote_boot(e.mote);
+      break;
+    case NETSIM_EV_SERIAL:
+      netsim_mote_serial(e.mote, e.ptr != NULL ? e.ptr : e.mote->serial);
+      break;
+    case NETSIM_EV_TIMER:
+      netsim_mote_timer(e.ptr, e.arg);
+      break;
+    case NETSIM_EV_POST:
+      netsim_mote_post(e.ptr);
+      break;
+    case NETSIM_EV_TX:
+      netsim_radio_tx(e.ptr);
+      break;
+    case NETSIM_EV_RX:
+      netsim_radio_rx(e.ptr);
+      break;
+    }
+    netsim_deactivate();
+    if(netsim_mlog_status(&done) != 0 && now >= until) {
+      success = done == netsim_nmotes;
+      break;
+    }
+  }
+  if(!success && netsim_mlog_status(&done) != 0) {
+    /* the queue ran dry while waiting for the commands */
+    success = done == netsim_nmotes;
+  }
+
+  if(mlogfile == NULL) {
+    title = strdup(argv[optind]);
+    if((p = strrchr(title, '/')) != NULL) {
+      memmove(title, p + 1, strlen(p + 1) + 1);
+    }
+    if((p = strrchr(title, '.')) != NULL) {
+      *p = '\0';
+    }
+    p = malloc(strlen(title) + 6);
+    sprintf(p, "%s.mlog", title);
+    mlogfile = p;
+  }
+  if((f = fopen(mlogfile, "w")) == NULL) {
+    fprintf(stderr, "netsim: unable to write %s\n", mlogfile);
+    return 1;
+  }
+  netsim_mlog_write(f, success);
+  fclose(f);
+  if(netsim_conf.log != NULL) {
+    fclose(netsim_conf.log);
+  }
+
+  fprintf(stderr, "netsim: %d motes, %d done, %.3f s simulated in %.3f s\n",
+          netsim_nmotes, done, (double)now / NETSIM_SECOND,
+          (double)(clock() - wall) / CLOCKS_PER_SEC);
+  return success ? 0 : 1;
+}
+/*---------------------------------------------------------------------------*/
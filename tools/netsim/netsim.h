@@ -0,0 +1,177 @@
+/*
+ * Copyright (c) 2015, Computer Science Department (CSD), University of Crete, and 
+ * Signal Processing Lab (SPL), Institute of Computer Science (ICS), FORTH, Greece.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of CSD, SPL/ICS-FORTH nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * 
+ */
+
+/**
+ * \file
+ *         Internal interface of the netsim discrete-event simulator.
+ *
+ *         Every simulated mote owns a private copy of the firmware's
+ *         .data/.bss image (the same technique Cooja uses for its native
+ *         Contiki motes). The image of a mote is swapped in before any
+ *         firmware code runs on its behalf, so a single firmware object
+ *         can drive thousands of motes.
+ */
+
+#ifndef NETSIM_H_
+#define NETSIM_H_
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "contiki.h"
+
+/* Simulation time is kept in nanoseconds. */
+typedef uint64_t netsim_time_t;
+
+#define NETSIM_SECOND      1000000000ULL
+#define NETSIM_CLOCK_TICK  (NETSIM_SECOND / CLOCK_SECOND)
+
+#define NETSIM_LINE        256
+#define NETSIM_CONNS       4
+#define NETSIM_FDS         2
+
+enum {
+  NETSIM_EV_BOOT,
+  NETSIM_EV_SERIAL,
+  NETSIM_EV_TIMER,
+  NETSIM_EV_POST,
+  NETSIM_EV_TX,
+  NETSIM_EV_RX
+};
+
+struct netsim_rx;
+
+/* A file of the flash file system (CFS) of a mote, and an open one. */
+struct netsim_file {
+  struct netsim_file *next;
+  char *name;
+  unsigned char *data;
+  unsigned int len;
+};
+
+struct netsim_fd {
+  struct netsim_file *file;
+  unsigned int pos;
+  int flags;
+};
+
+struct netsim_mote {
+  uint16_t id;
+  double x, y;
+  rimeaddr_t addr;
+
+  /* Private copy of the firmware .data and .bss sections. */
+  unsigned char *image;
+
+  /* Contiki kernel state of the mote. */
+  struct process *processes;
+  process_event_t lastevent;
+  unsigned long timer_seq;
+  uint32_t rand;
+
+  /* Local time: boot instant, and the CPU busy horizon. */
+  netsim_time_t boot;
+  netsim_time_t now;
+  netsim_time_t busy_until;
+
+  /* Radio state. */
+  struct broadcast_conn *conns[NETSIM_CONNS];
+  uint8_t txpower;
+  uint8_t radio_on;
+  netsim_time_t radio_since;
+  netsim_time_t radio_total;
+  netsim_time_t tx_total;
+  netsim_time_t cpu_total;
+  netsim_time_t tx_until;
+  netsim_time_t channel_until;
+  struct netsim_rx *rx;
+
+  /* Flash file system. */
+  struct netsim_file *files;
+  struct netsim_fd fds[NETSIM_FDS];
+
+  /* Console. */
+  char serial[NETSIM_LINE];
+  char line[NETSIM_LINE];
+  int linelen;
+  char *row;
+  int rowlen, rowsize;
+  char *comments;
+  int done;
+
+  /* Spatial index chaining. */
+  int cell_next;
+};
+
+struct netsim_config {
+  unsigned long seed;
+  double range;
+  double interference;
+  double cpu_scale;
+  netsim_time_t duration;
+  FILE *log;
+};
+
+extern struct netsim_config netsim_conf;
+extern struct netsim_mote *netsim_motes;
+extern int netsim_nmotes;
+extern struct netsim_mote *netsim_current;
+
+/* Scheduler (netsim.c) */
+void netsim_schedule(netsim_time_t t, int type, struct netsim_mote *m,
+                     void *ptr, unsigned long arg);
+void netsim_activate(struct netsim_mote *m, netsim_time_t t);
+void netsim_deactivate(void);
+netsim_time_t netsim_time(void);
+unsigned short netsim_rand(struct netsim_mote *m);
+
+/* Contiki kernel (mote.c) */
+void netsim_mote_boot(struct netsim_mote *m);
+void netsim_mote_serial(struct netsim_mote *m, char *line);
+void netsim_mote_timer(struct etimer *et, unsigned long seq);
+void netsim_mote_post(void *post);
+unsigned long netsim_ticks(netsim_time_t ns);
+
+/* Radio medium (radio.c) */
+void netsim_radio_init(void);
+void netsim_radio_tx(void *frame);
+void netsim_radio_rx(void *rx);
+void netsim_radio_set(struct netsim_mote *m, int on);
+
+/* Motes log (mlog.c) */
+void netsim_mlog_init(void);
+void netsim_mlog_message(struct netsim_mote *m, const char *msg,
+                         netsim_time_t time);
+int netsim_mlog_status(int *done);
+void netsim_mlog_write(FILE *f, int success);
+
+#endif /* NETSIM_H_ */
@@ -0,0 +1,459 @@
+/*
+ * Copyright (c) 2015, Computer Science Department (CSD), University of Crete, and 
+ * Signal Processing Lab (SPL), Institute of Computer Science (ICS), FORTH, Greece.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of CSD, SPL/ICS-FORTH nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * 
+ */
+
+/**
+ * \file
+ *         The radio medium: a unit disk graph model (UDGM) with the same
+ *         range, signal strength and interference rules as Cooja's
+ *         se.sics.cooja.radiomediums.UDGM, a CCA/backoff MAC in the spirit
+ *         of the contiki-2.7 CSMA/nullrdc stack, the RDC on/off switch,
+ *         the Rime broadcast and unicast primitives and the packet buffer.
+ */
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "netsim.h"
+#include "cc2420.h"
+#include "net/netstack.h"
+
+/* 250 kbit/s: 32us per byte on air. */
+#define BYTE_TIME           32000ULL
+/* Bytes on air besides the Rime payload, fitted to the TRANSMIT times
+   Energest reports for the same frames under Cooja/MSPSim. */
+#define FRAME_OVERHEAD      16
+#define MAX_TRANSMISSIONS   3
+#define BACKOFF_PERIOD      (NETSIM_SECOND / 8)
+
+/* Signal strengths of the UDGM model, in dBm. */
+#define SS_STRONG           -10.0
+#define SS_WEAK             -95.0
+/* Offset between the CC2420 RSSI register and dBm. */
+#define RSSI_OFFSET         -45
+
+struct netsim_frame {
+  struct netsim_mote *src;
+  rimeaddr_t receiver;
+  uint16_t channel;
+  uint16_t len;
+  uint8_t txpower;
+  uint8_t transmissions;
+  int refs;
+  uint8_t data[PACKETBUF_SIZE];
+};
+
+struct netsim_rx {
+  struct netsim_frame *frame;
+  struct netsim_mote *dst;
+  packetbuf_attr_t rssi;
+  uint8_t corrupt;
+};
+
+static uint8_t packetbuf[PACKETBUF_SIZE + 1];
+static uint16_t buflen;
+static packetbuf_attr_t attrs[PACKETBUF_ATTR_NUM_ATTRS];
+static rimeaddr_t addrs[PACKETBUF_ADDR_NUM_ADDRS];
+
+/* Uniform grid over the deployment, one cell per interference range. */
+static double grid_x0, grid_y0, grid_cell;
+static int grid_cols, grid_rows;
+static int *grid_head;
+
+/*---------------------------------------------------------------------------*/
+void
+packetbuf_clear(void)
+{
+  buflen = 0;
+  memset(packetbuf, 0, sizeof(packetbuf));
+  packetbuf_attr_clear();
+}
+/*---------------------------------------------------------------------------*/
+void
+packetbuf_clear_hdr(void)
+{
+}
+/*---------------------------------------------------------------------------*/
+void *
+packetbuf_dataptr(void)
+{
+  return packetbuf;
+}
+/*---------------------------------------------------------------------------*/
+void *
+packetbuf_hdrptr(void)
+{
+  return packetbuf;
+}
+/*---------------------------------------------------------------------------*/
+uint16_t
+packetbuf_datalen(void)
+{
+  return buflen;
+}
+/*---------------------------------------------------------------------------*/
+uint16_t
+packetbuf_totlen(void)
+{
+  return buflen;
+}
+/*---------------------------------------------------------------------------*/
+void
+packetbuf_set_datalen(uint16_t len)
+{
+  buflen = len > PACKETBUF_SIZE ? PACKETBUF_SIZE : len;
+  packetbuf[buflen] = 0;
+}
+/*---------------------------------------------------------------------------*/
+int
+packetbuf_copyfrom(const void *from, uint16_t len)
+{
+  len = len > PACKETBUF_SIZE ? PACKETBUF_SIZE : len;
+  memcpy(packetbuf, from, len);
+  /* Keep a terminator after the payload; the firmwares parse beacons
+     with the string functions. */
+  memset(packetbuf + len, 0, sizeof(packetbuf) - len);
+  buflen = len;
+  return len;
+}
+/*---------------------------------------------------------------------------*/
+int
+packetbuf_copyto(void *to)
+{
+  memcpy(to, packetbuf, buflen);
+  return buflen;
+}
+/*---------------------------------------------------------------------------*/
+void
+packetbuf_attr_clear(void)
+{
+  memset(attrs, 0, sizeof(attrs));
+  memset(addrs, 0, sizeof(addrs));
+}
+/*---------------------------------------------------------------------------*/
+int
+packetbuf_set_attr(uint8_t type, const packetbuf_attr_t val)
+{
+  attrs[type] = val;
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+packetbuf_attr_t
+packetbuf_attr(uint8_t type)
+{
+  return attrs[type];
+}
+/*---------------------------------------------------------------------------*/
+int
+packetbuf_set_addr(uint8_t type, const rimeaddr_t *addr)
+{
+  addrs[type] = *addr;
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+const rimeaddr_t *
+packetbuf_addr(uint8_t type)
+{
+  return &addrs[type];
+}
+/*---------------------------------------------------------------------------*/
+void
+broadcast_open(struct broadcast_conn *c, uint16_t channel,
+               const struct broadcast_callbacks *u)
+{
+  int i;
+
+  c->channel = channel;
+  c->u = u;
+  for(i = 0; i < NETSIM_CONNS; ++i) {
+    if(netsim_current->conns[i] == NULL || netsim_current->conns[i] == c) {
+      netsim_current->conns[i] = c;
+      return;
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+void
+broadcast_close(struct broadcast_conn *c)
+{
+  int i;
+
+  for(i = 0; i < NETSIM_CONNS; ++i) {
+    if(netsim_current->conns[i] == c) {
+      netsim_current->conns[i] = NULL;
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+int
+broadcast_send(struct broadcast_conn *c)
+{
+  struct netsim_frame *f = malloc(sizeof(struct netsim_frame));
+
+  f->src = netsim_current;
+  f->receiver = addrs[PACKETBUF_ADDR_RECEIVER];
+  f->channel = c->channel;
+  f->len = packetbuf_copyto(f->data);
+  f->txpower = netsim_current->txpower;
+  if(attrs[PACKETBUF_ATTR_RADIO_TXPOWER] > 0) {
+    f->txpower = (attrs[PACKETBUF_ATTR_RADIO_TXPOWER] - 1) & 0x1f;
+  }
+  f->transmissions = 0;
+  f->refs = 1;
+  netsim_schedule(netsim_time(), NETSIM_EV_TX, netsim_current, f, 0);
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+/* A unicast frame is a broadcast with a receiver, which the other motes drop. */
+static void
+unicast_recv(struct broadcast_conn *c, const rimeaddr_t *from)
+{
+  struct unicast_conn *uc = (struct unicast_conn *)c;
+
+  if(rimeaddr_cmp(&addrs[PACKETBUF_ADDR_RECEIVER], &rimeaddr_node_addr) &&
+     uc->u->recv != NULL) {
+    uc->u->recv(uc, from);
+  }
+}
+static const struct broadcast_callbacks unicast_call = { unicast_recv, NULL };
+/*---------------------------------------------------------------------------*/
+void
+unicast_open(struct unicast_conn *c, uint16_t channel,
+             const struct unicast_callbacks *u)
+{
+  broadcast_open(&c->c, channel, &unicast_call);
+  c->u = u;
+}
+/*---------------------------------------------------------------------------*/
+void
+unicast_close(struct unicast_conn *c)
+{
+  broadcast_close(&c->c);
+}
+/*---------------------------------------------------------------------------*/
+int
+unicast_send(struct unicast_conn *c, const rimeaddr_t *receiver)
+{
+  packetbuf_set_addr(PACKETBUF_ADDR_RECEIVER, receiver);
+  return broadcast_send(&c->c);
+}
+/*---------------------------------------------------------------------------*/
+static void
+frame_release(struct netsim_frame *f)
+{
+  if(--f->refs == 0) {
+    free(f);
+  }
+}
+/*---------------------------------------------------------------------------*/
+void
+netsim_radio_init(void)
+{
+  double x1, y1;
+  int i, c;
+
+  grid_cell = netsim_conf.range * netsim_conf.interference;
+  grid_x0 = x1 = netsim_motes[0].x;
+  grid_y0 = y1 = netsim_motes[0].y;
+  for(i = 1; i < netsim_nmotes; ++i) {
+    grid_x0 = netsim_motes[i].x < grid_x0 ? netsim_motes[i].x : grid_x0;
+    grid_y0 = netsim_motes[i].y < grid_y0 ? netsim_motes[i].y : grid_y0;
+    x1 = netsim_motes[i].x > x1 ? netsim_motes[i].x : x1;
+    y1 = netsim_motes[i].y > y1 ? netsim_motes[i].y : y1;
+  }
+  grid_cols = (int)((x1 - grid_x0) / grid_cell) + 1;
+  grid_rows = (int)((y1 - grid_y0) / grid_cell) + 1;
+  grid_head = malloc(sizeof(int) * grid_cols * grid_rows);
+  for(c = 0; c < grid_cols * grid_rows; ++c) {
+    grid_head[c] = -1;
+  }
+  for(i = 0; i < netsim_nmotes; ++i) {
+    c = (int)((netsim_motes[i].y - grid_y0) / grid_cell) * grid_cols +
+        (int)((netsim_motes[i].x - grid_x0) / grid_cell);
+    netsim_motes[i].cell_next = grid_head[c];
+    grid_head[c] = i;
+  }
+}
+/*---------------------------------------------------------------------------*/
+void
+netsim_radio_set(struct netsim_mote *m, int on)
+{
+  netsim_time_t now = netsim_time();
+
+  if(on && !m->radio_on) {
+    m->radio_since = now;
+  } else if(!on && m->radio_on) {
+    m->radio_total += now - m->radio_since;
+    if(m->rx != NULL) {
+      m->rx->corrupt = 1;
+    }
+  }
+  m->radio_on = on;
+}
+/*---------------------------------------------------------------------------*/
+static int
+rdc_on(void)
+{
+  netsim_radio_set(netsim_current, 1);
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static int
+rdc_off(int keep_radio_on)
+{
+  netsim_radio_set(netsim_current, keep_radio_on);
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+const struct rdc_driver netsim_rdc_driver = { "netsim", rdc_on, rdc_off };
+/*---------------------------------------------------------------------------*/
+static void
+transmit(struct netsim_frame *f, netsim_time_t t)
+{
+  struct netsim_mote *s = f->src, *r;
+  struct netsim_rx *rx;
+  netsim_time_t end = t + (f->len + FRAME_OVERHEAD) * BYTE_TIME;
+  double range, interference, dx, dy, d2, dbm;
+  int busy, cx, cy, x, y, i;
+
+  range = netsim_conf.range * f->txpower / CC2420_TXPOWER_MAX;
+  interference = range * netsim_conf.interference;
+
+  s->tx_until = end;
+  s->tx_total += end - t;
+  if(s->rx != NULL) {
+    /* Half duplex: the ongoing reception is lost. */
+    s->rx->corrupt = 1;
+  }
+
+  cx = (int)((s->x - grid_x0) / grid_cell);
+  cy = (int)((s->y - grid_y0) / grid_cell);
+  for(y = cy - 1; y <= cy + 1; ++y) {
+    for(x = cx - 1; x <= cx + 1; ++x) {
+      if(x < 0 || y < 0 || x >= grid_cols || y >= grid_rows) {
+        continue;
+      }
+      for(i = grid_head[y * grid_cols + x]; i >= 0; i = r->cell_next) {
+        r = &netsim_motes[i];
+        dx = r->x - s->x;
+        dy = r->y - s->y;
+        d2 = dx * dx + dy * dy;
+        if(r == s || d2 > interference * interference) {
+          continue;
+        }
+        busy = r->channel_until > t;
+        if(r->channel_until < end) {
+          r->channel_until = end;
+        }
+        if(r->rx != NULL) {
+          /* Collision with the frame the mote is receiving. */
+          r->rx->corrupt = 1;
+        }
+        if(d2 > range * range || !r->radio_on || r->tx_until > t || busy) {
+          continue;
+        }
+        dbm = SS_STRONG + (sqrt(d2) / range) * (SS_WEAK - SS_STRONG);
+        rx = malloc(sizeof(struct netsim_rx));
+        rx->frame = f;
+        rx->dst = r;
+        rx->rssi = (packetbuf_attr_t)(int16_t)lround(dbm - RSSI_OFFSET);
+        rx->corrupt = 0;
+        r->rx = rx;
+        f->refs++;
+        netsim_schedule(end, NETSIM_EV_RX, r, rx, 0);
+      }
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+void
+netsim_radio_tx(void *ptr)
+{
+  struct netsim_frame *f = ptr;
+  struct netsim_mote *s = f->src;
+  netsim_time_t t = netsim_time();
+  netsim_time_t backoff;
+
+  if(!s->radio_on) {
+    frame_release(f);
+    return;
+  }
+  if(s->tx_until > t) {
+    /* Still sending the previous frame: queue behind it. */
+    netsim_schedule(s->tx_until, NETSIM_EV_TX, s, f, 0);
+    return;
+  }
+  if(s->channel_until > t) {
+    /* Clear channel assessment failed: back off, as csma does. */
+    if(++f->transmissions >= MAX_TRANSMISSIONS) {
+      frame_release(f);
+      return;
+    }
+    backoff = BACKOFF_PERIOD +
+      (netsim_rand(NULL) % (f->transmissions * CLOCK_SECOND / 8)) * NETSIM_CLOCK_TICK;
+    netsim_schedule(t + backoff, NETSIM_EV_TX, s, f, 0);
+    return;
+  }
+  transmit(f, t);
+  frame_release(f);
+}
+/*---------------------------------------------------------------------------*/
+void
+netsim_radio_rx(void *ptr)
+{
+  struct netsim_rx *rx = ptr;
+  struct netsim_mote *r = rx->dst;
+  struct netsim_frame *f = rx->frame;
+  int i;
+
+  if(r->rx == rx) {
+    r->rx = NULL;
+  }
+  if(!rx->corrupt && r->radio_on) {
+    packetbuf_copyfrom(f->data, f->len);
+    packetbuf_attr_clear();
+    packetbuf_set_attr(PACKETBUF_ATTR_RSSI, rx->rssi);
+    packetbuf_set_attr(PACKETBUF_ATTR_CHANNEL, f->channel);
+    packetbuf_set_addr(PACKETBUF_ADDR_SENDER, &f->src->addr);
+    packetbuf_set_addr(PACKETBUF_ADDR_RECEIVER, &f->receiver);
+    for(i = 0; i < NETSIM_CONNS; ++i) {
+      if(r->conns[i] != NULL && r->conns[i]->channel == f->channel &&
+         r->conns[i]->u != NULL && r->conns[i]->u->recv != NULL) {
+        r->conns[i]->u->recv(r->conns[i], &f->src->addr);
+        break;
+      }
+    }
+  }
+  free(rx);
+  frame_release(f);
+}
+/*---------------------------------------------------------------------------*/
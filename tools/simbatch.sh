@@ -0,0 +1,175 @@
+#!/bin/bash
+#
+# Runs a sweep of deployments (.dat files) in parallel, on a bounded pool of
+# local worker processes, and collects the results in one table.
+#
+# Each deployment is simulated with netsim (default) or with Cooja in no-gui
+# mode, and its motes log is stored next to the .dat file, as simtest.sh does.
+# Deployments whose .mlog already exists are not simulated again, so a sweep
+# that was interrupted continues where it stopped.
+#
+
+usage() {
+	cat <<EOU
+usage: $0 [options] <directory|file.dat>...
+	-a <lmst|redelca|cbtc>	algorithm (default lmst)
+	-b <netsim|cooja>	simulator (default netsim)
+	-j <jobs>		number of parallel runs (default: number of cores)
+	-t <seconds>		wall-clock time limit per run (default 3600)
+	-s <seed>		random seed (default 1)
+	-o <file>		results table (default results.tsv)
+	-f			simulate again deployments that already have a .mlog
+
+The cooja simulator needs COOJA_JAR and CONTIKI_DIR to be set, e.g.:
+	COOJA_JAR=~/contiki-2.7/tools/cooja/dist/cooja.jar CONTIKI_DIR=~/contiki-2.7 $0 -b cooja ../LMST/deployments
+EOU
+	exit 1
+}
+
+TOOLS=$(cd "$(dirname "$0")" && pwd)
+ALGORITHM=lmst
+BACKEND=netsim
+JOBS=$(nproc 2>/dev/null || echo 1)
+TIMEOUT=3600
+SEED=1
+RESULTS=results.tsv
+FORCE=0
+
+while getopts "a:b:j:t:s:o:f" opt; do
+	case $opt in
+		a) ALGORITHM=$OPTARG ;;
+		b) BACKEND=$OPTARG ;;
+		j) JOBS=$OPTARG ;;
+		t) TIMEOUT=$OPTARG ;;
+		s) SEED=$OPTARG ;;
+		o) RESULTS=$OPTARG ;;
+		f) FORCE=1 ;;
+		*) usage ;;
+	esac
+done
+shift $((OPTIND - 1))
+[[ $# -gt 0 ]] || usage
+
+case $ALGORITHM in
+	lmst) FOLDER=LMST ;;
+	redelca) FOLDER=REDELCA ;;
+	cbtc) FOLDER=CBTC ;;
+	*) usage ;;
+esac
+
+case $BACKEND in
+	netsim)
+		if [[ ! -x $TOOLS/netsim-$ALGORITHM ]]; then
+			printf "$TOOLS/netsim-$ALGORITHM not found, type make in $TOOLS\n"
+			exit 1
+		fi
+		;;
+	cooja)
+		if [[ ! -x $TOOLS/simgen ]]; then
+			printf "$TOOLS/simgen not found, type make in $TOOLS\n"
+			exit 1
+		fi
+		if [[ -z $COOJA_JAR || -z $CONTIKI_DIR ]]; then
+			printf "COOJA_JAR and CONTIKI_DIR must be set for the cooja simulator\n"
+			exit 1
+		fi
+		;;
+	*) usage ;;
+esac
+
+WORK=$(mktemp -d)
+trap 'kill $(jobs -p) 2>/dev/null; rm -rf "$WORK"' EXIT
+
+# Prints nodes, mean POWER and max POWER of a motes log. The POWER of a mote
+# is the field that follows the last time (min:sec.mse) of its line.
+summary() {
+	awk -F, '
+		/^#/ || NF < 2 { next }
+		{
+			p = "";
+			for(i = NF; i > 1; --i) if($i ~ /:/) { p = $(i + 1); break; }
+			n++;
+			if(p != "") { sum += p; m++; if(p > max) max = p; }
+		}
+		END { printf "%d\t%s\t%s", n, m ? sprintf("%.2f", sum / m) : "-", m ? max : "-" }' "$1"
+}
+
+# Simulates one deployment; writes <name>.mlog next to the .dat file on
+# success, or <name>.mlog.failed otherwise, and one row of the results table.
+run() {
+	local dat=$1 row=$2
+	local dir=$(dirname "$dat") name=$(basename "$dat" .dat)
+	local tmp=$WORK/$name.$BASHPID status ex start end wall
+
+	mkdir -p "$tmp"
+	start=$(date +%s.%N)
+	case $BACKEND in
+		netsim)
+			timeout "$TIMEOUT" "$TOOLS/netsim-$ALGORITHM" -s "$SEED" -o "$tmp/$name.mlog" "$dat" > "$tmp/$name.slog" 2>&1
+			ex=$?
+			;;
+		cooja)
+			cp "$dat" "$tmp/" &&
+			(cd "$tmp" && "$TOOLS/simgen" -a "$FOLDER" -t z1 -i "$name.dat" "$name" > /dev/null &&
+				timeout "$TIMEOUT" java -mx1024m -jar "$COOJA_JAR" -nogui="$tmp/$name.csc" -contiki="$CONTIKI_DIR" > "$name.slog" 2>&1)
+			ex=$?
+			;;
+	esac
+	end=$(date +%s.%N)
+	wall=$(awk "BEGIN { printf \"%.1f\", $end - $start }")
+
+	if [[ $ex == 124 ]]; then
+		status=timeout
+	elif [[ $ex != 0 || ! -f $tmp/$name.mlog ]]; then
+		status=failed
+	elif grep -q "^#Exception" "$tmp/$name.mlog"; then
+		status=exception
+	elif grep -q "^#Simulation success" "$tmp/$name.mlog"; then
+		status=ok
+	else
+		status=incomplete
+	fi
+
+	if [[ $status == ok ]]; then
+		mv "$tmp/$name.mlog" "$dir/$name.mlog"
+		[[ $BACKEND == cooja ]] && mv "$tmp/$name.csc" "$dir/"
+		printf "%s\t%s\t%s\t%s\n" "$dat" "$status" "$wall" "$(summary "$dir/$name.mlog")" > "$row"
+	else
+		[[ -f $tmp/$name.mlog ]] && mv "$tmp/$name.mlog" "$dir/$name.mlog.failed"
+		printf "%s\t%s\t%s\t-\t-\t-\n" "$dat" "$status" "$wall" > "$row"
+	fi
+	rm -rf "$tmp"
+	printf "\t$name: $status\n"
+}
+
+n=0
+running=0
+for f in "$@"; do
+	if [[ -d $f ]]; then
+		dats=("${f%/}"/*.dat)
+	else
+		dats=("$f")
+	fi
+	for s in "${dats[@]}"; do
+		[[ -f $s ]] || continue
+		n=$((n + 1))
+		row=$WORK/$(printf "%06d" $n).row
+		mlog="${s%.dat}.mlog"
+		if [[ $FORCE == 0 && -f $mlog ]]; then
+			printf "%s\tcached\t-\t%s\n" "$s" "$(summary "$mlog")" > "$row"
+			continue
+		fi
+		if [[ $running -ge $JOBS ]]; then
+			wait -n
+			running=$((running - 1))
+		fi
+		run "$s" "$row" &
+		running=$((running + 1))
+	done
+done
+wait
+
+printf "#deployment\tstatus\twall_s\tnodes\tmean_power\tmax_power\n" > "$RESULTS"
+cat "$WORK"/*.row >> "$RESULTS" 2>/dev/null
+printf "\n%d deployments, results in %s\n" $n "$RESULTS"
+awk -F'\t' 'NR > 1 { c[$2]++ } END { for(s in c) printf "\t%s: %d\n", s, c[s] }' "$RESULTS"
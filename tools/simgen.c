@@ -0,0 +1,577 @@
+/*
+ * Copyright (c) 2015, Computer Science Department (CSD), University of Crete, and 
+ * Signal Processing Lab (SPL), Institute of Computer Science (ICS), FORTH, Greece.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of CSD, SPL/ICS-FORTH nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * 
+ */
+/**
+ * \file
+ *         simgen, the scenario generator. It creates a deployment (.dat,
+ *         "<id>,<x>,<y>" per line) from a parametric layout, and the Cooja
+ *         simulation (.csc) that runs it with the LMST, REDELCA or CBTC firmware.
+ *         With -i it only creates the .csc of an existing deployment, as the
+ *         simgen_rtx executable used to do.
+ *
+ *         Layouts:
+ *           uniform   homogeneous Poisson point process over the field
+ *           grid      square grid, each node displaced by a random jitter
+ *           cluster   Thomas process: uniform cluster centres, nodes around
+ *                     them with gaussian spread
+ *           corridor  uniform over a long strip (default width: one range)
+ *
+ *         The density is the mean number of nodes within the transmitting
+ *         range of a node (its expected degree at full power). Given two of
+ *         node count, density and field size, the third one is derived.
+ *         The same seed always gives the same deployment.
+ */
+
+#include <errno.h>
+#include <getopt.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define LAYOUT_UNIFORM  0
+#define LAYOUT_GRID     1
+#define LAYOUT_CLUSTER  2
+#define LAYOUT_CORRIDOR 3
+
+static const char *layouts[] = { "uniform", "grid", "cluster", "corridor", NULL };
+
+struct point {
+  double x, y;
+};
+
+static struct {
+  int layout;
+  long nodes;            /* -n; 0: derived */
+  double density;        /* -d; 0: derived */
+  double width, height;  /* -w, -h; 0: derived */
+  double range;          /* -r, <transmitting_range> */
+  double jitter;         /* -j, grid jitter, fraction of the grid step */
+  int clusters;          /* -k; 0: one per 20 nodes */
+  double spread;         /* -c, cluster standard deviation in metres */
+  uint64_t seed;         /* -s, also <randomseed> */
+  const char *algorithm; /* -a, examples/<algorithm> folder in the .csc */
+  const char *mote;      /* -t, sky or z1 */
+  const char *input;     /* -i, existing deployment */
+} conf = {
+  LAYOUT_UNIFORM, 0, 0, 0, 0, 15.0, 0.25, 0, 0, 123456, "LMST", "z1", NULL
+};
+
+static struct point *points;
+static long npoints;
+
+/*---------------------------------------------------------------------------*/
+/* xorshift64*: portable, so that a seed gives the same deployment anywhere */
+static uint64_t rand_state;
+
+static void
+rand_init(uint64_t seed)
+{
+  int i;
+
+  rand_state = seed * 0x9e3779b97f4a7c15ULL + 0x2545f4914f6cdd1dULL;
+  for(i = 0; i < 8; ++i) {
+    rand_state ^= rand_state >> 12;
+    rand_state ^= rand_state << 25;
+    rand_state ^= rand_state >> 27;
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Uniform in [0, 1) */
+static double
+rand_uniform(void)
+{
+  rand_state ^= rand_state >> 12;
+  rand_state ^= rand_state << 25;
+  rand_state ^= rand_state >> 27;
+  return ((rand_state * 0x2545f4914f6cdd1dULL) >> 11) * (1.0 / 9007199254740992.0);
+}
+/*---------------------------------------------------------------------------*/
+static double
+rand_gaussian(void)
+{
+  double u = 1.0 - rand_uniform();
+
+  return sqrt(-2.0 * log(u)) * cos(2.0 * M_PI * rand_uniform());
+}
+/*---------------------------------------------------------------------------*/
+static long
+rand_poisson(double mean)
+{
+  double l, p;
+  long k;
+
+  if(mean > 500) {
+    k = lround(mean + sqrt(mean) * rand_gaussian());
+    return k < 0 ? 0 : k;
+  }
+  l = exp(-mean);
+  for(k = 0, p = rand_uniform(); p > l; ++k) {
+    p *= rand_uniform();
+  }
+  return k;
+}
+/*---------------------------------------------------------------------------*/
+static void
+add_point(double x, double y)
+{
+  static long size;
+
+  if(npoints == size) {
+    size = size ? size * 2 : 256;
+    points = realloc(points, size * sizeof(struct point));
+    if(points == NULL) {
+      fprintf(stderr, "simgen: out of memory\n");
+      exit(1);
+    }
+  }
+  points[npoints].x = x;
+  points[npoints].y = y;
+  npoints++;
+}
+/*---------------------------------------------------------------------------*/
+/*
+ * Completes the node count, density and field size from the ones given.
+ * The field is square, except for the corridor that is one range wide
+ * unless told otherwise.
+ */
+static void
+dimension(void)
+{
+  double disk = M_PI * conf.range * conf.range, area;
+  int sized = conf.width > 0 || conf.height > 0;
+
+  if(conf.layout == LAYOUT_CORRIDOR && conf.height == 0) {
+    conf.height = conf.range;
+  }
+  if(conf.nodes == 0 && conf.density == 0) {
+    conf.nodes = 50;
+  }
+  if(!sized || conf.width == 0 || conf.height == 0) {
+    if(conf.density == 0) {
+      conf.density = 8;
+    }
+    area = conf.nodes * disk / conf.density;
+    if(conf.width == 0 && conf.height == 0) {
+      conf.width = conf.height = sqrt(area);
+    } else if(conf.width == 0) {
+      conf.width = area / conf.height;
+    } else {
+      conf.height = area / conf.width;
+    }
+  } else if(conf.nodes == 0) {
+    conf.nodes = -1;  /* drawn from the density in the layout */
+  } else {
+    conf.density = conf.nodes * disk / (conf.width * conf.height);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+layout_uniform(void)
+{
+  long i, n = conf.nodes;
+
+  if(n < 0) {
+    n = rand_poisson(conf.density * conf.width * conf.height /
+                     (M_PI * conf.range * conf.range));
+  }
+  for(i = 0; i < n; ++i) {
+    add_point(rand_uniform() * conf.width, rand_uniform() * conf.height);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+layout_grid(void)
+{
+  long n = conf.nodes, cols, rows, i;
+  double step, x, y;
+
+  if(n < 0) {
+    n = lround(conf.density * conf.width * conf.height /
+               (M_PI * conf.range * conf.range));
+  }
+  step = sqrt(conf.width * conf.height / (n > 0 ? n : 1));
+  cols = (long)ceil(conf.width / step);
+  rows = (long)ceil((double)n / (cols > 0 ? cols : 1));
+  for(i = 0; i < n; ++i) {
+    x = (i % cols + 0.5) * conf.width / cols;
+    y = (i / cols + 0.5) * conf.height / rows;
+    x += (rand_uniform() - 0.5) * 2 * conf.jitter * step;
+    y += (rand_uniform() - 0.5) * 2 * conf.jitter * step;
+    add_point(fmin(fmax(x, 0), conf.width), fmin(fmax(y, 0), conf.height));
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+layout_cluster(void)
+{
+  long n = conf.nodes, i;
+  int k = conf.clusters, c;
+  struct point *centres;
+  double x, y;
+
+  if(n < 0) {
+    n = rand_poisson(conf.density * conf.width * conf.height /
+                     (M_PI * conf.range * conf.range));
+  }
+  if(k <= 0) {
+    k = n / 20 > 0 ? n / 20 : 1;
+  }
+  if(conf.spread <= 0) {
+    conf.spread = conf.range;
+  }
+  centres = malloc(k * sizeof(struct point));
+  for(c = 0; c < k; ++c) {
+    centres[c].x = rand_uniform() * conf.width;
+    centres[c].y = rand_uniform() * conf.height;
+  }
+  for(i = 0; i < n; ++i) {
+    c = (int)(rand_uniform() * k);
+    /* resample what falls out of the field, so that no node sits on its border */
+    do {
+      x = centres[c].x + conf.spread * rand_gaussian();
+      y = centres[c].y + conf.spread * rand_gaussian();
+    } while(x < 0 || x > conf.width || y < 0 || y > conf.height);
+    add_point(x, y);
+  }
+  free(centres);
+}
+/*---------------------------------------------------------------------------*/
+static void
+load_deployment(const char *file)
+{
+  FILE *f = fopen(file, "r");
+  char line[256];
+  unsigned id;
+  double x, y;
+
+  if(f == NULL) {
+    fprintf(stderr, "Unable to open data file: %s\n", file);
+    exit(1);
+  }
+  while(fgets(line, sizeof(line), f) != NULL) {
+    if(sscanf(line, " %u , %lf , %lf", &id, &x, &y) != 3) {
+      continue;
+    }
+    if((long)id != npoints + 1) {
+      fprintf(stderr, "simgen: %s: node ids must be 1, 2, ... in order\n", file);
+      exit(1);
+    }
+    add_point(x, y);
+  }
+  fclose(f);
+}
+/*---------------------------------------------------------------------------*/
+static void
+write_deployment(const char *file)
+{
+  FILE *f = fopen(file, "w");
+  long i;
+
+  if(f == NULL) {
+    fprintf(stderr, "simgen: %s: %s\n", file, strerror(errno));
+    exit(1);
+  }
+  for(i = 0; i < npoints; ++i) {
+    fprintf(f, "%ld,%.3f,%.3f\n", i + 1, points[i].x, points[i].y);
+  }
+  fclose(f);
+}
+/*---------------------------------------------------------------------------*/
+static void
+write_simulation(const char *file, const char *title)
+{
+  const char *t = strcmp(conf.mote, "z1") == 0 ? "Z1" : "Sky";
+  const char *a = conf.algorithm;
+  FILE *f = fopen(file, "w");
+  long i;
+
+  if(f == NULL) {
+    fprintf(stderr, "simgen: %s: %s\n", file, strerror(errno));
+    exit(1);
+  }
+  fprintf(f,
+          "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+          "<simconf>\n"
+          "  <project EXPORT=\"discard\">[APPS_DIR]/Mobility</project>\n"
+          "  <project EXPORT=\"discard\">[APPS_DIR]/mrm</project>\n"
+          "  <project EXPORT=\"discard\">[APPS_DIR]/mspsim</project>\n"
+          "  <project EXPORT=\"discard\">[APPS_DIR]/avrora</project>\n"
+          "  <project EXPORT=\"discard\">[APPS_DIR]/serial_socket</project>\n"
+          "  <project EXPORT=\"discard\">[APPS_DIR]/collect-view</project>\n"
+          "  <project EXPORT=\"discard\">[APPS_DIR]/powertracker</project>\n"
+          "  <project EXPORT=\"discard\">[APPS_DIR]/project_new_plugin</project>\n"
+          "  <simulation>\n"
+          "    <title>%s</title>\n"
+          "    <speedlimit>2.0</speedlimit>\n"
+          "    <randomseed>%llu</randomseed>\n"
+          "    <motedelay_us>1000000</motedelay_us>\n"
+          "    <radiomedium>\n"
+          "      se.sics.cooja.radiomediums.UDGM\n"
+          "      <transmitting_range>%.1f</transmitting_range>\n"
+          "      <interference_range>%.1f</interference_range>\n"
+          "      <success_ratio_tx>1.0</success_ratio_tx>\n"
+          "      <success_ratio_rx>1.0</success_ratio_rx>\n"
+          "    </radiomedium>\n"
+          "    <events>\n"
+          "      <logoutput>40000</logoutput>\n"
+          "    </events>\n"
+          "    <motetype>\n"
+          "      se.sics.cooja.mspmote.%sMoteType\n"
+          "      <identifier>%s1</identifier>\n"
+          "      <description>%sMote Type</description>\n"
+          "      <source EXPORT=\"discard\">[CONTIKI_DIR]/examples/%s/firmware.c</source>\n"
+          "      <commands EXPORT=\"discard\">make firmware.%s TARGET=%s</commands>\n"
+          "      <firmware EXPORT=\"copy\">[CONTIKI_DIR]/examples/%s/firmware.%s</firmware>\n",
+          title, (unsigned long long)conf.seed,
+          conf.range, 2 * conf.range, t, conf.mote, t,
+          a, conf.mote, conf.mote, a, conf.mote);
+  fprintf(f,
+          "      <moteinterface>se.sics.cooja.interfaces.Position</moteinterface>\n"
+          "      <moteinterface>se.sics.cooja.interfaces.RimeAddress</moteinterface>\n"
+          "      <moteinterface>se.sics.cooja.interfaces.IPAddress</moteinterface>\n"
+          "      <moteinterface>se.sics.cooja.interfaces.Mote2MoteRelations</moteinterface>\n"
+          "      <moteinterface>se.sics.cooja.interfaces.MoteAttributes</moteinterface>\n"
+          "      <moteinterface>se.sics.cooja.mspmote.interfaces.MspClock</moteinterface>\n"
+          "      <moteinterface>se.sics.cooja.mspmote.interfaces.MspMoteID</moteinterface>\n"
+          "      <moteinterface>se.sics.cooja.mspmote.interfaces.MspButton</moteinterface>\n"
+          "      <moteinterface>se.sics.cooja.mspmote.interfaces.Msp802154Radio</moteinterface>\n"
+          "      <moteinterface>se.sics.cooja.mspmote.interfaces.MspDefaultSerial</moteinterface>\n"
+          "      <moteinterface>se.sics.cooja.mspmote.interfaces.MspLED</moteinterface>\n"
+          "      <moteinterface>se.sics.cooja.mspmote.interfaces.MspDebugOutput</moteinterface>\n"
+          "    </motetype>\n");
+  for(i = 0; i < npoints; ++i) {
+    fprintf(f,
+            "    <mote>\n"
+            "      <breakpoints />\n"
+            "      <interface_config>\n"
+            "        se.sics.cooja.interfaces.Position\n"
+            "        <x>%f</x>\n"
+            "        <y>%f</y>\n"
+            "        <z>0.0</z>\n"
+            "      </interface_config>\n"
+            "      <interface_config>\n"
+            "        se.sics.cooja.mspmote.interfaces.MspMoteID\n"
+            "        <id>%ld</id>\n"
+            "      </interface_config>\n"
+            "      <motetype_identifier>%s1</motetype_identifier>\n"
+            "    </mote>\n",
+            points[i].x, points[i].y, i + 1, conf.mote);
+  }
+  fprintf(f,
+          "  </simulation>\n"
+          "  <plugin>\n"
+          "    se.sics.cooja.plugins.SimControl\n"
+          "    <width>401</width>\n"
+          "    <z>2</z>\n"
+          "    <height>176</height>\n"
+          "    <location_x>0</location_x>\n"
+          "    <location_y>401</location_y>\n"
+          "  </plugin>\n"
+          "  <plugin>\n"
+          "    se.sics.cooja.plugins.Visualizer\n"
+          "    <plugin_config>\n"
+          "      <moterelations>true</moterelations>\n"
+          "      <skin>se.sics.cooja.plugins.skins.IDVisualizerSkin</skin>\n"
+          "      <skin>se.sics.cooja.plugins.skins.PositionVisualizerSkin</skin>\n"
+          "      <skin>se.sics.cooja.plugins.skins.GridVisualizerSkin</skin>\n"
+          "      <skin>se.sics.cooja.plugins.skins.TrafficVisualizerSkin</skin>\n"
+          "      <viewport>0.9090909090909091 0.0 0.0 0.9090909090909091 387.4640527451129 143.12809423070084</viewport>\n"
+          "    </plugin_config>\n"
+          "    <width>877</width>\n"
+          "    <z>1</z>\n"
+          "    <height>400</height>\n"
+          "    <location_x>401</location_x>\n"
+          "    <location_y>1</location_y>\n"
+          "  </plugin>\n"
+          "  <plugin>\n"
+          "    se.sics.cooja.plugins.LogListener\n"
+          "    <plugin_config>\n"
+          "      <filter />\n"
+          "      <formatted_time />\n"
+          "      <coloring />\n"
+          "    </plugin_config>\n"
+          "    <width>880</width>\n"
+          "    <z>4</z>\n"
+          "    <height>460</height>\n"
+          "    <location_x>400</location_x>\n"
+          "    <location_y>401</location_y>\n"
+          "  </plugin>\n"
+          "  <plugin>\n"
+          "    se.sics.cooja.plugins.TimeLine\n"
+          "    <plugin_config>\n"
+          "      <showRadioRXTX />\n"
+          "      <showRadioHW />\n"
+          "      <showLEDs />\n"
+          "      <zoomfactor>500.0</zoomfactor>\n"
+          "    </plugin_config>\n"
+          "    <width>401</width>\n"
+          "    <z>3</z>\n"
+          "    <height>284</height>\n"
+          "    <location_x>0</location_x>\n"
+          "    <location_y>577</location_y>\n"
+          "  </plugin>\n"
+          "  <plugin>\n"
+          "    se.sics.cooja.plugins.ScriptRunner\n"
+          "    <plugin_config>\n"
+          "      <scriptfile>[CONTIKI_DIR]/examples/%s/scenario.js</scriptfile>\n"
+          "      <active>true</active>\n"
+          "    </plugin_config>\n"
+          "    <width>402</width>\n"
+          "    <z>0</z>\n"
+          "    <height>404</height>\n"
+          "    <location_x>0</location_x>\n"
+          "    <location_y>-2</location_y>\n"
+          "  </plugin>\n"
+          "</simconf>\n", a);
+  fclose(f);
+}
+/*---------------------------------------------------------------------------*/
+static void
+usage(void)
+{
+  fprintf(stderr,
+          "usage: simgen [options] <simulation name>\n"
+          "  -l <layout>  uniform, grid, cluster or corridor (default uniform)\n"
+          "  -n <nodes>   number of nodes\n"
+          "  -d <degree>  density: mean number of nodes within range (default 8)\n"
+          "  -w <m>       field width\n"
+          "  -h <m>       field height\n"
+          "  -r <m>       transmitting range (default 15)\n"
+          "  -j <ratio>   grid: jitter as a fraction of the grid step (default 0.25)\n"
+          "  -k <count>   cluster: number of clusters (default nodes/20)\n"
+          "  -c <m>       cluster: standard deviation around a centre (default range)\n"
+          "  -s <seed>    random seed, also the Cooja one (default 123456)\n"
+          "  -a <folder>  firmware folder under examples/, LMST, REDELCA or CBTC (default LMST)\n"
+          "  -t <mote>    mote type, sky or z1 (default z1)\n"
+          "  -i <file>    use an existing deployment instead of a layout\n"
+          "Writes <simulation name>.dat (unless -i) and <simulation name>.csc.\n");
+  exit(2);
+}
+/*---------------------------------------------------------------------------*/
+int
+main(int argc, char **argv)
+{
+  char *file;
+  int c;
+
+  while((c = getopt(argc, argv, "l:n:d:w:h:r:j:k:c:s:a:t:i:")) != -1) {
+    switch(c) {
+    case 'l':
+      for(conf.layout = 0; layouts[conf.layout] != NULL &&
+            strcmp(layouts[conf.layout], optarg) != 0; ++conf.layout);
+      if(layouts[conf.layout] == NULL) {
+        usage();
+      }
+      break;
+    case 'n':
+      conf.nodes = atol(optarg);
+      break;
+    case 'd':
+      conf.density = atof(optarg);
+      break;
+    case 'w':
+      conf.width = atof(optarg);
+      break;
+    case 'h':
+      conf.height = atof(optarg);
+      break;
+    case 'r':
+      conf.range = atof(optarg);
+      break;
+    case 'j':
+      conf.jitter = atof(optarg);
+      break;
+    case 'k':
+      conf.clusters = atoi(optarg);
+      break;
+    case 'c':
+      conf.spread = atof(optarg);
+      break;
+    case 's':
+      conf.seed = strtoull(optarg, NULL, 0);
+      break;
+    case 'a':
+      conf.algorithm = optarg;
+      break;
+    case 't':
+      conf.mote = optarg;
+      break;
+    case 'i':
+      conf.input = optarg;
+      break;
+    default:
+      usage();
+    }
+  }
+  if(optind != argc - 1 || conf.range <= 0 || conf.nodes < 0 ||
+     conf.density < 0 || conf.width < 0 || conf.height < 0) {
+    usage();
+  }
+  if(strcmp(conf.mote, "sky") != 0 && strcmp(conf.mote, "z1") != 0) {
+    fprintf(stderr, "Invalid mote type\nMust be sky | z1\n");
+    exit(2);
+  }
+
+  file = malloc(strlen(argv[optind]) + 5);
+  if(conf.input != NULL) {
+    load_deployment(conf.input);
+  } else {
+    rand_init(conf.seed);
+    dimension();
+    switch(conf.layout) {
+    case LAYOUT_UNIFORM:
+    case LAYOUT_CORRIDOR:
+      layout_uniform();
+      break;
+    case LAYOUT_GRID:
+      layout_grid();
+      break;
+    case LAYOUT_CLUSTER:
+      layout_cluster();
+      break;
+    }
+    sprintf(file, "%s.dat", argv[optind]);
+    write_deployment(file);
+    fprintf(stderr, "simgen: %s, %ld nodes in %.1fm x %.1fm, density %.2f\n",
+            layouts[conf.layout], npoints, conf.width, conf.height,
+            npoints * M_PI * conf.range * conf.range / (conf.width * conf.height));
+  }
+  if(npoints > 255) {
+    fprintf(stderr, "simgen: warning, the firmwares address nodes by the low "
+            "byte of their id; ids above 255 repeat\n");
+  }
+  sprintf(file, "%s.csc", argv[optind]);
+  write_simulation(file, argv[optind]);
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
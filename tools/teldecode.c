@@ -0,0 +1,135 @@
+/*
+ * Copyright (c) 2015, Computer Science Department (CSD), University of Crete, and 
+ * Signal Processing Lab (SPL), Institute of Computer Science (ICS), FORTH, Greece.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of CSD, SPL/ICS-FORTH nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * 
+ */
+/**
+ * \file
+ *         teldecode, decoder of the telemetry frames the firmwares write on
+ *         the serial line (see ../common/telemetry.h). Every frame is printed
+ *         as the local time of the mote (seconds since boot) and the text
+ *         line it stands for; other lines are copied as they are.
+ *
+ *         Whatever precedes the frame on its line (e.g., the time and mote
+ *         id columns of a Cooja or serialdump log) is kept in front of it.
+ */
+
+#include <errno.h>
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "contiki-conf.h"
+#include "telemetry.h"
+
+#define MAX_LINE    4096
+
+static struct {
+  int seq;
+} conf = { 0 };
+
+static unsigned long frames, bad;
+
+/*---------------------------------------------------------------------------*/
+static void
+decode(FILE *in)
+{
+  struct telemetry_record r;
+  char line[MAX_LINE], text[512], *frame;
+  size_t len;
+
+  while(fgets(line, sizeof(line), in) != NULL) {
+    len = strlen(line);
+    while(len > 0 && (line[len - 1] == '\n' || line[len - 1] == '\r')) {
+      line[--len] = '\0';
+    }
+    if((frame = memchr(line, TELEMETRY_SYNC, len)) == NULL) {
+      printf("%s\n", line);
+      continue;
+    }
+    if(telemetry_decode(frame, (int)(line + len - frame), &r) < 0) {
+      bad++;
+      fprintf(stderr, "teldecode: bad frame: %.*s\n", (int)(frame - line), line);
+      continue;
+    }
+    frames++;
+    telemetry_format(&r, text, sizeof(text));
+    printf("%.*s%lu.%03lu\t", (int)(frame - line), line,
+           (unsigned long)(r.time / CLOCK_CONF_SECOND),
+           (unsigned long)(r.time % CLOCK_CONF_SECOND * 1000 / CLOCK_CONF_SECOND));
+    if(conf.seq) {
+      printf("%u\t", r.seq);
+    }
+    printf("%s\n", text);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+usage(void)
+{
+  fprintf(stderr,
+          "usage: teldecode [options] [file]...\n"
+          "  -s          print the sequence number of every frame\n"
+          "Reads the standard input if no file is given.\n");
+  exit(1);
+}
+/*---------------------------------------------------------------------------*/
+int
+main(int argc, char **argv)
+{
+  FILE *in;
+  int c, i;
+
+  while((c = getopt(argc, argv, "s")) != -1) {
+    switch(c) {
+    case 's':
+      conf.seq = 1;
+      break;
+    default:
+      usage();
+    }
+  }
+  if(optind == argc) {
+    decode(stdin);
+  }
+  for(i = optind; i < argc; ++i) {
+    if((in = fopen(argv[i], "r")) == NULL) {
+      fprintf(stderr, "teldecode: %s: %s\n", argv[i], strerror(errno));
+      return 1;
+    }
+    decode(in);
+    fclose(in);
+  }
+  if(bad > 0) {
+    fprintf(stderr, "teldecode: %lu frames, %lu bad\n", frames, bad);
+  }
+  return bad > 0;
+}
+/*---------------------------------------------------------------------------*/
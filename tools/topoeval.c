@@ -0,0 +1,819 @@
+/*
+ * Copyright (c) 2015, Computer Science Department (CSD), University of Crete, and
+ * Signal Processing Lab (SPL), Institute of Computer Science (ICS), FORTH, Greece.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of CSD, SPL/ICS-FORTH nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ *
+ */
+/**
+ * \file
+ *         topoeval, offline evaluation of a topology control algorithm over
+ *         a whole deployment. It runs the decision code of the firmware
+ *         (LMST/lmst.c, REDELCA/redelca.c or CBTC/cbtc.c, and common/power.c) for every
+ *         node, on the neighbourhood the node would hear, without simulating
+ *         the radio: every broadcast reaches every node within range, with
+ *         no losses, in the order of the send times of the firmware (the
+ *         TIMEFRAME slot of the sender, then its order in the .dat file).
+ *
+ *         The output is a motes log with the rows of the firmware (see
+ *         ../README.md): POWER, PEAK MEMORY ALLOCATION and the NEIGHBOR ids
+ *         are the ones the motes would print, times and energy are zero.
+ *         As in the firmware, node ids are their low byte.
+ *
+ *         Neighbours are found over a uniform grid of range-sized cells.
+ *         Nodes are independent within a phase of the protocol, so phases
+ *         are spread over worker processes.
+ */
+
+#include <errno.h>
+#include <getopt.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "power.h"
+#include "position.h"
+#if defined(TOPOEVAL_LMST)
+#include "lmst.h"
+#define ALGORITHM "LMST"
+#elif defined(TOPOEVAL_REDELCA)
+#include "redelca.h"
+#define ALGORITHM "REDELCA"
+#elif defined(TOPOEVAL_CBTC)
+#include "cbtc.h"
+#define ALGORITHM "CBTC"
+#else
+#error "define TOPOEVAL_LMST, TOPOEVAL_REDELCA or TOPOEVAL_CBTC"
+#endif
+
+#define TIMEFRAME    30      /* as in the firmwares */
+#define FULL_POWER   31
+#define CHUNK        256     /* nodes a worker takes at a time */
+
+/* Signal strengths of the UDGM model, in dBm, and the offset between the
+   CC2420 RSSI register and dBm (as in netsim/radio.c). */
+#define SS_STRONG    -10.0
+#define SS_WEAK      -95.0
+#define RSSI_OFFSET  -45
+
+struct node {
+  unsigned id;
+  double x, y;              /* position, as in the .dat file */
+  float fx, fy;             /* position, as the firmware parses it */
+  unsigned slot;            /* send order: TIMEFRAME slot, then index */
+};
+
+struct result {
+  uint8_t power;
+  uint8_t mst;              /* power of the local MST alone (k-LMST) */
+  uint8_t error;            /* NEIGHBOR: ERROR was printed */
+  short count;              /* NEIGHBOR (LMST) */
+  short init;               /* INITIALIZE */
+  short links;              /* REDELCA */
+  int memory;               /* MEMORY */
+};
+
+static struct {
+  double range;
+  int jobs;
+  int check;
+} conf = { 15.0, 0, 0 };
+
+static struct node *nodes;
+static int nnodes;
+
+/* grid: the nodes of cell c are cell_node[cell_start[c]..cell_start[c+1]),
+   in .dat order; cx/cy hold their coordinates in the same order */
+static int gw, gh, max_cell;
+static double gx0, gy0;
+static int *cell_start, *cell_node;
+static double *cx, *cy;
+
+/* shared with the workers */
+static struct result *results;
+static unsigned *next_chunk;
+#ifdef TOPOEVAL_LMST
+static uint8_t (*payload)[3 * MAX_NEIGHBORS];
+static uint8_t *payload_len;
+/* -c: single changes tried, repaired, and repaired unlike a full computation */
+static unsigned *checks;
+#endif
+#if defined(TOPOEVAL_REDELCA) && REDELCA_RING_CHECK
+/* the Delaunay neighbours each node advertises in the ring round */
+static uint8_t (*advert)[MAXPOINTS];
+static uint8_t *advert_len;
+#endif
+/*---------------------------------------------------------------------------*/
+static void *
+xmalloc(size_t size)
+{
+  void *p = malloc(size ? size : 1);
+
+  if(p == NULL) {
+    fprintf(stderr, "topoeval: out of memory\n");
+    exit(1);
+  }
+  return p;
+}
+/*---------------------------------------------------------------------------*/
+static void *
+shared(size_t size)
+{
+  void *p = mmap(NULL, size ? size : 1, PROT_READ | PROT_WRITE,
+                 MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+
+  if(p == MAP_FAILED) {
+    fprintf(stderr, "topoeval: mmap: %s\n", strerror(errno));
+    exit(1);
+  }
+  return p;
+}
+/*---------------------------------------------------------------------------*/
+static double
+now(void)
+{
+  struct timeval tv;
+
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec + tv.tv_usec / 1e6;
+}
+/*---------------------------------------------------------------------------*/
+/* The shortest decimal string of v, as netsim sends it over the serial
+   line; the firmware parses it back with str2float. */
+static void
+format_coordinate(char *buf, size_t size, double v)
+{
+  int prec;
+
+  for(prec = 1; prec < 17; ++prec) {
+    snprintf(buf, size, "%.*f", prec, v);
+    if(strtod(buf, NULL) == v) {
+      break;
+    }
+  }
+  while(prec > 1 && buf[strlen(buf) - 1] == '0') {
+    buf[strlen(buf) - 1] = '\0';
+    prec--;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static int
+read_deployment(const char *path)
+{
+  FILE *f;
+  char line[256], buf[64];
+  unsigned id;
+  double x, y;
+  int size = 0;
+
+  if((f = fopen(path, "r")) == NULL) {
+    fprintf(stderr, "topoeval: %s: %s\n", path, strerror(errno));
+    return -1;
+  }
+  while(fgets(line, sizeof(line), f) != NULL) {
+    if(sscanf(line, " %u , %lf , %lf", &id, &x, &y) != 3) {
+      continue;
+    }
+    if(nnodes == size) {
+      size = size ? 2 * size : 1024;
+      nodes = realloc(nodes, size * sizeof(*nodes));
+      if(nodes == NULL) {
+        fprintf(stderr, "topoeval: out of memory\n");
+        exit(1);
+      }
+    }
+    nodes[nnodes].id = id;
+    nodes[nnodes].x = x;
+    nodes[nnodes].y = y;
+    format_coordinate(buf, sizeof(buf), x);
+    nodes[nnodes].fx = str2float(buf);
+    format_coordinate(buf, sizeof(buf), y);
+    nodes[nnodes].fy = str2float(buf);
+    nnodes++;
+  }
+  fclose(f);
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+static void
+build_grid(void)
+{
+  double x1, y1;
+  int i, c, *fill;
+
+  gx0 = x1 = nodes[0].x;
+  gy0 = y1 = nodes[0].y;
+  for(i = 1; i < nnodes; ++i) {
+    gx0 = fmin(gx0, nodes[i].x);
+    x1 = fmax(x1, nodes[i].x);
+    gy0 = fmin(gy0, nodes[i].y);
+    y1 = fmax(y1, nodes[i].y);
+  }
+  gw = (int)((x1 - gx0) / conf.range) + 1;
+  gh = (int)((y1 - gy0) / conf.range) + 1;
+
+  cell_start = calloc((size_t)gw * gh + 1, sizeof(int));
+  cell_node = xmalloc(nnodes * sizeof(int));
+  cx = xmalloc(nnodes * sizeof(double));
+  cy = xmalloc(nnodes * sizeof(double));
+  fill = calloc((size_t)gw * gh, sizeof(int));
+  if(cell_start == NULL || fill == NULL) {
+    fprintf(stderr, "topoeval: out of memory\n");
+    exit(1);
+  }
+
+  for(i = 0; i < nnodes; ++i) {
+    c = (int)((nodes[i].y - gy0) / conf.range) * gw + (int)((nodes[i].x - gx0) / conf.range);
+    cell_start[c + 1]++;
+  }
+  max_cell = 0;
+  for(c = 0; c < gw * gh; ++c) {
+    if(cell_start[c + 1] > max_cell) {
+      max_cell = cell_start[c + 1];
+    }
+    cell_start[c + 1] += cell_start[c];
+  }
+  for(i = 0; i < nnodes; ++i) {
+    c = (int)((nodes[i].y - gy0) / conf.range) * gw + (int)((nodes[i].x - gx0) / conf.range);
+    cell_node[cell_start[c] + fill[c]] = i;
+    cx[cell_start[c] + fill[c]] = nodes[i].x;
+    cy[cell_start[c] + fill[c]] = nodes[i].y;
+    fill[c]++;
+  }
+  free(fill);
+}
+/*---------------------------------------------------------------------------*/
+/* Squared distances from (x, y) to the nodes of a run of cells; a plain
+   loop over contiguous arrays, which the compiler vectorizes. */
+static void
+distances(const double *restrict xs, const double *restrict ys, int n,
+          double x, double y, double *restrict d2)
+{
+  int k;
+
+  for(k = 0; k < n; ++k) {
+    d2[k] = (xs[k] - x) * (xs[k] - x) + (ys[k] - y) * (ys[k] - y);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static int
+by_slot(const void *a, const void *b)
+{
+  unsigned sa = nodes[*(const int *)a].slot, sb = nodes[*(const int *)b].slot;
+
+  return sa < sb ? -1 : sa > sb;
+}
+/*---------------------------------------------------------------------------*/
+/* The nodes that hear node v when it sends at full power (the nodes v
+   hears, as the range is symmetric), in the order of their send times.
+   The squared distances go to d2 (in the same order) if not NULL. */
+static int
+neighbourhood(int v, int *out, double *d2, double *tmp)
+{
+  const double r2 = conf.range * conf.range;
+  int gx = (int)((nodes[v].x - gx0) / conf.range);
+  int gy = (int)((nodes[v].y - gy0) / conf.range);
+  int row, col, from, to, k, j, n = 0;
+
+  for(row = gy - 1; row <= gy + 1; ++row) {
+    if(row < 0 || row >= gh) {
+      continue;
+    }
+    col = gx > 0 ? gx - 1 : 0;
+    /* the cells of a row are contiguous */
+    from = cell_start[row * gw + col];
+    to = cell_start[row * gw + (gx + 1 < gw ? gx + 1 : gw - 1) + 1];
+    distances(cx + from, cy + from, to - from, nodes[v].x, nodes[v].y, tmp);
+    for(k = 0; k < to - from; ++k) {
+      if(tmp[k] <= r2 && cell_node[from + k] != v) {
+        out[n++] = cell_node[from + k];
+      }
+    }
+  }
+  qsort(out, n, sizeof(int), by_slot);
+  if(d2 != NULL) {
+    for(j = 0; j < n; ++j) {
+      k = out[j];
+      d2[j] = (nodes[k].x - nodes[v].x) * (nodes[k].x - nodes[v].x) +
+              (nodes[k].y - nodes[v].y) * (nodes[k].y - nodes[v].y);
+    }
+  }
+  return n;
+}
+/*---------------------------------------------------------------------------*/
+#ifdef TOPOEVAL_LMST
+/* 1-hop discovery: the table node v broadcasts in the 2-hop discovery. */
+static void
+onehop(int v, int *nb, double *d2, double *tmp)
+{
+  uint8_t self = nodes[v].id & 0xff;
+  int n, j;
+
+  n = neighbourhood(v, nb, NULL, tmp);
+  lmst_init();
+  for(j = 0; j < n; ++j) {
+    lmst_add_neighbor(self, nodes[nb[j]].id & 0xff,
+                      LMST_WEIGHT(nodes[v].fx, nodes[v].fy, nodes[nb[j]].fx, nodes[nb[j]].fy),
+                      nodes[nb[j]].fx, nodes[nb[j]].fy);
+  }
+  payload_len[v] = lmst_num_neighbors() > 0 ? lmst_twohop_payload(payload[v]) : 0;
+}
+/*---------------------------------------------------------------------------*/
+#if !LMST_XTC && LMST_K == 1
+/* The logical neighbours (a bitset of their ids) and the power of the last
+   computation. */
+static uint8_t
+logical_set(uint8_t self, uint32_t *set)
+{
+  uint16_t ids[MAX_NEIGHBORS], links;
+  int n, j;
+
+  memset(set, 0, 8 * sizeof(uint32_t));
+  n = lmst_logical(self, ids, NULL);
+  for(j = 0; j < n; ++j) {
+    set[(ids[j] & 0xff) / 32] |= (uint32_t)1 << (ids[j] % 32);
+  }
+  return lmst_power(self, &links);
+}
+/*---------------------------------------------------------------------------*/
+/* After a single change of the tables: lmst_repair, then the full
+   computation (lmst_initialize and lmst_prim) on the same tables, which
+   must give the same logical neighbours and power. The full computation
+   is the base of the next change. */
+static void
+check_change(uint8_t self)
+{
+  uint32_t repaired[8], rebuilt[8];
+  uint8_t power = 0;
+  int r;
+
+  __sync_fetch_and_add(&checks[0], 1);
+  r = lmst_repair(self);
+  if(r != LMST_REBUILD) {
+    power = logical_set(self, repaired);
+  }
+  if(lmst_initialize(self) < 1 || lmst_prim(self) != 0 || r == LMST_REBUILD) {
+    return;
+  }
+  __sync_fetch_and_add(&checks[1], 1);
+  if(logical_set(self, rebuilt) != power || memcmp(repaired, rebuilt, sizeof(rebuilt)) != 0) {
+    __sync_fetch_and_add(&checks[2], 1);
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* -c: every neighbour of node v leaves and joins again, the weight of an
+   edge in its 1-hop table changes (to the one of another entry, a tie),
+   and the node's own weight of it changes (as RSSI weights are
+   asymmetric), each one a single change that lmst_repair takes in. */
+static void
+check_repair(int v, const int *nb, int n)
+{
+  uint8_t self = nodes[v].id & 0xff, id, table[3 * MAX_NEIGHBORS];
+  struct neighbor *e;
+  float weight;
+  int j, u, len;
+
+  if(lmst_initialize(self) < 1 || lmst_prim(self) != 0) {
+    return;
+  }
+  for(j = 0; j < n; ++j) {
+    u = nb[j];
+    id = nodes[u].id & 0xff;
+    if(payload_len[u] == 0 || lmst_num_neighbors() >= MAX_NEIGHBORS) {
+      continue;
+    }
+    lmst_remove_neighbor(id);
+    check_change(self);
+    lmst_add_neighbor(self, id, LMST_WEIGHT(nodes[v].fx, nodes[v].fy, nodes[u].fx, nodes[u].fy),
+                      nodes[u].fx, nodes[u].fy);
+    lmst_add_twohop(id, payload[u], payload_len[u]);
+    check_change(self);
+
+    len = payload_len[u];
+    if(len >= 6) {
+      memcpy(table, payload[u], len);
+      table[1] = table[4];
+      table[2] = table[5];
+      lmst_update_twohop(id, table, len);
+      check_change(self);
+      lmst_update_twohop(id, payload[u], len);
+      check_change(self);
+    }
+
+    for(e = lmst_neighbors(); e != NULL && e->node_j != id; e = list_item_next(e));
+    if(e != NULL) {
+      weight = e->weight;
+      lmst_set_weight(e, weight / 2);
+      check_change(self);
+      lmst_set_weight(e, weight);
+      check_change(self);
+    }
+  }
+}
+#endif
+/*---------------------------------------------------------------------------*/
+/* 2-hop discovery and the LMST computation of node v (lmst_process). */
+static void
+compute(int v, int *nb, double *d2, double *tmp)
+{
+  struct result *r = &results[v];
+  uint8_t self = nodes[v].id & 0xff;
+  uint16_t links;
+  int n, j, u;
+
+  n = neighbourhood(v, nb, NULL, tmp);
+  lmst_init();
+  for(j = 0; j < n; ++j) {
+    lmst_add_neighbor(self, nodes[nb[j]].id & 0xff,
+                      LMST_WEIGHT(nodes[v].fx, nodes[v].fy, nodes[nb[j]].fx, nodes[nb[j]].fy),
+                      nodes[nb[j]].fx, nodes[nb[j]].fy);
+  }
+  for(j = 0; j < n; ++j) {
+    u = nb[j];
+    if(payload_len[u] == 0) {
+      continue;
+    }
+    lmst_add_twohop(nodes[u].id & 0xff, payload[u], payload_len[u]);
+  }
+
+  r->count = lmst_num_neighbors();
+#if LMST_XTC
+  r->init = lmst_xtc(self);
+#else
+  r->init = lmst_initialize(self);
+#endif
+  r->power = FULL_POWER;
+  links = r->init < 0 ? lmst_num_twohops() : 0;
+  if(r->init >= 1 && r->init <= MAX_NEIGHBORS + 1) {
+#if !LMST_XTC && LMST_K > 1
+    r->error = lmst_kforest(self, LMST_K, &r->mst) != 0;
+#elif !LMST_XTC
+    r->error = lmst_prim(self) != 0;
+#endif
+    r->power = lmst_power(self, &links);
+  }
+  r->links = links;
+  r->memory = lmst_memory();
+#if !LMST_XTC && LMST_K == 1
+  if(conf.check) {
+    check_repair(v, nb, n);
+  }
+#endif
+}
+#elif defined(TOPOEVAL_REDELCA)
+/*---------------------------------------------------------------------------*/
+/* The points of node v: its position, and those it received with the
+   RSSI they came with; nb[0..n) and d2 are its neighbours. Returns n. */
+static int
+points(int v, int *nb, double *d2, double *tmp)
+{
+  Point *point;
+  int n, j;
+  double dbm;
+
+  redelca_init();
+  point = calloc(1, sizeof(Point));
+  point->id = nodes[v].id & 0xff;
+  point->x = nodes[v].fx;
+  point->y = nodes[v].fy;
+  addREDELCApoint(point);
+
+  n = neighbourhood(v, nb, d2, tmp);
+  for(j = 0; j < n; ++j) {
+    point = calloc(1, sizeof(Point));
+    point->id = nodes[nb[j]].id & 0xff;
+    point->x = nodes[nb[j]].fx;
+    point->y = nodes[nb[j]].fy;
+    dbm = SS_STRONG + sqrt(d2[j]) / conf.range * (SS_WEAK - SS_STRONG);
+    point->rssi = (uint16_t)(int16_t)lround(dbm - RSSI_OFFSET) - 45;
+    addREDELCApoint(point);
+  }
+  return n;
+}
+#if REDELCA_RING_CHECK
+/*---------------------------------------------------------------------------*/
+/* The ring beacon of node v: its Delaunay neighbours, as the first
+   computation finds them before the ring round. */
+static void
+advertise(int v, int *nb, double *d2, double *tmp)
+{
+  short maxn, i;
+
+  points(v, nb, d2, tmp);
+  redelca_triangulate();
+  maxn = redelca_neighbors();
+#if REDELCA_UNIT
+  maxn = redelca_unit(maxn);
+#endif
+  for(i = 0; i < maxn; ++i) {
+    advert[v][i] = pHead->neighbors[i]->id;
+  }
+  advert_len[v] = maxn;
+}
+/*---------------------------------------------------------------------------*/
+/* the neighbours of the node computed, for ring_confirms */
+static int *ring_nb, ring_n;
+
+/* whether from, a neighbour of the node computed, advertised to in the
+   ring round (ring_confirms of the firmware) */
+static short
+ring_confirms(short from, short to)
+{
+  int j, k;
+
+  for(j = 0; j < ring_n && (short)(nodes[ring_nb[j]].id & 0xff) != from; ++j);
+  if(j == ring_n) {
+    return 0;
+  }
+  for(k = 0; k < advert_len[ring_nb[j]] && advert[ring_nb[j]][k] != to; ++k);
+  return k < advert_len[ring_nb[j]];
+}
+#endif
+/*---------------------------------------------------------------------------*/
+/* The REDELCA computation of node v (r_thread). */
+static void
+compute(int v, int *nb, double *d2, double *tmp)
+{
+  struct result *r = &results[v];
+  short maxn;
+
+#if REDELCA_RING_CHECK
+  ring_nb = nb;
+  ring_n = points(v, nb, d2, tmp);
+#else
+  points(v, nb, d2, tmp);
+#endif
+  r->init = redelca_triangulate() - 1;
+  maxn = redelca_neighbors();
+#if REDELCA_UNIT
+  maxn = redelca_unit(maxn);
+#endif
+#if REDELCA_FILTER != REDELCA_FILTER_NONE
+  maxn = redelca_filter(maxn);
+  r->links = maxn;
+  r->power = redelca_reach(maxn);
+#else
+  r->links = maxn;
+#if REDELCA_RING_CHECK
+  redelca_confirm(maxn, ring_confirms);
+#endif
+  r->power = redelca_power(maxn);
+#endif
+  r->memory = mem;
+}
+#else /* TOPOEVAL_CBTC */
+/*---------------------------------------------------------------------------*/
+/* The CBTC computation of node v (c_thread), on the positions it
+   received. */
+static void
+compute(int v, int *nb, double *d2, double *tmp)
+{
+  struct result *r = &results[v];
+  uint16_t links;
+  int n, j;
+
+  cbtc_init(nodes[v].fx, nodes[v].fy);
+  n = neighbourhood(v, nb, NULL, tmp);
+  for(j = 0; j < n; ++j) {
+    cbtc_add(nodes[nb[j]].id & 0xff, nodes[nb[j]].fx, nodes[nb[j]].fy);
+  }
+
+  r->init = cbtc_count();
+  cbtc_compute();
+  r->power = cbtc_power(&links);
+  r->links = links;
+  r->memory = cbtc_memory();
+}
+#endif
+/*---------------------------------------------------------------------------*/
+/* Runs phase(v) for every node, on conf.jobs worker processes that take
+   CHUNK nodes at a time; returns when all are done. */
+static void
+run(void (*phase)(int, int *, double *, double *))
+{
+  int w, status, failed = 0;
+  unsigned i, k;
+  int *nb = xmalloc(9 * max_cell * sizeof(int));
+  double *d2 = xmalloc(9 * max_cell * sizeof(double));
+  double *tmp = xmalloc(3 * max_cell * sizeof(double));
+
+  if(conf.jobs <= 1) {
+    for(i = 0; i < (unsigned)nnodes; ++i) {
+      phase(i, nb, d2, tmp);
+    }
+  } else {
+    *next_chunk = 0;
+    fflush(NULL);
+    for(w = 0; w < conf.jobs; ++w) {
+      switch(fork()) {
+      case -1:
+        fprintf(stderr, "topoeval: fork: %s\n", strerror(errno));
+        exit(1);
+      case 0:
+        while((i = __sync_fetch_and_add(next_chunk, CHUNK)) < (unsigned)nnodes) {
+          for(k = i; k < i + CHUNK && k < (unsigned)nnodes; ++k) {
+            phase(k, nb, d2, tmp);
+          }
+        }
+        _exit(0);
+      }
+    }
+    while(wait(&status) > 0) {
+      if(!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        failed = 1;
+      }
+    }
+    if(failed) {
+      fprintf(stderr, "topoeval: a worker failed\n");
+      exit(1);
+    }
+  }
+  free(nb);
+  free(d2);
+  free(tmp);
+}
+/*---------------------------------------------------------------------------*/
+/* Final beacons: node v hears u if u reaches it at the power u picked.
+   Writes the row of v. */
+static void
+write_row(FILE *out, int v, int *nb, double *d2, double *tmp)
+{
+  const struct result *r = &results[v];
+  double reach;
+  int n, j, u;
+
+  fprintf(out, "%u", nodes[v].id);
+#ifdef TOPOEVAL_LMST
+  fprintf(out, ",0,0,0:00.000,%d,%d,0:00.000,%s%d,0:00.000,0:00.000",
+          r->count, r->init, r->error ? "ERROR," : "", r->links);
+#else
+  fprintf(out, ",0:00.000,%d,0:00.000,%d,0:00.000,0:00.000", r->init, r->links);
+#endif
+  fprintf(out, ",%d,%d", r->power, r->memory);
+
+  n = neighbourhood(v, nb, d2, tmp);
+  for(j = 0; j < n; ++j) {
+    u = nb[j];
+    reach = conf.range * results[u].power / FULL_POWER;
+    if(d2[j] <= reach * reach) {
+      fprintf(out, ",%u", nodes[u].id);
+    }
+  }
+  fprintf(out, ",0,0,0\n");
+}
+/*---------------------------------------------------------------------------*/
+static void
+usage(void)
+{
+  fprintf(stderr,
+          "usage: topoeval-%s [options] <deployment.dat>\n"
+          "  -o <file>   motes log to write (default: standard output)\n"
+          "  -r <m>      transmitting range at full power (default 15)\n"
+          "  -j <jobs>   worker processes (default: number of cores)\n"
+#if defined(TOPOEVAL_LMST) && !LMST_XTC && LMST_K == 1
+          "  -c          checks lmst_repair against the full computation after single\n"
+          "              changes of every neighbourhood; fails if they differ\n"
+#endif
+          ,
+#if defined(TOPOEVAL_LMST)
+          "lmst"
+#elif defined(TOPOEVAL_REDELCA)
+          "redelca"
+#else
+          "cbtc"
+#endif
+          );
+  exit(1);
+}
+/*---------------------------------------------------------------------------*/
+int
+main(int argc, char **argv)
+{
+  FILE *out = stdout;
+  const char *outname = NULL;
+  int c, i, *nb;
+  double *d2, *tmp, start, sum;
+
+  conf.jobs = (int)sysconf(_SC_NPROCESSORS_ONLN);
+  while((c = getopt(argc, argv, "o:r:j:c")) != -1) {
+    switch(c) {
+#if defined(TOPOEVAL_LMST) && !LMST_XTC && LMST_K == 1
+    case 'c':
+      conf.check = 1;
+      break;
+#endif
+    case 'o':
+      outname = optarg;
+      break;
+    case 'r':
+      conf.range = atof(optarg);
+      break;
+    case 'j':
+      conf.jobs = atoi(optarg);
+      break;
+    default:
+      usage();
+    }
+  }
+  if(optind != argc - 1 || conf.range <= 0) {
+    usage();
+  }
+  if(read_deployment(argv[optind]) < 0) {
+    return 1;
+  }
+  if(nnodes == 0) {
+    fprintf(stderr, "topoeval: %s: no nodes\n", argv[optind]);
+    return 1;
+  }
+  if(outname != NULL && (out = fopen(outname, "w")) == NULL) {
+    fprintf(stderr, "topoeval: %s: %s\n", outname, strerror(errno));
+    return 1;
+  }
+
+  start = now();
+  for(i = 0; i < nnodes; ++i) {
+    nodes[i].slot = (nodes[i].id & 0xff) % TIMEFRAME * (unsigned)nnodes + i;
+  }
+  build_grid();
+  results = shared(nnodes * sizeof(*results));
+  next_chunk = shared(sizeof(*next_chunk));
+#ifdef TOPOEVAL_LMST
+  payload = shared(nnodes * sizeof(*payload));
+  payload_len = shared(nnodes * sizeof(*payload_len));
+  checks = shared(3 * sizeof(*checks));
+  run(onehop);
+#endif
+#if defined(TOPOEVAL_REDELCA) && REDELCA_RING_CHECK
+  advert = shared(nnodes * sizeof(*advert));
+  advert_len = shared(nnodes * sizeof(*advert_len));
+  run(advertise);
+#endif
+  run(compute);
+
+  fprintf(out, "#topoeval %s, %s, %d nodes, range %g: no radio losses, times and energy are not computed\n",
+          ALGORITHM, argv[optind], nnodes, conf.range);
+  nb = xmalloc(9 * max_cell * sizeof(int));
+  d2 = xmalloc(9 * max_cell * sizeof(double));
+  tmp = xmalloc(3 * max_cell * sizeof(double));
+  for(i = 0; i < nnodes; ++i) {
+    write_row(out, i, nb, d2, tmp);
+  }
+  free(nb);
+  free(d2);
+  free(tmp);
+  if(out != stdout) {
+    fclose(out);
+  }
+
+  for(sum = 0, i = 0; i < nnodes; ++i) {
+    sum += results[i].power;
+  }
+  fprintf(stderr, "%s: %d nodes, mean POWER %.2f, %.2f s\n",
+          argv[optind], nnodes, sum / nnodes, now() - start);
+#if defined(TOPOEVAL_LMST) && !LMST_XTC && LMST_K > 1
+  for(sum = 0, i = 0; i < nnodes; ++i) {
+    sum += results[i].power - (results[i].mst ? results[i].mst : results[i].power);
+  }
+  fprintf(stderr, "%s: k-LMST (k %d), mean POWER over the local MST +%.2f\n",
+          argv[optind], LMST_K, sum / nnodes);
+#endif
+#ifdef TOPOEVAL_LMST
+  if(conf.check) {
+    fprintf(stderr, "%s: repair check, %u single changes, %u repaired, %u unlike the full computation\n",
+            argv[optind], checks[0], checks[1], checks[2]);
+    return checks[2] != 0;
+  }
+#endif
+  return 0;
+}
+/*---------------------------------------------------------------------------*/